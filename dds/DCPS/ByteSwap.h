@@ -0,0 +1,167 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_BYTE_SWAP_H
+#define OPENDDS_DCPS_BYTE_SWAP_H
+
+#include <ace/config-macros.h>
+#ifndef ACE_LACKS_PRAGMA_ONCE
+#  pragma once
+#endif
+
+#include <dds/Versioned_Namespace.h>
+
+#include <cstddef>
+
+#if defined __AVX2__
+#  define OPENDDS_BYTE_SWAP_AVX2 1
+#  include <immintrin.h>
+#endif
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  define OPENDDS_BYTE_SWAP_SSE2 1
+#  include <emmintrin.h>
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#  define OPENDDS_BYTE_SWAP_NEON 1
+#  include <arm_neon.h>
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * Copy n elements of 2, 4, or 8 bytes from "from" to "to", reversing the
+ * bytes of each element. The buffers must not overlap, but don't have to be
+ * aligned. Whatever vector instructions the compiler targets are used for the
+ * bulk of the array, with a scalar loop for the rest.
+ */
+///@{
+inline void swap_array_2(char* to, const char* from, size_t n)
+{
+  size_t i = 0;
+#ifdef OPENDDS_BYTE_SWAP_AVX2
+  const __m256i mask = _mm256_setr_epi8(
+    1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+    1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  for (; i + 16 <= n; i += 16) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + 2 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + 2 * i), _mm256_shuffle_epi8(v, mask));
+  }
+#endif
+#if defined OPENDDS_BYTE_SWAP_SSE2
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 2 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(to + 2 * i),
+      _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+#elif defined OPENDDS_BYTE_SWAP_NEON
+  for (; i + 8 <= n; i += 8) {
+    vst1q_u8(reinterpret_cast<uint8_t*>(to + 2 * i),
+      vrev16q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(from + 2 * i))));
+  }
+#endif
+  for (; i < n; ++i) {
+    to[2 * i] = from[2 * i + 1];
+    to[2 * i + 1] = from[2 * i];
+  }
+}
+
+inline void swap_array_4(char* to, const char* from, size_t n)
+{
+  size_t i = 0;
+#ifdef OPENDDS_BYTE_SWAP_AVX2
+  const __m256i mask = _mm256_setr_epi8(
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + 4 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + 4 * i), _mm256_shuffle_epi8(v, mask));
+  }
+#endif
+#if defined OPENDDS_BYTE_SWAP_SSE2
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 4 * i));
+    // Swap the 16-bit halves of each element, then the bytes of each half.
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(to + 4 * i),
+      _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+#elif defined OPENDDS_BYTE_SWAP_NEON
+  for (; i + 4 <= n; i += 4) {
+    vst1q_u8(reinterpret_cast<uint8_t*>(to + 4 * i),
+      vrev32q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(from + 4 * i))));
+  }
+#endif
+  for (; i < n; ++i) {
+    const char* const f = from + 4 * i;
+    char* const t = to + 4 * i;
+    t[0] = f[3];
+    t[1] = f[2];
+    t[2] = f[1];
+    t[3] = f[0];
+  }
+}
+
+inline void swap_array_8(char* to, const char* from, size_t n)
+{
+  size_t i = 0;
+#ifdef OPENDDS_BYTE_SWAP_AVX2
+  const __m256i mask = _mm256_setr_epi8(
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  for (; i + 4 <= n; i += 4) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + 8 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + 8 * i), _mm256_shuffle_epi8(v, mask));
+  }
+#endif
+#if defined OPENDDS_BYTE_SWAP_SSE2
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 8 * i));
+    // Reverse the 16-bit quarters of each element, then the bytes of each quarter.
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(to + 8 * i),
+      _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+#elif defined OPENDDS_BYTE_SWAP_NEON
+  for (; i + 2 <= n; i += 2) {
+    vst1q_u8(reinterpret_cast<uint8_t*>(to + 8 * i),
+      vrev64q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(from + 8 * i))));
+  }
+#endif
+  for (; i < n; ++i) {
+    const char* const f = from + 8 * i;
+    char* const t = to + 8 * i;
+    for (size_t b = 0; b < 8; ++b) {
+      t[b] = f[7 - b];
+    }
+  }
+}
+///@}
+
+/// Returns false if size isn't one of the sizes handled above.
+inline bool swap_array(char* to, const char* from, size_t size, size_t n)
+{
+  switch (size) {
+  case 2:
+    swap_array_2(to, from, n);
+    return true;
+  case 4:
+    swap_array_4(to, from, n);
+    return true;
+  case 8:
+    swap_array_8(to, from, n);
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_DCPS_BYTE_SWAP_H
@@ -45,6 +45,7 @@
 #include <ace/Reactor.h>
 #include <ace/OS_NS_sys_time.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <stdexcept>
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
@@ -1354,6 +1355,25 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
     }
   }
 
+  const MarshalingType marshaling_type =
+    sample.header_.key_fields_only_ ? KEY_ONLY_MARSHALING : FULL_MARSHALING;
+
+  // Deserializing doesn't depend on the sample container, so do it before
+  // taking sample_lock_. Samples held for END_HISTORIC_SAMPLES or discarded
+  // by filter_sample() are rejected first, so they are never deserialized.
+  // Neither check uses the sample container.
+  bool held = false;
+  bool discarded = false;
+  unique_ptr<DecodedSample> decoded;
+  if (sample.header_.message_id_ == SAMPLE_DATA ||
+      sample.header_.message_id_ == INSTANCE_REGISTRATION) {
+    held = !check_historic(sample);
+    discarded = !held && filter_sample(sample.header_);
+    if (!held && !discarded) {
+      decoded.reset(decode_sample(sample, marshaling_type));
+    }
+  }
+
   // ensure some other thread is not changing the sample container
   // or statuses related to samples.
   ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_);
@@ -1372,14 +1392,14 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
   case SAMPLE_DATA:
   case INSTANCE_REGISTRATION: {
     SubscriptionInstance_rch instance;
-    if (!check_historic(sample)) break;
+    if (held) break;
 
     DataSampleHeader const & header = sample.header_;
 
     this->writer_activity(header);
 
     // Verify data has not exceeded its lifespan.
-    if (this->filter_sample(header)) break;
+    if (discarded) break;
 
     // This adds the reader to the set/list of readers with data.
     RcHandle<SubscriberImpl> subscriber = get_subscriber_servant();
@@ -1397,8 +1417,11 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
 
     bool is_new_instance = false;
     bool filtered = false;
-    dds_demarshal(sample, publication_handle, instance, is_new_instance, filtered,
-                  sample.header_.key_fields_only_ ? KEY_ONLY_MARSHALING : FULL_MARSHALING);
+    if (decoded) {
+      store_decoded_sample(*decoded, sample, publication_handle, instance, is_new_instance, filtered);
+    } else {
+      dds_demarshal(sample, publication_handle, instance, is_new_instance, filtered, marshaling_type);
+    }
 
     // Per sample logging
     if (DCPS_debug_level >= 8) {
@@ -1687,7 +1710,7 @@ bool DataReaderImpl::have_sample_states(
 {
   //!!!caller should have acquired sample_lock_
   ACE_Guard<ACE_Recursive_Thread_Mutex> instance_guard(instances_lock_);
-  return lookup_matching_instances(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE).size();
+  return has_matching_instance(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
 }
 
 bool
@@ -1695,7 +1718,7 @@ DataReaderImpl::have_view_states(DDS::ViewStateMask view_states) const
 {
   //!!!caller should have acquired sample_lock_
   ACE_Guard<ACE_Recursive_Thread_Mutex> instance_guard(instances_lock_);
-  return lookup_matching_instances(DDS::ANY_SAMPLE_STATE, view_states, DDS::ANY_INSTANCE_STATE).size();
+  return has_matching_instance(DDS::ANY_SAMPLE_STATE, view_states, DDS::ANY_INSTANCE_STATE);
 }
 
 bool DataReaderImpl::have_instance_states(
@@ -1703,7 +1726,7 @@ bool DataReaderImpl::have_instance_states(
 {
   //!!!caller should have acquired sample_lock_
   ACE_Guard<ACE_Recursive_Thread_Mutex> instance_guard(instances_lock_);
-  return lookup_matching_instances(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, instance_states).size();
+  return has_matching_instance(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, instance_states);
 }
 
 /// Fold-in the three separate loops of have_sample_states(),
@@ -1714,7 +1737,7 @@ bool DataReaderImpl::contains_sample(DDS::SampleStateMask sample_states,
   ACE_Guard<ACE_Recursive_Thread_Mutex> sample_guard(sample_lock_);
   ACE_Guard<ACE_Recursive_Thread_Mutex> instance_guard(instances_lock_);
 
-  return lookup_matching_instances(sample_states, view_states, instance_states).size();
+  return has_matching_instance(sample_states, view_states, instance_states);
 }
 
 DDS::DataReaderListener_ptr
@@ -1803,6 +1826,7 @@ DataReaderImpl::release_instance(DDS::InstanceHandle_t handle)
   }
 
   this->purge_data(instance);
+  remove_from_lookup_maps(*instance);
 
   {
     ACE_GUARD(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_);
@@ -3305,48 +3329,87 @@ void DataReaderImpl::OnDataAvailable::execute()
   }
 }
 
-void DataReaderImpl::initialize_lookup_maps()
+void DataReaderImpl::update_lookup_maps(const SubscriptionInstanceMapType::iterator& input)
 {
-  // These all start at 1 (0 mask is bogus) and include the full mask (any)
-  for (CORBA::ULong is = 1; is <= MAX_SAMPLE_STATE_MASK; ++is) {
-    for (CORBA::ULong iv = 1; iv <= MAX_VIEW_STATE_MASK; ++iv) {
-      for (CORBA::ULong ii = 1; ii <= MAX_INSTANCE_STATE_MASK; ++ii) {
-        combined_state_lookup_[to_combined_states(is, iv, ii)] = HandleSet();
-      }
+  SubscriptionInstance& inst = *input->second;
+  const CORBA::ULong combined_states = to_combined_states(inst.rcvd_samples_.sample_states(),
+                                                          inst.instance_state_->view_state(),
+                                                          inst.instance_state_->instance_state());
+  if (combined_states == inst.combined_states_) {
+    return;
+  }
+  remove_from_lookup_maps(inst);
+  // An instance without samples doesn't match any sample state mask.
+  if (combined_states) {
+    combined_state_lookup_[combined_states].insert(input->first);
+  }
+  inst.combined_states_ = combined_states;
+}
+
+void DataReaderImpl::remove_from_lookup_maps(SubscriptionInstance& inst)
+{
+  if (!inst.combined_states_) {
+    return;
+  }
+  const LookupMap::iterator it = combined_state_lookup_.find(inst.combined_states_);
+  if (it != combined_state_lookup_.end()) {
+    it->second.erase(inst.instance_handle_);
+    if (it->second.empty()) {
+      combined_state_lookup_.erase(it);
     }
   }
-  // catch-all for "bogus" lookups
-  combined_state_lookup_[0] = HandleSet();
+  inst.combined_states_ = 0;
 }
 
-void DataReaderImpl::update_lookup_maps(const SubscriptionInstanceMapType::iterator& input)
+DDS::InstanceHandle_t DataReaderImpl::next_matching_instance(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states, DDS::InstanceHandle_t prev) const
 {
-  for (LookupMap::iterator it = combined_state_lookup_.begin(); it != combined_state_lookup_.end(); ++it) {
-    if (it->first == 0) continue;
-    CORBA::ULong sample_states, view_states, instance_states;
-    split_combined_states(it->first, sample_states, view_states, instance_states);
-    if (input->second->matches(sample_states, view_states, instance_states)) {
-      it->second.insert(input->first);
-    } else {
-      it->second.erase(input->first);
+  const CORBA::ULong mask = to_combined_states(sample_states, view_states, instance_states);
+  DDS::InstanceHandle_t next = DDS::HANDLE_NIL;
+  for (LookupMap::const_iterator it = combined_state_lookup_.begin(), the_end = combined_state_lookup_.end(); it != the_end; ++it) {
+    CORBA::ULong is, iv, ii;
+    split_combined_states(it->first & mask, is, iv, ii);
+    if (!(is && iv && ii)) {
+      continue;
+    }
+    const HandleSet::const_iterator pos = it->second.upper_bound(prev);
+    if (pos != it->second.end() && (next == DDS::HANDLE_NIL || *pos < next)) {
+      next = *pos;
     }
   }
+  return next;
 }
 
-void DataReaderImpl::remove_from_lookup_maps(DDS::InstanceHandle_t handle)
+void DataReaderImpl::matching_instances(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states, HandleVec& result) const
 {
-  for (LookupMap::iterator it = combined_state_lookup_.begin(), the_end = combined_state_lookup_.end(); it != the_end; ++it) {
-    if (it->first == 0) continue;
-    it->second.erase(handle);
+  result.clear();
+  const CORBA::ULong mask = to_combined_states(sample_states, view_states, instance_states);
+  for (LookupMap::const_iterator it = combined_state_lookup_.begin(), the_end = combined_state_lookup_.end(); it != the_end; ++it) {
+    CORBA::ULong is, iv, ii;
+    split_combined_states(it->first & mask, is, iv, ii);
+    if (!(is && iv && ii)) {
+      continue;
+    }
+    // Each set is in handle order and an instance is only in one of them,
+    // so merging them in as they're found keeps result in handle order.
+    const HandleVec::difference_type merged = result.size();
+    result.insert(result.end(), it->second.begin(), it->second.end());
+    if (merged) {
+      std::inplace_merge(result.begin(), result.begin() + merged, result.end());
+    }
   }
 }
 
-const DataReaderImpl::HandleSet& DataReaderImpl::lookup_matching_instances(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states) const
+bool DataReaderImpl::has_matching_instance(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states) const
 {
-  const CORBA::ULong combined_states = to_combined_states(sample_states, view_states, instance_states);
-  LookupMap::const_iterator ci = combined_state_lookup_.find(combined_states);
-  OPENDDS_ASSERT(ci != combined_state_lookup_.end());
-  return ci->second;
+  const CORBA::ULong mask = to_combined_states(sample_states, view_states, instance_states);
+  for (LookupMap::const_iterator it = combined_state_lookup_.begin(), the_end = combined_state_lookup_.end(); it != the_end; ++it) {
+    CORBA::ULong is, iv, ii;
+    split_combined_states(it->first & mask, is, iv, ii);
+    if (is && iv && ii && !it->second.empty()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void DataReaderImpl::schedule_deadline(SubscriptionInstance_rch instance,
@@ -332,6 +332,35 @@ public:
                              bool& filtered,
                              MarshalingType marshaling_type) = 0;
 
+  /// A sample deserialized by decode_sample().
+  class DecodedSample {
+  public:
+    virtual ~DecodedSample() {}
+  };
+
+  /**
+   * Deserialize and content filter a SAMPLE_DATA or INSTANCE_REGISTRATION
+   * sample before data_received() takes sample_lock_, so that decoding
+   * doesn't block application threads reading or taking from the reader.
+   * The result is passed to store_decoded_sample() under the lock. Returns
+   * null if the sample should go through dds_demarshal() instead.
+   */
+  virtual DecodedSample* decode_sample(const ReceivedDataSample& /*sample*/,
+                                       MarshalingType /*marshaling_type*/)
+  {
+    return 0;
+  }
+
+  /// sample_lock_ must be held.
+  virtual void store_decoded_sample(DecodedSample& /*decoded*/,
+                                    const ReceivedDataSample& /*sample*/,
+                                    DDS::InstanceHandle_t /*publication_handle*/,
+                                    SubscriptionInstance_rch& /*instance*/,
+                                    bool& /*is_new_instance*/,
+                                    bool& /*filtered*/)
+  {
+  }
+
   virtual void dispose_unregister(const ReceivedDataSample& sample,
                                   DDS::InstanceHandle_t publication_handle,
                                   SubscriptionInstance_rch& instance);
@@ -585,6 +614,7 @@ protected:
 
   typedef OPENDDS_SET(DDS::InstanceHandle_t) HandleSet;
   typedef OPENDDS_MAP(CORBA::ULong, HandleSet) LookupMap;
+  typedef OPENDDS_VECTOR(DDS::InstanceHandle_t) HandleVec;
 
   static CORBA::ULong to_combined_states(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states)
   {
@@ -605,11 +635,24 @@ protected:
     instance_states = combined & MAX_INSTANCE_STATE_MASK;
   }
 
-  void initialize_lookup_maps();
   void update_lookup_maps(const SubscriptionInstanceMapType::iterator& input);
-  void remove_from_lookup_maps(DDS::InstanceHandle_t handle);
-  const HandleSet& lookup_matching_instances(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states) const;
-
+  /// Remove inst from the set its combined_states_ say it's in.
+  void remove_from_lookup_maps(SubscriptionInstance& inst);
+
+  /// Returns the lowest handle greater than prev of an instance whose states
+  /// match the masks, or HANDLE_NIL if there isn't one. Instances can change
+  /// states or be removed between calls. Each call visits every matching set,
+  /// so use matching_instances to go through all of them.
+  DDS::InstanceHandle_t next_matching_instance(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states, DDS::InstanceHandle_t prev) const;
+  /// Set result to the handles, in order, of the instances whose states match
+  /// the masks.
+  void matching_instances(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states, HandleVec& result) const;
+  bool has_matching_instance(CORBA::ULong sample_states, CORBA::ULong view_states, CORBA::ULong instance_states) const;
+
+  /// Instances that have samples, keyed by the exact combined states they
+  /// are in. An instance is in at most one set, so a state change only moves
+  /// it from one set to another and a lookup only has to visit the handful of
+  /// sets that match the masks.
   LookupMap combined_state_lookup_;
 
   // Perform cast to get extended version of listener (otherwise nil)
@@ -14,6 +14,7 @@
 #include "RakeResults_T.h"
 #include "SubscriberImpl.h"
 #include "TypeSupportImpl.h"
+#include "KeyHash.h"
 #include "Util.h"
 #include "dcps_export.h"
 
@@ -55,9 +56,17 @@ namespace OpenDDS {
     typedef MarshalTraits<MessageType> MarshalTraitsType;
     typedef typename TraitsType::MessageSequenceType MessageSequenceType;
 
+#ifdef ACE_HAS_CPP11
+    typedef OPENDDS_UNORDERED_MAP_CHASH_CEQ_T(MessageType, DDS::InstanceHandle_t,
+                                              typename TraitsType::KeyHashType,
+                                              KeyEqual<typename TraitsType::LessThanType>) InstanceMap;
+#else
     typedef OPENDDS_MAP_CMP_T(MessageType, DDS::InstanceHandle_t,
                               typename TraitsType::LessThanType) InstanceMap;
-    typedef OPENDDS_MAP(DDS::InstanceHandle_t, typename InstanceMap::iterator) ReverseInstanceMap;
+#endif
+    // Keys live in the nodes of instance_map_, so their addresses survive a rehash.
+    // This map is also what gives read/take_next_instance their handle order.
+    typedef OPENDDS_MAP(DDS::InstanceHandle_t, const MessageType*) ReverseInstanceMap;
 
     class SharedInstanceMap
       : public virtual RcObject
@@ -107,11 +116,46 @@ namespace OpenDDS {
 
       const MessageType* message() const { return this; }
 
+      /// Keep the serialized sample, which starts offset bytes into payload,
+      /// instead of deserializing it now. See materialize.
+      void defer_deserialization(Message_Block_Ptr& payload, const Encoding& encoding, size_t offset)
+      {
+        deferred_.reset(new DeferredSample(payload, encoding, offset));
+      }
+
+      /// Deserialize the sample passed to defer_deserialization, if any.
+      bool materialize()
+      {
+        if (!deferred_) {
+          return true;
+        }
+        const unique_ptr<DeferredSample> deferred(deferred_.release());
+        Serializer ser(deferred->payload_.get(), deferred->encoding_);
+        return ser.skip(deferred->offset_) && ser >> static_cast<MessageType&>(*this);
+      }
+
+      bool deferred() const { return deferred_.get() != 0; }
+
 #ifndef OPENDDS_HAS_STD_UNIQUE_PTR
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::_remove_ref;
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::_add_ref;
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::ref_count;
 #endif
+
+    private:
+      /// Only allocated for samples stored with DCPSLazyDeserialization.
+      struct DeferredSample {
+        DeferredSample(Message_Block_Ptr& payload, const Encoding& encoding, size_t offset)
+          : payload_(payload.release())
+          , encoding_(encoding)
+          , offset_(offset)
+        {}
+
+        Message_Block_Ptr payload_;
+        Encoding encoding_;
+        size_t offset_;
+      };
+      unique_ptr<DeferredSample> deferred_;
     };
 
     struct MessageTypeMemoryBlock {
@@ -124,8 +168,8 @@ namespace OpenDDS {
     DataReaderImpl_T()
       : filter_delayed_sample_task_(make_rch<SporadicEvent>(TheServiceParticipant->event_dispatcher(), make_rch<DRIEvent>(rchandle_from(this), &DataReaderImpl_T::filter_delayed)))
       , marshal_skip_serialize_(false)
+      , lazy_deserialization_(TheServiceParticipant->lazy_deserialization())
     {
-      initialize_lookup_maps();
     }
 
     virtual ~DataReaderImpl_T()
@@ -284,16 +328,15 @@ namespace OpenDDS {
     const Observer_rch observer = get_observer(Observer::e_SAMPLE_READ);
 
     const CORBA::ULong sample_states = DDS::NOT_READ_SAMPLE_STATE;
-    const HandleSet& matches = lookup_matching_instances(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-    for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
-      ++next; // pre-increment iterator, in case updates cause changes to match set
-      const DDS::InstanceHandle_t handle = *it;
+    for (DDS::InstanceHandle_t handle = next_matching_instance(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE, DDS::HANDLE_NIL);
+         handle != DDS::HANDLE_NIL; handle = next_matching_instance(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE, handle)) {
       const SubscriptionInstance_rch inst = get_handle_instance(handle);
       if (!inst) continue;
 
       bool most_recent_generation = false;
       for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0);
            !found_data && item; item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
+        item->materialize();
         if (item->registered_data_) {
           received_data = *static_cast<MessageType*>(item->registered_data_);
         }
@@ -338,16 +381,15 @@ namespace OpenDDS {
     const Observer_rch observer = get_observer(Observer::e_SAMPLE_TAKEN);
 
     const CORBA::ULong sample_states = DDS::NOT_READ_SAMPLE_STATE;
-    const HandleSet& matches = lookup_matching_instances(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-    for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
-      ++next; // pre-increment iterator, in case updates cause changes to match set
-      const DDS::InstanceHandle_t handle = *it;
+    for (DDS::InstanceHandle_t handle = next_matching_instance(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE, DDS::HANDLE_NIL);
+         handle != DDS::HANDLE_NIL; handle = next_matching_instance(sample_states, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE, handle)) {
       const SubscriptionInstance_rch inst = get_handle_instance(handle);
       if (!inst) continue;
 
       bool most_recent_generation = false;
       ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0);
       if (item) {
+        item->materialize();
         if (item->registered_data_) {
           received_data = *static_cast<MessageType*>(item->registered_data_);
         }
@@ -665,7 +707,7 @@ namespace OpenDDS {
 
     const typename ReverseInstanceMap::const_iterator pos = reverse_instance_map_.find(handle);
     if (pos != reverse_instance_map_.end()) {
-      key_holder = pos->second->first;
+      key_holder = *pos->second;
       return DDS::RETCODE_OK;
     }
 
@@ -717,15 +759,16 @@ namespace OpenDDS {
     TypeSupportImpl* const type_support = dynamic_cast<TypeSupportImpl*>(ts);
     const bool filter_has_non_key_fields = type_support ? evaluator.has_non_key_fields(*type_support) : true;
 
-    const HandleSet& matches = lookup_matching_instances(sample_states, view_states, instance_states);
-    for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
-      ++next; // pre-increment iterator, in case updates cause changes to match set
+    HandleVec matches;
+    matching_instances(sample_states, view_states, instance_states, matches);
+    for (HandleVec::const_iterator it = matches.begin(); it != matches.end(); ++it) {
       const DDS::InstanceHandle_t handle = *it;
       const SubscriptionInstance_rch inst = get_handle_instance(handle);
       if (!inst) continue;
 
       for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0); item;
            item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
+        item->materialize();
         if (!item->registered_data_ || (!item->valid_data_ && filter_has_non_key_fields)) {
           continue;
         }
@@ -1082,6 +1125,47 @@ protected:
                              bool& just_registered,
                              bool& filtered,
                              OpenDDS::DCPS::MarshalingType marshaling_type)
+  {
+    TypedDecodedSample decoded;
+    decode(decoded, sample, marshaling_type);
+    store_decoded_sample(decoded, sample, publication_handle, instance, just_registered, filtered);
+  }
+
+  virtual DecodedSample* decode_sample(const OpenDDS::DCPS::ReceivedDataSample& sample,
+                                       OpenDDS::DCPS::MarshalingType marshaling_type)
+  {
+    unique_ptr<TypedDecodedSample> decoded(new TypedDecodedSample);
+    decode(*decoded, sample, marshaling_type);
+    return decoded.release();
+  }
+
+  virtual void store_decoded_sample(DecodedSample& decoded,
+                                    const OpenDDS::DCPS::ReceivedDataSample& sample,
+                                    DDS::InstanceHandle_t publication_handle,
+                                    OpenDDS::DCPS::SubscriptionInstance_rch& instance,
+                                    bool& just_registered,
+                                    bool& filtered)
+  {
+    TypedDecodedSample& typed = static_cast<TypedDecodedSample&>(decoded);
+    if (typed.filtered) {
+      filtered = true;
+    } else if (typed.data) {
+      store_instance_data(OPENDDS_MOVE_NS::move(typed.data), publication_handle, sample.header_, instance, just_registered, filtered);
+    }
+  }
+
+  /// The result of decode(): data is null if the sample was dropped or filtered.
+  struct TypedDecodedSample : DecodedSample {
+    TypedDecodedSample() : filtered(false) {}
+    unique_ptr<MessageTypeWithAllocator> data;
+    bool filtered;
+  };
+
+  /// Deserialize and content filter a sample. This doesn't touch the sample
+  /// container, so sample_lock_ doesn't have to be held.
+  void decode(TypedDecodedSample& decoded,
+              const OpenDDS::DCPS::ReceivedDataSample& sample,
+              OpenDDS::DCPS::MarshalingType marshaling_type)
   {
     unique_ptr<MessageTypeWithAllocator> data(new (*data_allocator()) MessageTypeWithAllocator);
     dynamic_hook(*data);
@@ -1095,7 +1179,7 @@ protected:
         }
         return;
       }
-      store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
+      decoded.data.reset(data.release());
       return;
     }
     const bool encapsulated = sample.header_.cdr_encapsulation_;
@@ -1153,6 +1237,18 @@ protected:
     const bool key_only_marshaling =
       marshaling_type == OpenDDS::DCPS::KEY_ONLY_MARSHALING;
 
+    if (!key_only_marshaling && can_defer_deserialization(sample.header_)) {
+      // Copy the payload so the sample doesn't hold on to the transport's
+      // receive buffer while it waits in the history.
+      Message_Block_Ptr copy(new ACE_Message_Block(sample.data_length()));
+      Serializer copy_ser(copy.get(), Encoding::KIND_UNALIGNED_CDR);
+      if (sample.write_data(copy_ser)) {
+        data->defer_deserialization(copy, ser.encoding(), ser.rpos());
+        decoded.data.reset(data.release());
+        return;
+      }
+    }
+
     bool ser_ret = true;
     if (key_only_marshaling) {
       ser_ret = ser >> OpenDDS::DCPS::KeyOnly<MessageType>(*data);
@@ -1194,19 +1290,40 @@ protected:
               TraitsType::type_name(),
               to_string(static_cast<MessageId>(sample.header_.message_id_))));
           }
-          filtered = true;
+          decoded.filtered = true;
           return;
         }
         const MessageType& type = static_cast<MessageType&>(*data);
         if (!content_filtered_topic_->filter(type, sample_only_has_key_fields)) {
-          filtered = true;
+          decoded.filtered = true;
           return;
         }
       }
     }
 #endif
 
-    store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
+    decoded.data.reset(data.release());
+  }
+
+  /**
+   * Samples of keyless types can be stored serialized and deserialized when
+   * they are accessed unless something has to look at them on arrival.
+   * Keyed types always need the key to find the instance.
+   */
+  bool can_defer_deserialization(const DataSampleHeader& header)
+  {
+    if (!lazy_deserialization_ || type_support_->key_count() || !header.valid_data()) {
+      return false;
+    }
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    if (!header.content_filter_) {
+      ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
+      if (content_filtered_topic_) {
+        return false;
+      }
+    }
+#endif
+    return !get_observer(Observer::e_SAMPLE_RECEIVED);
   }
 
   virtual void dispose_unregister(const OpenDDS::DCPS::ReceivedDataSample& sample,
@@ -1254,7 +1371,7 @@ protected:
       if (inst != 0) {
         const typename ReverseInstanceMap::iterator pos = reverse_instance_map_.find(handle);
         if (pos != reverse_instance_map_.end()) {
-          inst->erase(pos->second->first);
+          inst->erase(*pos->second);
         }
       }
     }
@@ -1262,8 +1379,10 @@ protected:
 
     const typename ReverseInstanceMap::iterator pos = reverse_instance_map_.find(handle);
     if (pos != reverse_instance_map_.end()) {
-      remove_from_lookup_maps(handle);
-      instance_map_.erase(pos->second);
+      const typename InstanceMap::iterator it = instance_map_.find(*pos->second);
+      if (it != instance_map_.end()) {
+        instance_map_.erase(it);
+      }
       reverse_instance_map_.erase(pos);
     }
   }
@@ -1392,9 +1511,9 @@ private:
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (!group_coherent_ordered) {
 #endif
-    const HandleSet& matches = lookup_matching_instances(sample_states, view_states, instance_states);
-    for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
-      ++next; // pre-increment iterator, in case updates cause changes to match set
+    HandleVec matches;
+    matching_instances(sample_states, view_states, instance_states, matches);
+    for (HandleVec::const_iterator it = matches.begin(); it != matches.end(); ++it) {
       const DDS::InstanceHandle_t handle = *it;
       const SubscriptionInstance_rch inst = get_handle_instance(handle);
       if (!inst) continue;
@@ -1479,9 +1598,9 @@ DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (!group_coherent_ordered) {
 #endif
-    const HandleSet& matches = lookup_matching_instances(sample_states, view_states, instance_states);
-    for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
-      ++next; // pre-increment iterator, in case updates cause changes to match set
+    HandleVec matches;
+    matching_instances(sample_states, view_states, instance_states, matches);
+    for (HandleVec::const_iterator it = matches.begin(); it != matches.end(); ++it) {
       const DDS::InstanceHandle_t handle = *it;
       const SubscriptionInstance_rch inst = get_handle_instance(handle);
       if (!inst) continue;
@@ -1654,21 +1773,18 @@ DDS::ReturnCode_t read_next_instance_i(MessageSequenceType& received_data,
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, DDS::RETCODE_ERROR);
 
-  typename InstanceMap::iterator it = instance_map_.begin();
-  const typename InstanceMap::iterator the_end = instance_map_.end();
+  typename ReverseInstanceMap::const_iterator it = reverse_instance_map_.begin();
+  const typename ReverseInstanceMap::const_iterator the_end = reverse_instance_map_.end();
   if (a_handle != DDS::HANDLE_NIL) {
-    const typename ReverseInstanceMap::const_iterator pos = reverse_instance_map_.find(a_handle);
-    if (pos != reverse_instance_map_.end()) {
-      it = pos->second;
+    it = reverse_instance_map_.find(a_handle);
+    if (it != the_end) {
       ++it;
-    } else {
-      it = the_end;
     }
   }
 
   DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
   for (; it != the_end; ++it) {
-    handle = it->second;
+    handle = it->first;
     const DDS::ReturnCode_t status =
       read_instance_i(received_data, info_seq, max_samples, handle,
                       sample_states, view_states, instance_states,
@@ -1702,21 +1818,18 @@ DDS::ReturnCode_t take_next_instance_i(MessageSequenceType& received_data,
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, DDS::RETCODE_ERROR);
 
-  typename InstanceMap::iterator it = instance_map_.begin();
-  const typename InstanceMap::iterator the_end = instance_map_.end();
+  typename ReverseInstanceMap::const_iterator it = reverse_instance_map_.begin();
+  const typename ReverseInstanceMap::const_iterator the_end = reverse_instance_map_.end();
   if (a_handle != DDS::HANDLE_NIL) {
-    const typename ReverseInstanceMap::const_iterator pos = reverse_instance_map_.find(a_handle);
-    if (pos != reverse_instance_map_.end()) {
-      it = pos->second;
+    it = reverse_instance_map_.find(a_handle);
+    if (it != the_end) {
       ++it;
-    } else {
-      it = the_end;
     }
   }
 
   DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
   for (; it != the_end; ++it) {
-    handle = it->second;
+    handle = it->first;
     const DDS::ReturnCode_t status =
       take_instance_i(received_data, info_seq, max_samples, handle,
                       sample_states, view_states, instance_states,
@@ -1920,7 +2033,7 @@ void store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_data,
       }
       return;
     }
-    reverse_instance_map_[handle] = bpair.first;
+    reverse_instance_map_[handle] = &bpair.first->first;
   }
   else
   {
@@ -2503,6 +2616,7 @@ typedef OPENDDS_MULTIMAP(MonotonicTimePoint, DDS::InstanceHandle_t) FilterDelaye
 FilterDelayedSampleQueue filter_delayed_sample_queue_;
 
 bool marshal_skip_serialize_;
+const bool lazy_deserialization_;
 
 };
 
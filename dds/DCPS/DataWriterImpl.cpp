@@ -66,6 +66,7 @@ DataWriterImpl::DataWriterImpl()
   , association_chunk_multiplier_(TheServiceParticipant->association_chunk_multiplier())
   , qos_(TheServiceParticipant->initial_DataWriterQos())
   , skip_serialize_(false)
+  , serialized_size_hint_(0)
   , db_lock_pool_(new DataBlockLockPool((unsigned long)TheServiceParticipant->n_chunks()))
   , topic_id_(GUID_UNKNOWN)
   , topic_servant_(0)
@@ -1888,6 +1889,33 @@ DataWriterImpl::write(Message_Block_Ptr data,
                     DDS::RETCODE_ERROR);
 
   DataSampleElement* element = 0;
+  const DDS::ReturnCode_t ret = enqueue_sample(OPENDDS_MOVE_NS::move(data), handle,
+                                               source_timestamp, filter_out_var._retn(), element);
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  send_unsent_data(guard, dc_guard);
+
+  const ValueDispatcher* vd = get_value_dispatcher();
+  const Observer_rch observer = get_observer(Observer::e_SAMPLE_SENT);
+  if (observer && real_data && vd) {
+    Observer::Sample s(handle, element->get_header().instance_state(), source_timestamp, element->get_header().sequence_, real_data, *vd);
+    observer->on_sample_sent(this, s);
+  }
+
+  return DDS::RETCODE_OK;
+}
+
+DDS::ReturnCode_t
+DataWriterImpl::enqueue_sample(Message_Block_Ptr data,
+                               DDS::InstanceHandle_t handle,
+                               const DDS::Time_t& source_timestamp,
+                               GUIDSeq* filter_out,
+                               DataSampleElement*& element)
+{
+  GUIDSeq_var filter_out_var(filter_out);
+
   DDS::ReturnCode_t ret = this->data_container_->obtain_buffer(element, handle);
 
   if (ret == DDS::RETCODE_TIMEOUT) {
@@ -1896,7 +1924,7 @@ DataWriterImpl::write(Message_Block_Ptr data,
   } else if (ret != DDS::RETCODE_OK) {
     ACE_ERROR_RETURN((LM_ERROR,
                       ACE_TEXT("(%P|%t) ERROR: ")
-                      ACE_TEXT("DataWriterImpl::write: ")
+                      ACE_TEXT("DataWriterImpl::enqueue_sample: ")
                       ACE_TEXT("obtain_buffer returned %d.\n"),
                       ret),
                      ret);
@@ -1924,7 +1952,7 @@ DataWriterImpl::write(Message_Block_Ptr data,
     data_container_->release_buffer(element);
     ACE_ERROR_RETURN((LM_ERROR,
                       ACE_TEXT("(%P|%t) ERROR: ")
-                      ACE_TEXT("DataWriterImpl::write: ")
+                      ACE_TEXT("DataWriterImpl::enqueue_sample: ")
                       ACE_TEXT("enqueue failed.\n")),
                      ret);
   }
@@ -1936,6 +1964,14 @@ DataWriterImpl::write(Message_Block_Ptr data,
   if (this->coherent_) {
     ++this->coherent_samples_;
   }
+
+  return DDS::RETCODE_OK;
+}
+
+void
+DataWriterImpl::send_unsent_data(ACE_Guard<ACE_Recursive_Thread_Mutex>& guard,
+                                 ACE_Guard<ACE_Recursive_Thread_Mutex>& dc_guard)
+{
   SendStateDataSampleList list;
 
   ACE_UINT64 transaction_id = this->get_unsent_data(list);
@@ -1958,15 +1994,81 @@ DataWriterImpl::write(Message_Block_Ptr data,
     guard.release();
     this->send(list, transaction_id);
   }
+}
+
+DDS::ReturnCode_t
+DataWriterImpl::write_batch(BatchSampleList& batch,
+                            const DDS::Time_t& source_timestamp)
+{
+  DBG_ENTRY_LVL("DataWriterImpl","write_batch",6);
+
+  DDS::ReturnCode_t ret = enabled_ ? DDS::RETCODE_OK : DDS::RETCODE_NOT_ENABLED;
+  if (ret != DDS::RETCODE_OK && log_level >= LogLevel::Error) {
+    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::write_batch: "
+               "Entity is not enabled.\n"));
+  }
+
+  typedef OPENDDS_MAP(DDS::InstanceHandle_t, size_t) PendingCounts;
+  // The elements can be released once they are sent, so keep what the
+  // observer needs. Entry i is for batch[i].
+  OPENDDS_VECTOR(DDS::InstanceStateKind) instance_states;
+  OPENDDS_VECTOR(SequenceNumber) sequences;
+  instance_states.reserve(batch.size());
+  sequences.reserve(batch.size());
+  size_t next = 0;
+  while (ret == DDS::RETCODE_OK && next < batch.size()) {
+    ACE_Guard<ACE_Recursive_Thread_Mutex> guard(lock_);
+    ACE_Guard<ACE_Recursive_Thread_Mutex> dc_guard(get_lock());
+    if (!dc_guard.locked()) {
+      ret = DDS::RETCODE_ERROR;
+      break;
+    }
+
+    // Samples enqueued under this lock stay unsent until the end of the
+    // round. Hand them to the transport early if the next one could make
+    // the container replace or wait for one of them.
+    PendingCounts pending;
+    size_t pending_total = 0;
+    for (; next < batch.size(); ++next) {
+      BatchSample& item = batch[next];
+      size_t& instance_pending = pending[item.handle];
+      if (pending_total && data_container_->batch_needs_flush(instance_pending, pending_total)) {
+        break;
+      }
+      // enqueue_sample owns them from here on, whatever it returns.
+      Message_Block_Ptr data(item.data);
+      GUIDSeq* const filter_out = item.filter_out;
+      item.data = 0;
+      item.filter_out = 0;
+      DataSampleElement* element = 0;
+      ret = enqueue_sample(OPENDDS_MOVE_NS::move(data), item.handle, source_timestamp,
+                           filter_out, element);
+      if (ret != DDS::RETCODE_OK) {
+        break;
+      }
+      instance_states.push_back(element->get_header().instance_state());
+      sequences.push_back(element->get_header().sequence_);
+      ++instance_pending;
+      ++pending_total;
+    }
+
+    if (pending_total) {
+      send_unsent_data(guard, dc_guard);
+    }
+  }
 
   const ValueDispatcher* vd = get_value_dispatcher();
   const Observer_rch observer = get_observer(Observer::e_SAMPLE_SENT);
-  if (observer && real_data && vd) {
-    Observer::Sample s(handle, element->get_header().instance_state(), source_timestamp, element->get_header().sequence_, real_data, *vd);
-    observer->on_sample_sent(this, s);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const BatchSample& item = batch[i];
+    if (observer && i < sequences.size() && item.real_data && vd) {
+      Observer::Sample s(item.handle, instance_states[i], source_timestamp, sequences[i], item.real_data, *vd);
+      observer->on_sample_sent(this, s);
+    }
   }
+  batch.clear();
 
-  return DDS::RETCODE_OK;
+  return ret;
 }
 
 void DataWriterImpl::get_flexible_types(const char* key, XTypes::TypeInformation& type_info)
@@ -2989,17 +3091,58 @@ DDS::ReturnCode_t DataWriterImpl::dispose_w_timestamp(
 
 ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
 {
-  const bool encapsulated = cdr_encapsulation();
-  const Encoding& encoding = encoding_mode_.encoding();
   Message_Block_Ptr mb;
-  ACE_Message_Block* tmp_mb;
+
+  if (skip_serialize_) {
+    mb.reset(alloc_sample_block(encoding_mode_.buffer_size(sample), sample.key_only()));
+    if (!mb) {
+      return 0;
+    }
+    if (!sample.to_message_block(*mb)) {
+      if (log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+                   "to_message_block failed\n"));
+      }
+      return 0;
+    }
+    return mb.release();
+  }
+
+  // Without a bound, computing the exact size means walking the sample once
+  // before serializing it. Try a buffer sized from the previous sample first
+  // and only fall back to the sizing pass if it turns out to be too small.
+  const bool use_hint = !sample.key_only() && !encoding_mode_.bound();
+  const size_t hint = use_hint ? serialized_size_hint_.load() : 0;
+  if (hint) {
+    mb.reset(alloc_sample_block(hint + hint / 4, false));
+    if (mb && serialize_sample_i(sample, mb, false)) {
+      serialized_size_hint_ = mb->length();
+      return mb.release();
+    }
+  }
+
+  mb.reset(alloc_sample_block(encoding_mode_.buffer_size(sample), sample.key_only()));
+  if (!mb || !serialize_sample_i(sample, mb, true)) {
+    return 0;
+  }
+  if (use_hint) {
+    // A sample that outgrew the hint is likely followed by more large ones,
+    // so leave them more room than the usual headroom.
+    serialized_size_hint_ = hint ? 2 * mb->length() : mb->length();
+  }
+  return mb.release();
+}
+
+ACE_Message_Block* DataWriterImpl::alloc_sample_block(size_t size, bool key_only)
+{
+  ACE_Message_Block* mb;
 
   // Don't use the cached allocator for the registered sample message
   // block.
-  if (sample.key_only() && !skip_serialize_) {
-    ACE_NEW_RETURN(tmp_mb,
+  if (key_only && !skip_serialize_) {
+    ACE_NEW_RETURN(mb,
       ACE_Message_Block(
-        encoding_mode_.buffer_size(sample),
+        size,
         ACE_Message_Block::MB_DATA,
         0, // cont
         0, // data
@@ -3007,11 +3150,11 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
         get_db_lock()),
       0);
   } else {
-    ACE_NEW_MALLOC_RETURN(tmp_mb,
+    ACE_NEW_MALLOC_RETURN(mb,
       static_cast<ACE_Message_Block*>(
         mb_allocator_->malloc(sizeof(ACE_Message_Block))),
       ACE_Message_Block(
-        encoding_mode_.buffer_size(sample),
+        size,
         ACE_Message_Block::MB_DATA,
         0, // cont
         0, // data
@@ -3024,49 +3167,43 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
         mb_allocator_.get()),
       0);
   }
-  mb.reset(tmp_mb);
+  return mb;
+}
 
-  if (skip_serialize_) {
-    if (!sample.to_message_block(*mb)) {
-      if (log_level >= LogLevel::Error) {
-        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
-                   "to_message_block failed\n"));
-      }
-      return 0;
-    }
-  } else {
-    Serializer serializer(mb.get(), encoding);
-    if (encapsulated) {
-      EncapsulationHeader encap;
-      if (!from_encoding(encap, encoding, type_support_->base_extensibility())) {
-        // from_encoding logged the error
-        return 0;
-      }
-      if (!(serializer << encap)) {
-        if (log_level >= LogLevel::Error) {
-          ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
-            "failed to serialize data encapsulation header\n"));
-        }
-        return 0;
-      }
+bool DataWriterImpl::serialize_sample_i(const Sample& sample, Message_Block_Ptr& mb, bool log)
+{
+  const Encoding& encoding = encoding_mode_.encoding();
+  const bool encapsulated = cdr_encapsulation();
+  Serializer serializer(mb.get(), encoding);
+  if (encapsulated) {
+    EncapsulationHeader encap;
+    if (!from_encoding(encap, encoding, type_support_->base_extensibility())) {
+      // from_encoding logged the error
+      return false;
     }
-    if (!sample.serialize(serializer)) {
-      if (log_level >= LogLevel::Error) {
+    if (!(serializer << encap)) {
+      if (log && log_level >= LogLevel::Error) {
         ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
-          "failed to serialize sample data\n"));
+          "failed to serialize data encapsulation header\n"));
       }
-      return 0;
+      return false;
     }
-    if (encapsulated && !EncapsulationHeader::set_encapsulation_options(mb)) {
-      if (log_level >= LogLevel::Error) {
-        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
-          "set_encapsulation_options failed\n"));
-      }
-      return 0;
+  }
+  if (!sample.serialize(serializer)) {
+    if (log && log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+        "failed to serialize sample data\n"));
     }
+    return false;
   }
-
-  return mb.release();
+  if (encapsulated && !EncapsulationHeader::set_encapsulation_options(mb)) {
+    if (log && log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+        "set_encapsulation_options failed\n"));
+    }
+    return false;
+  }
+  return true;
 }
 
 bool DataWriterImpl::insert_instance(DDS::InstanceHandle_t handle, Sample_rch& sample)
@@ -3191,6 +3328,112 @@ DDS::ReturnCode_t DataWriterImpl::write_w_timestamp(
   const Sample& sample,
   DDS::InstanceHandle_t handle,
   const DDS::Time_t& source_timestamp)
+{
+  GUIDSeq_var filter_out;
+  const DDS::ReturnCode_t ret = prepare_write(sample, handle, source_timestamp, filter_out);
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  return write_sample(sample, handle, source_timestamp, filter_out._retn());
+}
+
+DDS::ReturnCode_t DataWriterImpl::add_to_batch(
+  BatchSampleList& batch,
+  const Sample& sample,
+  DDS::InstanceHandle_t handle,
+  const DDS::Time_t& source_timestamp)
+{
+  GUIDSeq_var filter_out;
+  const DDS::ReturnCode_t ret = prepare_write(sample, handle, source_timestamp, filter_out);
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  Message_Block_Ptr serialized(serialize_sample(sample));
+  if (!serialized) {
+    if (log_level >= LogLevel::Notice) {
+      ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: DataWriterImpl::add_to_batch: "
+        "failed to serialize sample\n"));
+    }
+    return DDS::RETCODE_ERROR;
+  }
+
+  const BatchSample item = { handle, serialized.get(), filter_out.ptr(), sample.native_data() };
+  batch.push_back(item);
+  // batch owns them now.
+  serialized.release();
+  filter_out._retn();
+  return DDS::RETCODE_OK;
+}
+
+DDS::ReturnCode_t DataWriterImpl::serialize_for_write(
+  const Sample& sample,
+  SerializedSample& serialized)
+{
+  if (skip_serialize_ || !encoding_mode_.valid()) {
+    if (log_level >= LogLevel::Notice) {
+      ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: DataWriterImpl::serialize_for_write: "
+        "DataWriter doesn't serialize samples\n"));
+    }
+    return DDS::RETCODE_PRECONDITION_NOT_MET;
+  }
+
+  Message_Block_Ptr mb(new ACE_Message_Block(encoding_mode_.buffer_size(sample)));
+  if (!serialize_sample_i(sample, mb, true)) {
+    return DDS::RETCODE_ERROR;
+  }
+
+  const Encoding& encoding = encoding_mode_.encoding();
+  serialized.sample_ = sample.copy(Sample::ReadOnly);
+  serialized.encoding_kind_ = encoding.kind();
+  serialized.swap_bytes_ = encoding.swap_bytes();
+  serialized.data_ = Message_Block_Shared_Ptr(mb.release());
+  return DDS::RETCODE_OK;
+}
+
+DDS::ReturnCode_t DataWriterImpl::write_serialized_w_timestamp(
+  const SerializedSample& serialized,
+  DDS::InstanceHandle_t handle,
+  const DDS::Time_t& source_timestamp)
+{
+  const Encoding& encoding = encoding_mode_.encoding();
+  if (skip_serialize_ || !encoding_mode_.valid() || !serialized.sample_ || !serialized.data_ ||
+      serialized.encoding_kind_ != encoding.kind() ||
+      serialized.swap_bytes_ != encoding.swap_bytes()) {
+    if (log_level >= LogLevel::Notice) {
+      ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: DataWriterImpl::write_serialized_w_timestamp: "
+        "serialized sample doesn't match the encoding of the DataWriter\n"));
+    }
+    return DDS::RETCODE_PRECONDITION_NOT_MET;
+  }
+
+  const Sample& sample = *serialized.sample_;
+  GUIDSeq_var filter_out;
+  const DDS::ReturnCode_t ret = prepare_write(sample, handle, source_timestamp, filter_out);
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  // Copy into a block from this DataWriter's allocators. Sharing the data
+  // block would tie its reference count and lifetime to the DataWriter that
+  // serialized it.
+  Message_Block_Ptr copy(alloc_sample_block(serialized.data_->total_length(), false));
+  if (!copy) {
+    return DDS::RETCODE_ERROR;
+  }
+  for (const ACE_Message_Block* mb = serialized.data_.get(); mb; mb = mb->cont()) {
+    copy->copy(mb->rd_ptr(), mb->length());
+  }
+
+  return write(OPENDDS_MOVE_NS::move(copy), handle, source_timestamp, filter_out._retn(), sample.native_data());
+}
+
+DDS::ReturnCode_t DataWriterImpl::prepare_write(
+  const Sample& sample,
+  DDS::InstanceHandle_t& handle,
+  const DDS::Time_t& source_timestamp,
+  GUIDSeq_var& filter_out)
 {
   // This operation assumes the provided handle is valid. The handle provided
   // will not be verified.
@@ -3201,7 +3444,7 @@ DDS::ReturnCode_t DataWriterImpl::write_w_timestamp(
       get_or_create_instance_handle(registered_handle, sample, source_timestamp);
     if (ret != DDS::RETCODE_OK) {
       if (log_level >= LogLevel::Notice) {
-        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: %CDataWriterImpl::write_w_timestamp: "
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: %CDataWriterImpl::prepare_write: "
                    "register failed: %C\n",
                    get_type_support()->name(),
                    retcode_to_string(ret)));
@@ -3213,7 +3456,6 @@ DDS::ReturnCode_t DataWriterImpl::write_w_timestamp(
   }
 
   // list of reader GUID_ts that should not get data
-  GUIDSeq_var filter_out;
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
   if (publisher_content_filter_) {
     ACE_GUARD_RETURN(ACE_Thread_Mutex, reader_info_guard, reader_info_lock_, DDS::RETCODE_ERROR);
@@ -3232,7 +3474,7 @@ DDS::ReturnCode_t DataWriterImpl::write_w_timestamp(
   }
 #endif
 
-  return write_sample(sample, handle, source_timestamp, filter_out._retn());
+  return DDS::RETCODE_OK;
 }
 
 DDS::ReturnCode_t DataWriterImpl::write_sample(
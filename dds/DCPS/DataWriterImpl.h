@@ -286,6 +286,113 @@ public:
     const DDS::Time_t& source_timestamp,
     GUIDSeq* filter_out);
 
+  /// A serialized sample waiting to be passed to write_batch. data and
+  /// filter_out belong to the BatchSampleList holding it.
+  struct BatchSample {
+    DDS::InstanceHandle_t handle;
+    ACE_Message_Block* data;
+    GUIDSeq* filter_out;
+    const void* real_data;
+  };
+
+  /// The samples of a batch. Releases the data and filter_out that weren't
+  /// taken out of them when it's cleared or destroyed.
+  class BatchSampleList {
+  public:
+    BatchSampleList() {}
+    ~BatchSampleList() { clear(); }
+
+    void reserve(size_t count) { samples_.reserve(count); }
+    void push_back(const BatchSample& sample) { samples_.push_back(sample); }
+    size_t size() const { return samples_.size(); }
+    BatchSample& operator[](size_t i) { return samples_[i]; }
+    const BatchSample& operator[](size_t i) const { return samples_[i]; }
+
+    void clear()
+    {
+      for (OPENDDS_VECTOR(BatchSample)::iterator it = samples_.begin(); it != samples_.end(); ++it) {
+        ACE_Message_Block::release(it->data);
+        delete it->filter_out;
+      }
+      samples_.clear();
+    }
+
+  private:
+    BatchSampleList(const BatchSampleList&);
+    BatchSampleList& operator=(const BatchSampleList&);
+
+    OPENDDS_VECTOR(BatchSample) samples_;
+  };
+
+  /**
+   * Register the instance of sample if needed, evaluate content filters,
+   * and serialize sample onto the end of batch.
+   */
+  DDS::ReturnCode_t add_to_batch(
+    BatchSampleList& batch,
+    const Sample& sample,
+    DDS::InstanceHandle_t handle,
+    const DDS::Time_t& source_timestamp);
+
+  /**
+   * Like write, but for every sample in batch. The samples are queued in
+   * the WriteDataContainer under one acquisition of the locks and are given
+   * to the transport together, unless the resource limits would force the
+   * container to replace or wait for samples that haven't been sent yet.
+   * Stops at the first sample that fails and returns its error. batch is
+   * always emptied.
+   */
+  DDS::ReturnCode_t write_batch(BatchSampleList& batch,
+                                const DDS::Time_t& source_timestamp);
+
+  /**
+   * A sample serialized by serialize_for_write(), together with a read-only
+   * copy of the sample.  Writing it uses the copy to find the instance and
+   * evaluate content filters, so they always match the serialized data.  It
+   * can be written by any DataWriter of the same type whose encoding
+   * matches, see write_serialized_w_timestamp().  DataWriters only read it,
+   * so one SerializedSample can be written by several of them at the same
+   * time.
+   */
+  class SerializedSample {
+  public:
+    SerializedSample()
+      : encoding_kind_(Encoding::KIND_XCDR1)
+      , swap_bytes_(false)
+    {
+    }
+
+    /// The copy of the sample that was serialized, nil if none was.
+    const Sample_rch& sample() const
+    {
+      return sample_;
+    }
+
+  private:
+    friend class DataWriterImpl;
+
+    Sample_rch sample_;
+    Encoding::Kind encoding_kind_;
+    bool swap_bytes_;
+    Message_Block_Shared_Ptr data_;
+  };
+
+  /**
+   * Serialize sample with this DataWriter's encoding. The result doesn't use
+   * this DataWriter's allocators, so it can outlive it.
+   */
+  DDS::ReturnCode_t serialize_for_write(const Sample& sample,
+                                        SerializedSample& serialized);
+
+  /**
+   * Like write_w_timestamp, but copies the data from serialized instead of
+   * serializing the sample again. Returns PRECONDITION_NOT_MET if serialized
+   * is empty or doesn't have the encoding of this DataWriter.
+   */
+  DDS::ReturnCode_t write_serialized_w_timestamp(const SerializedSample& serialized,
+                                                 DDS::InstanceHandle_t handle,
+                                                 const DDS::Time_t& source_timestamp);
+
   /**
    * Delegate to the WriteDataContainer to dispose all data
    * samples for a given instance and tell the transport to
@@ -542,6 +649,8 @@ protected:
   DDS::ReturnCode_t setup_serialization();
 
   ACE_Message_Block* serialize_sample(const Sample& sample);
+  ACE_Message_Block* alloc_sample_block(size_t size, bool key_only);
+  bool serialize_sample_i(const Sample& sample, Message_Block_Ptr& mb, bool log);
 
   const bool publisher_content_filter_;
 
@@ -597,6 +706,11 @@ protected:
 
   bool skip_serialize_;
 
+  /// Length of the last unbounded sample serialized, doubled if it didn't fit
+  /// the hint before it, used to size the buffer for the next one so
+  /// serialize_sample can skip the serialized_size pass.
+  Atomic<size_t> serialized_size_hint_;
+
   /**
    * Used to hold the encoding and get the buffer sizes needed to store the
    * results of the encoding.
@@ -680,6 +794,27 @@ private:
 
   void track_sequence_number(GUIDSeq* filter_out);
 
+  /// Register the instance if handle is nil and find the readers that
+  /// filter out sample.
+  DDS::ReturnCode_t prepare_write(
+    const Sample& sample,
+    DDS::InstanceHandle_t& handle,
+    const DDS::Time_t& source_timestamp,
+    GUIDSeq_var& filter_out);
+
+  /// Queue a serialized sample in the WriteDataContainer. The caller must
+  /// hold lock_ and get_lock().
+  DDS::ReturnCode_t enqueue_sample(Message_Block_Ptr data,
+                                   DDS::InstanceHandle_t handle,
+                                   const DDS::Time_t& source_timestamp,
+                                   GUIDSeq* filter_out,
+                                   DataSampleElement*& element);
+
+  /// Pass the queued samples to the transport, releasing the guards first,
+  /// or hold them if the publisher is suspended.
+  void send_unsent_data(ACE_Guard<ACE_Recursive_Thread_Mutex>& guard,
+                        ACE_Guard<ACE_Recursive_Thread_Mutex>& dc_guard);
+
   void notify_publication_lost(const DDS::InstanceHandleSeq& handles);
 
   DDS::ReturnCode_t dispose_and_unregister(DDS::InstanceHandle_t handle,
@@ -850,7 +985,12 @@ private:
 
   typedef OPENDDS_MAP(DDS::InstanceHandle_t, Sample_rch) InstanceHandlesToValues;
   InstanceHandlesToValues instance_handles_to_values_;
+#ifdef ACE_HAS_CPP11
+  typedef OPENDDS_UNORDERED_MAP_CHASH_CEQ(Sample_rch, DDS::InstanceHandle_t,
+                                          SampleRchHash, SampleRchEqual) InstanceValuesToHandles;
+#else
   typedef OPENDDS_MAP_CMP(Sample_rch, DDS::InstanceHandle_t, SampleRchCmp) InstanceValuesToHandles;
+#endif
   InstanceValuesToHandles instance_values_to_handles_;
 
   bool insert_instance(DDS::InstanceHandle_t handle, Sample_rch& sample);
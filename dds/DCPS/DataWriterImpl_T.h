@@ -42,6 +42,8 @@ DataWriterImpl_T
 , public virtual DataWriterImpl
 {
 public:
+  typedef typename DDSTraits<MessageType>::MessageSequenceType MessageSequenceType;
+
   DataWriterImpl_T()
   {
   }
@@ -96,6 +98,74 @@ public:
     return DataWriterImpl::write_w_timestamp(sample, handle, source_timestamp);
   }
 
+  /**
+   * Write all of samples, taking the DataWriter's locks once and giving the
+   * samples to the transport together so it can pack them into fewer
+   * messages. handles is either empty, which is the same as HANDLE_NIL for
+   * every sample, or has a handle for each sample. Writing stops at the
+   * first sample that fails, the samples before it are still written.
+   */
+  DDS::ReturnCode_t write_batch(const MessageSequenceType& samples,
+                                const DDS::InstanceHandleSeq& handles)
+  {
+    return write_batch_w_timestamp(samples, handles, SystemTimePoint::now().to_idl_struct());
+  }
+
+  DDS::ReturnCode_t write_batch_w_timestamp(const MessageSequenceType& samples,
+                                            const DDS::InstanceHandleSeq& handles,
+                                            const DDS::Time_t& source_timestamp)
+  {
+    if (handles.length() != 0 && handles.length() != samples.length()) {
+      return DDS::RETCODE_BAD_PARAMETER;
+    }
+
+    BatchSampleList batch;
+    batch.reserve(samples.length());
+    DDS::ReturnCode_t rc = DDS::RETCODE_OK;
+    for (CORBA::ULong i = 0; rc == DDS::RETCODE_OK && i < samples.length(); ++i) {
+      const SampleType sample(samples[i]);
+      rc = add_to_batch(batch, sample, handles.length() ? handles[i] : DDS::HANDLE_NIL, source_timestamp);
+    }
+
+    const DDS::ReturnCode_t write_rc = DataWriterImpl::write_batch(batch, source_timestamp);
+    return rc == DDS::RETCODE_OK ? write_rc : rc;
+  }
+
+  /**
+   * Serialize a sample once so it can be written by several DataWriters of
+   * this type that use the same encoding, for example when the same sample
+   * is published in more than one partition or domain.
+   */
+  DDS::ReturnCode_t serialize_for_write(const MessageType& instance_data,
+                                        SerializedSample& serialized)
+  {
+    const SampleType sample(instance_data);
+    return DataWriterImpl::serialize_for_write(sample, serialized);
+  }
+
+  /// Write a sample serialized by serialize_for_write() without serializing
+  /// it again.
+  DDS::ReturnCode_t write_serialized(const SerializedSample& serialized,
+                                     DDS::InstanceHandle_t handle)
+  {
+    return write_serialized_w_timestamp(serialized, handle,
+                                        SystemTimePoint::now().to_idl_struct());
+  }
+
+  DDS::ReturnCode_t write_serialized_w_timestamp(const SerializedSample& serialized,
+                                                 DDS::InstanceHandle_t handle,
+                                                 const DDS::Time_t& source_timestamp)
+  {
+    if (!dynamic_cast<const SampleType*>(serialized.sample().in())) {
+      if (log_level >= LogLevel::Notice) {
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: DataWriterImpl_T::write_serialized_w_timestamp: "
+          "serialized sample isn't of this DataWriter's type\n"));
+      }
+      return DDS::RETCODE_PRECONDITION_NOT_MET;
+    }
+    return DataWriterImpl::write_serialized_w_timestamp(serialized, handle, source_timestamp);
+  }
+
   DDS::ReturnCode_t dispose(const MessageType& instance_data, DDS::InstanceHandle_t instance_handle)
   {
     return dispose_w_timestamp(instance_data, instance_handle, SystemTimePoint::now().to_idl_struct());
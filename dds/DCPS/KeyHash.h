@@ -0,0 +1,168 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_KEY_HASH_H
+#define OPENDDS_DCPS_KEY_HASH_H
+
+#include <ace/config-macros.h>
+#ifndef ACE_LACKS_PRAGMA_ONCE
+#  pragma once
+#endif
+
+#include "Hash.h"
+
+#include <tao/String_Manager_T.h>
+#include <ace/CDR_Base.h>
+
+#include <string>
+#ifdef ACE_HAS_CPP11
+#  include <array>
+#  include <type_traits>
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+// Helpers for the <Type>_OpenDDS_KeyHash functors generated by opendds_idl.
+// Keys that compare equal with <Type>_OpenDDS_KeyLessThan must hash the same.
+
+inline void hash_combine(size_t& seed, size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template <typename T>
+inline void hash_key_bytes(size_t& seed, T value)
+{
+  hash_combine(seed, fnv_1a_hash(reinterpret_cast<const unsigned char*>(&value), sizeof value));
+}
+
+// Integral key members have no padding, so their bytes can be hashed.  Other
+// types need an overload that hashes what <Type>_OpenDDS_KeyLessThan compares,
+// opendds_idl generates them for nested structs with keys.
+#define OPENDDS_HASH_KEY_INTEGRAL(T) \
+  inline void hash_key_member(size_t& seed, T value) \
+  { \
+    hash_key_bytes(seed, value); \
+  }
+OPENDDS_HASH_KEY_INTEGRAL(bool)
+OPENDDS_HASH_KEY_INTEGRAL(char)
+OPENDDS_HASH_KEY_INTEGRAL(signed char)
+OPENDDS_HASH_KEY_INTEGRAL(unsigned char)
+OPENDDS_HASH_KEY_INTEGRAL(wchar_t)
+OPENDDS_HASH_KEY_INTEGRAL(short)
+OPENDDS_HASH_KEY_INTEGRAL(unsigned short)
+OPENDDS_HASH_KEY_INTEGRAL(int)
+OPENDDS_HASH_KEY_INTEGRAL(unsigned int)
+OPENDDS_HASH_KEY_INTEGRAL(long)
+OPENDDS_HASH_KEY_INTEGRAL(unsigned long)
+OPENDDS_HASH_KEY_INTEGRAL(long long)
+OPENDDS_HASH_KEY_INTEGRAL(unsigned long long)
+#undef OPENDDS_HASH_KEY_INTEGRAL
+
+// 0.0 and -0.0 compare equal.
+inline void hash_key_member(size_t& seed, float value)
+{
+  if (value == 0) {
+    hash_combine(seed, 0);
+  } else {
+    hash_key_bytes(seed, value);
+  }
+}
+
+inline void hash_key_member(size_t& seed, double value)
+{
+  if (value == 0) {
+    hash_combine(seed, 0);
+  } else {
+    hash_key_bytes(seed, value);
+  }
+}
+
+// The representation of long double can have padding.  Equal values convert
+// to equal doubles.
+inline void hash_key_member(size_t& seed, long double value)
+{
+  hash_key_member(seed, static_cast<double>(value));
+}
+
+#ifdef NONNATIVE_LONGDOUBLE
+inline void hash_key_member(size_t& seed, const ACE_CDR::LongDouble& value)
+{
+  hash_key_member(seed, static_cast<double>(static_cast<ACE_CDR::LongDouble::NativeImpl>(value)));
+}
+#endif
+
+#ifdef ACE_HAS_CPP11
+// Unscoped enums would also convert to an integral type, scoped enums don't.
+template <typename T>
+inline typename std::enable_if<std::is_enum<T>::value>::type
+hash_key_member(size_t& seed, T value)
+{
+  hash_key_member(seed, static_cast<typename std::underlying_type<T>::type>(value));
+}
+#endif
+
+template <typename CharT>
+inline void hash_key_member(size_t& seed, const CharT* value)
+{
+  size_t length = 0;
+  if (value) {
+    while (value[length]) {
+      ++length;
+    }
+  }
+  hash_combine(seed, fnv_1a_hash(reinterpret_cast<const unsigned char*>(value), length * sizeof(CharT)));
+}
+
+template <typename CharT>
+inline void hash_key_member(size_t& seed, const TAO::String_Manager_T<CharT>& value)
+{
+  hash_key_member(seed, value.in());
+}
+
+template <typename CharT, typename Traits, typename Alloc>
+inline void hash_key_member(size_t& seed, const std::basic_string<CharT, Traits, Alloc>& value)
+{
+  hash_combine(seed, fnv_1a_hash(reinterpret_cast<const unsigned char*>(value.data()), value.size() * sizeof(CharT)));
+}
+
+template <typename T, size_t N>
+inline void hash_key_member(size_t& seed, const T (&value)[N])
+{
+  for (size_t i = 0; i < N; ++i) {
+    hash_key_member(seed, value[i]);
+  }
+}
+
+#ifdef ACE_HAS_CPP11
+template <typename T, size_t N>
+inline void hash_key_member(size_t& seed, const std::array<T, N>& value)
+{
+  for (size_t i = 0; i < N; ++i) {
+    hash_key_member(seed, value[i]);
+  }
+}
+#endif
+
+/// Key equality derived from a generated <Type>_OpenDDS_KeyLessThan.
+template <typename LessThan>
+struct KeyEqual {
+  template <typename T>
+  bool operator()(const T& lhs, const T& rhs) const
+  {
+    const LessThan less = LessThan();
+    return !less(lhs, rhs) && !less(rhs, lhs);
+  }
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_DCPS_KEY_HASH_H
@@ -158,6 +158,10 @@ typedef std::basic_string<wchar_t, std::char_traits<wchar_t>, OPENDDS_ALLOCATOR(
           OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, V > > >
 #define OPENDDS_UNORDERED_MAP_CHASH_T(K, V, C) std::unordered_map<K, V, C, std::equal_to<K >, \
           OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, V > > >
+#define OPENDDS_UNORDERED_MAP_CHASH_CEQ(K, V, C, E) std::unordered_map<K, V, C, E, \
+          OpenDDS::DCPS::PoolAllocator<std::pair<OpenDDS::DCPS::add_const<K >::type, V > > >
+#define OPENDDS_UNORDERED_MAP_CHASH_CEQ_T(K, V, C, E) std::unordered_map<K, V, C, E, \
+          OpenDDS::DCPS::PoolAllocator<std::pair<typename OpenDDS::DCPS::add_const<K >::type, V > > >
 #endif
 
 #else // (!OPENDDS_POOL_ALLOCATOR)
@@ -186,6 +190,8 @@ typedef std::wstring WString;
 #define OPENDDS_UNORDERED_MAP_CHASH(K, V, C) std::unordered_map<K, V, C >
 #define OPENDDS_UNORDERED_MAP_T OPENDDS_UNORDERED_MAP
 #define OPENDDS_UNORDERED_MAP_CHASH_T OPENDDS_UNORDERED_MAP_CHASH
+#define OPENDDS_UNORDERED_MAP_CHASH_CEQ(K, V, C, E) std::unordered_map<K, V, C, E >
+#define OPENDDS_UNORDERED_MAP_CHASH_CEQ_T OPENDDS_UNORDERED_MAP_CHASH_CEQ
 #endif
 
 #endif // OPENDDS_POOL_ALLOCATOR
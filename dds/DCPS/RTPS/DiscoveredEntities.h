@@ -55,6 +55,7 @@ struct DiscoveredParticipant {
     , bit_ih_(DDS::HANDLE_NIL)
     , seq_reset_count_(0)
     , opendds_user_tag_(0)
+    , last_announcement_user_tag_(0)
 #if OPENDDS_CONFIG_SECURITY
     , have_spdp_info_(false)
     , have_sedp_info_(false)
@@ -89,6 +90,7 @@ struct DiscoveredParticipant {
     , max_seq_(seq)
     , seq_reset_count_(0)
     , opendds_user_tag_(p.participantProxy.opendds_user_tag)
+    , last_announcement_user_tag_(0)
 #if OPENDDS_CONFIG_SECURITY
     , have_spdp_info_(false)
     , have_sedp_info_(false)
@@ -157,6 +159,10 @@ struct DiscoveredParticipant {
   DCPS::SequenceNumber max_seq_;
   ACE_UINT16 seq_reset_count_;
   ACE_CDR::ULong opendds_user_tag_;
+  /// The serialized ParameterList and user tag of the last SPDP announcement
+  /// that was fully processed, used to skip decoding unchanged announcements.
+  OPENDDS_VECTOR(char) last_announcement_;
+  ACE_CDR::ULong last_announcement_user_tag_;
   typedef OPENDDS_LIST(BuiltinAssociationRecord) BuiltinAssociationRecords;
   BuiltinAssociationRecords builtin_pending_records_;
   BuiltinAssociationRecords builtin_associated_records_;
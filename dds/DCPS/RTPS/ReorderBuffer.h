@@ -0,0 +1,149 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+#ifndef OPENDDS_DCPS_RTPS_REORDER_BUFFER_H
+#define OPENDDS_DCPS_RTPS_REORDER_BUFFER_H
+
+#include <dds/Versioned_Namespace.h>
+
+#include <dds/DCPS/PoolAllocator.h>
+
+#include <ace/Guard_T.h>
+#include <ace/Reverse_Lock_T.h>
+#include <ace/Thread_Mutex.h>
+
+#include <functional>
+
+#ifndef ACE_LACKS_PRAGMA_ONCE
+#  pragma once
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace RTPS {
+
+/**
+ * Passes items that are completed on several threads to a handler in the
+ * order they were started.  Only one thread runs the handler at a time,
+ * items completed while it runs are handled by that thread.
+ *
+ * Each item belongs to a group.  The items of a group that were started but
+ * not handled yet can be dropped, so they are never handled.
+ */
+template <typename Item, typename Group, typename GroupLess = std::less<Group> >
+class ReorderBuffer {
+public:
+  ReorderBuffer()
+    : next_start_(0)
+    , next_handle_(0)
+    , handling_(false)
+    , shutdown_(false)
+  {}
+
+  /// Returns the index to complete the item with.
+  ACE_UINT64 start(const Group& group)
+  {
+    ACE_Guard<ACE_Thread_Mutex> g(mutex_);
+    const ACE_UINT64 index = next_start_++;
+    entries_[index].group_ = group;
+    return index;
+  }
+
+  /// Completes the item started as index.  A default constructed item can
+  /// be used if it failed, so the items after it are not held up.  Items
+  /// that are ready are passed to handler(const Item&) with the lock
+  /// released.
+  template <typename Handler>
+  void complete(ACE_UINT64 index, const Item& item, Handler& handler)
+  {
+    ACE_Guard<ACE_Thread_Mutex> g(mutex_);
+    const typename Entries::iterator entry = entries_.find(index);
+    if (entry == entries_.end()) {
+      return;
+    }
+    entry->second.item_ = item;
+    entry->second.completed_ = true;
+    if (handling_) {
+      return;
+    }
+
+    handling_ = true;
+    for (typename Entries::iterator pos = entries_.find(next_handle_);
+         pos != entries_.end() && pos->second.completed_; pos = entries_.find(next_handle_)) {
+      const Item next = pos->second.item_;
+      const bool dropped = pos->second.dropped_;
+      entries_.erase(pos);
+      ++next_handle_;
+      if (dropped || shutdown_) {
+        continue;
+      }
+
+      ACE_Reverse_Lock<ACE_Thread_Mutex> rev_lock(mutex_);
+      ACE_Guard<ACE_Reverse_Lock<ACE_Thread_Mutex> > rev_guard(rev_lock);
+      handler(next);
+    }
+    handling_ = false;
+  }
+
+  /// The items of group that were started, but not handled yet, won't be.
+  void drop(const Group& group)
+  {
+    ACE_Guard<ACE_Thread_Mutex> g(mutex_);
+    const GroupLess less = GroupLess();
+    for (typename Entries::iterator pos = entries_.begin(); pos != entries_.end(); ++pos) {
+      if (!less(pos->second.group_, group) && !less(group, pos->second.group_)) {
+        pos->second.dropped_ = true;
+        pos->second.item_ = Item();
+      }
+    }
+  }
+
+  /// No more items will be handled.
+  void shutdown()
+  {
+    ACE_Guard<ACE_Thread_Mutex> g(mutex_);
+    shutdown_ = true;
+    for (typename Entries::iterator pos = entries_.begin(); pos != entries_.end(); ++pos) {
+      pos->second.item_ = Item();
+    }
+  }
+
+  /// Number of items that were started, but not handled yet.
+  size_t pending() const
+  {
+    ACE_Guard<ACE_Thread_Mutex> g(mutex_);
+    return entries_.size();
+  }
+
+private:
+  struct Entry {
+    Entry()
+      : group_()
+      , item_()
+      , completed_(false)
+      , dropped_(false)
+    {}
+
+    Group group_;
+    Item item_;
+    bool completed_;
+    bool dropped_;
+  };
+  typedef OPENDDS_MAP(ACE_UINT64, Entry) Entries;
+
+  mutable ACE_Thread_Mutex mutex_;
+  ACE_UINT64 next_start_;
+  ACE_UINT64 next_handle_;
+  bool handling_;
+  bool shutdown_;
+  Entries entries_;
+};
+
+} // namespace RTPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_DCPS_RTPS_REORDER_BUFFER_H
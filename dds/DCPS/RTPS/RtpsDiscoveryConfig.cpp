@@ -1175,6 +1175,20 @@ RtpsDiscoveryConfig::sedp_receive_preallocated_data_blocks(size_t n)
                                                     static_cast<DDS::UInt32>(n));
 }
 
+size_t
+RtpsDiscoveryConfig::sedp_decode_threads() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("SEDP_DECODE_THREADS").c_str(),
+                                                           0);
+}
+
+void
+RtpsDiscoveryConfig::sedp_decode_threads(size_t n)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("SEDP_DECODE_THREADS").c_str(),
+                                                    static_cast<DDS::UInt32>(n));
+}
+
 bool
 RtpsDiscoveryConfig::check_source_ip() const
 {
@@ -249,6 +249,9 @@ public:
   size_t sedp_receive_preallocated_data_blocks() const;
   void sedp_receive_preallocated_data_blocks(size_t n);
 
+  size_t sedp_decode_threads() const;
+  void sedp_decode_threads(size_t n);
+
   bool check_source_ip() const;
   void check_source_ip(bool flag);
 
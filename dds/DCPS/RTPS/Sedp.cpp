@@ -27,6 +27,7 @@
 #include <dds/DCPS/SafetyProfileStreams.h>
 #include <dds/DCPS/SendStateDataSampleList.h>
 #include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/ServiceEventDispatcher.h>
 #include <dds/DCPS/Service_Participant.h>
 #include <dds/DCPS/Util.h>
 
@@ -45,6 +46,8 @@
 #  include <dds/DdsSecurityCoreTypeSupportImpl.h>
 #endif
 
+#include <ace/Reverse_Lock_T.h>
+
 #include <cstring>
 
 namespace {
@@ -314,6 +317,64 @@ namespace {
       ? ParameterListConverter::RDE_FRACTIONAL_SECONDS
       : ParameterListConverter::RDE_NANOSECONDS;
   }
+
+  // The QoS of discovered endpoints in the structures compatibleQOS uses
+  void discovered_qos(const DDS::PublicationBuiltinTopicData& bit,
+                      DDS::DataWriterQos& dwQos, DDS::PublisherQos& pubQos)
+  {
+    dwQos.durability = bit.durability;
+    dwQos.durability_service = bit.durability_service;
+    dwQos.deadline = bit.deadline;
+    dwQos.latency_budget = bit.latency_budget;
+    dwQos.liveliness = bit.liveliness;
+    dwQos.reliability = bit.reliability;
+    dwQos.destination_order = bit.destination_order;
+    dwQos.history = TheServiceParticipant->initial_HistoryQosPolicy();
+    dwQos.resource_limits =
+      TheServiceParticipant->initial_ResourceLimitsQosPolicy();
+    dwQos.transport_priority =
+      TheServiceParticipant->initial_TransportPriorityQosPolicy();
+    dwQos.lifespan = bit.lifespan;
+    dwQos.user_data = bit.user_data;
+    dwQos.ownership = bit.ownership;
+    dwQos.ownership_strength = bit.ownership_strength;
+    dwQos.writer_data_lifecycle =
+      TheServiceParticipant->initial_WriterDataLifecycleQosPolicy();
+    dwQos.representation = bit.representation;
+
+    pubQos.presentation = bit.presentation;
+    pubQos.partition = bit.partition;
+    pubQos.group_data = bit.group_data;
+    pubQos.entity_factory =
+      TheServiceParticipant->initial_EntityFactoryQosPolicy();
+  }
+
+  void discovered_qos(const DDS::SubscriptionBuiltinTopicData& bit,
+                      DDS::DataReaderQos& drQos, DDS::SubscriberQos& subQos)
+  {
+    drQos.durability = bit.durability;
+    drQos.deadline = bit.deadline;
+    drQos.latency_budget = bit.latency_budget;
+    drQos.liveliness = bit.liveliness;
+    drQos.reliability = bit.reliability;
+    drQos.destination_order = bit.destination_order;
+    drQos.history = TheServiceParticipant->initial_HistoryQosPolicy();
+    drQos.resource_limits =
+      TheServiceParticipant->initial_ResourceLimitsQosPolicy();
+    drQos.user_data = bit.user_data;
+    drQos.ownership = bit.ownership;
+    drQos.time_based_filter = bit.time_based_filter;
+    drQos.reader_data_lifecycle =
+      TheServiceParticipant->initial_ReaderDataLifecycleQosPolicy();
+    drQos.representation = bit.representation;
+    drQos.type_consistency = bit.type_consistency;
+
+    subQos.presentation = bit.presentation;
+    subQos.partition = bit.partition;
+    subQos.group_data = bit.group_data;
+    subQos.entity_factory =
+      TheServiceParticipant->initial_EntityFactoryQosPolicy();
+  }
 }
 
 RtpsDiscoveryCore::RtpsDiscoveryCore(RcHandle<RtpsDiscoveryConfig> config,
@@ -567,6 +628,10 @@ Sedp::init(const GUID_t& guid,
   // may not be reflected.
   event_dispatcher_ = transport_inst_->event_dispatcher(domainId, guid);
   job_queue_ = DCPS::make_rch<DCPS::JobQueue>(event_dispatcher_);
+  const size_t decode_threads = disco.config()->sedp_decode_threads();
+  if (decode_threads) {
+    decode_dispatcher_ = DCPS::make_rch<DCPS::ServiceEventDispatcher>(decode_threads);
+  }
   type_lookup_init();
 
   // Configure and enable each reader/writer
@@ -1630,6 +1695,10 @@ Sedp::disassociate(DiscoveredParticipant& participant)
 
   associated_participants_.erase(part);
 
+  // Don't apply what it sent before it was removed if it's discovered again.
+  publications_reader_->drop_decoding(part);
+  subscriptions_reader_->drop_decoding(part);
+
   OPENDDS_VECTOR(DiscoveredPublication) pubs_to_remove_from_bit;
   OPENDDS_VECTOR(DiscoveredSubscription) subs_to_remove_from_bit;
 
@@ -2005,6 +2074,7 @@ Sedp::update_publication_qos(const GUID_t& publicationId,
     String topic_name = topic_names_[pb.topic_id_];
     TopicDetailsMap::iterator top_it = topics_.find(topic_name);
     if (top_it != topics_.end()) {
+      top_it->second.set_publication_partitions(publicationId, publisherQos.partition);
       match_endpoints(publicationId, top_it->second);
     }
     return true;
@@ -2057,6 +2127,7 @@ Sedp::update_subscription_qos(const GUID_t& subscriptionId,
     String topic_name = topic_names_[sb.topic_id_];
     TopicDetailsMap::iterator top_it = topics_.find(topic_name);
     if (top_it != topics_.end()) {
+      top_it->second.set_subscription_partitions(subscriptionId, subscriberQos.partition);
       match_endpoints(subscriptionId, top_it->second);
     }
     return true;
@@ -2102,6 +2173,8 @@ Sedp::shutdown()
 {
   publications_reader_->shutting_down();
   subscriptions_reader_->shutting_down();
+  publications_reader_->stop_decoding();
+  subscriptions_reader_->stop_decoding();
   participant_message_reader_->shutting_down();
   type_lookup_request_reader_->shutting_down();
   type_lookup_reply_reader_->shutting_down();
@@ -2115,6 +2188,9 @@ Sedp::shutdown()
   type_lookup_request_secure_reader_->shutting_down();
   type_lookup_reply_secure_reader_->shutting_down();
 #endif
+  if (decode_dispatcher_) {
+    decode_dispatcher_->shutdown(true);
+  }
   publications_writer_->shutting_down();
   subscriptions_writer_->shutting_down();
   participant_message_writer_->shutting_down();
@@ -2312,6 +2388,7 @@ void Sedp::process_discovered_writer_data(DCPS::MessageId message_id,
 
       // Upsert the remote topic.
       td.add_discovered_publication(guid);
+      td.set_publication_partitions(guid, pub.writer_data_.ddsPublicationData.partition);
 
       assign_bit_key(pub);
       wdata_copy = pub.writer_data_;
@@ -2346,6 +2423,7 @@ void Sedp::process_discovered_writer_data(DCPS::MessageId message_id,
             log_progress("discovered writer data update", participant_id_, participant_id,
                          spdp_.get_participant_discovered_at(participant_id), guid);
           }
+          top_it->second.set_publication_partitions(guid, iter->second.writer_data_.ddsPublicationData.partition);
           match_endpoints(guid, top_it->second);
           iter = discovered_publications_.find(guid);
           if (iter == discovered_publications_.end()) {
@@ -2614,6 +2692,7 @@ void Sedp::process_discovered_reader_data(DCPS::MessageId message_id,
 
       // Upsert the remote topic.
       td.add_discovered_subscription(guid);
+      td.set_subscription_partitions(guid, sub.reader_data_.ddsSubscriptionData.partition);
 
       assign_bit_key(sub);
       rdata_copy = sub.reader_data_;
@@ -2648,6 +2727,7 @@ void Sedp::process_discovered_reader_data(DCPS::MessageId message_id,
             log_progress("discovered reader data update", participant_id_, participant_id,
                          spdp_.get_participant_discovered_at(participant_id), guid);
           }
+          top_it->second.set_subscription_partitions(guid, iter->second.reader_data_.ddsSubscriptionData.partition);
           match_endpoints(guid, top_it->second);
           iter = discovered_subscriptions_.find(guid);
           if (iter == discovered_subscriptions_.end()) {
@@ -4220,6 +4300,11 @@ Sedp::Reader::~Reader()
 {
 }
 
+Sedp::DiscoveryReader::DiscoveryReader(const DCPS::GUID_t& sub_id, Sedp& sedp)
+  : Reader(sub_id, sedp)
+{
+}
+
 Sedp::DiscoveryReader::~DiscoveryReader()
 {
 }
@@ -4258,6 +4343,35 @@ static bool decode_parameter_list(
   return true;
 }
 
+// Get Encoding from Encapsulation
+static bool read_encapsulation(
+  const DCPS::ReceivedDataSample& sample,
+  Serializer& ser,
+  DCPS::Extensibility extensibility,
+  const GUID_t& reader)
+{
+  Encoding encoding;
+  DCPS::EncapsulationHeader encap;
+  if (!(ser >> encap)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::Reader::data_received: "
+                 "failed to deserialize encapsulation header\n"));
+    }
+    return false;
+  }
+  if (!to_encoding(encoding, encap, extensibility)) {
+    if (log_level >= DCPS::LogLevel::Error) {
+      ACE_ERROR((LM_ERROR,
+                 "(%P|%t) ERROR: Sedp::Reader::data_received: "
+                 "to_encoding failed writer %C reader %C\n",
+                 LogGuid(sample.header_.publication_id_).c_str(), LogGuid(reader).c_str()));
+    }
+    return false;
+  }
+  ser.encoding(encoding);
+  return true;
+}
+
 void
 Sedp::Reader::data_received(const DCPS::ReceivedDataSample& sample)
 {
@@ -4318,28 +4432,11 @@ Sedp::Reader::data_received(const DCPS::ReceivedDataSample& sample)
     const DCPS::Extensibility extensibility =
       is_mutable ? DCPS::MUTABLE : DCPS::FINAL;
 
-    // Get Encoding from Encapsulation
-    Encoding encoding;
     DCPS::Message_Block_Ptr payload(sample.data(&mb_alloc_));
-    Serializer ser(payload.get(), encoding);
-    DCPS::EncapsulationHeader encap;
-    if (!(ser >> encap)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::Reader::data_received: "
-                   "failed to deserialize encapsulation header\n"));
-      }
-      return;
-    }
-    if (!to_encoding(encoding, encap, extensibility)) {
-      if (log_level >= DCPS::LogLevel::Error) {
-        ACE_ERROR((LM_ERROR,
-                   "(%P|%t) ERROR: Sedp::Reader::data_received: "
-                   "to_encoding failed writer %C reader %C\n",
-                   LogGuid(sample.header_.publication_id_).c_str(), LogGuid(repo_id_).c_str()));
-      }
+    Serializer ser(payload.get(), Encoding());
+    if (!read_encapsulation(sample, ser, extensibility, repo_id_)) {
       return;
     }
-    ser.encoding(encoding);
 
     data_received_i(sample, entity_id, ser, extensibility);
     break;
@@ -4423,13 +4520,135 @@ Sedp::SecurityReader::data_received_i(const DCPS::ReceivedDataSample& sample,
 #endif
 }
 
+class Sedp::DiscoveryReader::DecodeEvent : public DCPS::EventBase {
+public:
+  DecodeEvent(const DiscoveryReader_rch& reader,
+              const DCPS::ReceivedDataSample& sample,
+              ACE_UINT64 index)
+    : reader_(reader)
+    , bytes_(sample.copy_data())
+    , index_(index)
+    , id_(static_cast<DCPS::MessageId>(sample.header_.message_id_))
+  {
+    // Copy the payload so the decode thread doesn't share the transport's
+    // buffers.
+    sample_.header_ = sample.header_;
+    sample_.replace(reinterpret_cast<const char*>(bytes_.get_buffer()), bytes_.length());
+  }
+
+  void handle_event()
+  {
+    const DiscoveryReader_rch reader = reader_.lock();
+    if (!reader) {
+      return;
+    }
+
+    if (!reader->shutting_down_) {
+      decode(*reader);
+    }
+    Commit commit(reader->sedp_);
+    reader->decode_order_.complete(index_, DCPS::rchandle_from(this), commit);
+  }
+
+  void commit(Sedp& sedp) const
+  {
+    if (wdata_) {
+      sedp.data_received(id_, *wdata_);
+    } else if (rdata_) {
+      sedp.data_received(id_, *rdata_);
+    }
+  }
+
+private:
+  void decode(DiscoveryReader& reader)
+  {
+    DCPS::Message_Block_Ptr payload(sample_.data());
+    Serializer ser(payload.get(), Encoding());
+    // Publications and subscriptions are both mutable.
+    if (!read_encapsulation(sample_, ser, DCPS::MUTABLE, reader.repo_id_)) {
+      return;
+    }
+    // Only one of them is allocated and it's never copied.
+    if (sample_.header_.publication_id_.entityId == ENTITYID_SEDP_BUILTIN_PUBLICATIONS_WRITER) {
+      DCPS::unique_ptr<DiscoveredPublication> wdata(new DiscoveredPublication);
+      if (reader.decode_publication(sample_, ser, DCPS::MUTABLE, *wdata)) {
+        wdata_ = DCPS::move(wdata);
+      }
+    } else {
+      DCPS::unique_ptr<DiscoveredSubscription> rdata(new DiscoveredSubscription);
+      if (reader.decode_subscription(sample_, ser, DCPS::MUTABLE, *rdata)) {
+        rdata_ = DCPS::move(rdata);
+      }
+    }
+  }
+
+  DCPS::WeakRcHandle<DiscoveryReader> reader_;
+  const DDS::OctetSeq bytes_;
+  DCPS::ReceivedDataSample sample_;
+  const ACE_UINT64 index_;
+  const DCPS::MessageId id_;
+  DCPS::unique_ptr<DiscoveredPublication> wdata_;
+  DCPS::unique_ptr<DiscoveredSubscription> rdata_;
+};
+
+class Sedp::DiscoveryReader::Commit {
+public:
+  explicit Commit(Sedp& sedp)
+    : sedp_(sedp)
+  {}
+
+  void operator()(const DecodeEvent_rch& event) const
+  {
+    if (event) {
+      event->commit(sedp_);
+    }
+  }
+
+private:
+  Sedp& sedp_;
+};
+
 void
-Sedp::DiscoveryReader::data_received_i(const DCPS::ReceivedDataSample& sample,
-  const DCPS::EntityId_t& entity_id,
-  DCPS::Serializer& ser,
-  DCPS::Extensibility extensibility)
+Sedp::DiscoveryReader::data_received(const DCPS::ReceivedDataSample& sample)
 {
+  const DCPS::EventDispatcher_rch dispatcher = sedp_.decode_dispatcher_;
+  const DCPS::EntityId_t& entity_id = sample.header_.publication_id_.entityId;
   const DCPS::MessageId id = static_cast<DCPS::MessageId>(sample.header_.message_id_);
+  if (!dispatcher || shutting_down_ ||
+      (entity_id != ENTITYID_SEDP_BUILTIN_PUBLICATIONS_WRITER &&
+       entity_id != ENTITYID_SEDP_BUILTIN_SUBSCRIPTIONS_WRITER) ||
+      (id != DCPS::SAMPLE_DATA && id != DCPS::DISPOSE_INSTANCE &&
+       id != DCPS::UNREGISTER_INSTANCE && id != DCPS::DISPOSE_UNREGISTER_INSTANCE)) {
+    Reader::data_received(sample);
+    return;
+  }
+
+  const ACE_UINT64 index = decode_order_.start(DCPS::make_part_guid(sample.header_.publication_id_));
+  if (!dispatcher->dispatch(DCPS::make_rch<DecodeEvent>(DCPS::rchandle_from(this), sample, index))) {
+    // Don't hold up the samples after this one.
+    Commit commit(sedp_);
+    decode_order_.complete(index, DecodeEvent_rch(), commit);
+  }
+}
+
+void
+Sedp::DiscoveryReader::drop_decoding(const DCPS::GUID_t& participant)
+{
+  decode_order_.drop(participant);
+}
+
+void
+Sedp::DiscoveryReader::stop_decoding()
+{
+  decode_order_.shutdown();
+}
+
+bool
+Sedp::DiscoveryReader::decode_publication(const DCPS::ReceivedDataSample& sample,
+  DCPS::Serializer& ser,
+  DCPS::Extensibility extensibility,
+  DiscoveredPublication& wdata)
+{
   VendorId_t remote_vendor_id;
   bool remote_uses_rtps_duration_fraction = false;
   sedp_.spdp_.get_vendor_id_and_duration_encoding(
@@ -4437,55 +4656,146 @@ Sedp::DiscoveryReader::data_received_i(const DCPS::ReceivedDataSample& sample,
   const ParameterListConverter::RtpsDurationEncoding remote_duration_encoding =
     duration_encoding(remote_uses_rtps_duration_fraction);
 
-  if (entity_id == ENTITYID_SEDP_BUILTIN_PUBLICATIONS_WRITER) {
-    ParameterList data;
-    if (!decode_parameter_list(sample, ser, extensibility, data)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to deserialize data\n"));
-      }
-      return;
+  ParameterList data;
+  if (!decode_parameter_list(sample, ser, extensibility, data)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_publication: "
+                 "failed to deserialize data\n"));
     }
+    return false;
+  }
 
-    DiscoveredPublication wdata;
-    if (!ParameterListConverter::from_param_list(
-          data, remote_vendor_id,
-          wdata.writer_data_, sedp_.use_xtypes_, wdata.type_info_,
-          remote_duration_encoding)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to convert from ParameterList to DiscoveredWriterData\n"));
-      }
-      return;
+  if (!ParameterListConverter::from_param_list(
+        data, remote_vendor_id,
+        wdata.writer_data_, sedp_.use_xtypes_, wdata.type_info_,
+        remote_duration_encoding)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_publication: "
+                 "failed to convert from ParameterList to DiscoveredWriterData\n"));
     }
+    return false;
+  }
 #if OPENDDS_CONFIG_SECURITY
-    wdata.have_ice_agent_info_ = false;
-    ICE::AgentInfoMap ai_map;
-    if (!ParameterListConverter::from_param_list(data, ai_map)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to convert from ParameterList to ICE Agent info\n"));
-      }
-      return;
+  wdata.have_ice_agent_info_ = false;
+  ICE::AgentInfoMap ai_map;
+  if (!ParameterListConverter::from_param_list(data, ai_map)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_publication: "
+                 "failed to convert from ParameterList to ICE Agent info\n"));
     }
-    const ICE::AgentInfoMap::const_iterator pos = ai_map.find("DATA");
-    if (pos != ai_map.end()) {
-      wdata.have_ice_agent_info_ = true;
-      wdata.ice_agent_info_ = pos->second;
+    return false;
+  }
+  const ICE::AgentInfoMap::const_iterator pos = ai_map.find("DATA");
+  if (pos != ai_map.end()) {
+    wdata.have_ice_agent_info_ = true;
+    wdata.ice_agent_info_ = pos->second;
+  }
+#endif
+
+  if (wdata.type_info_.minimal.typeid_with_size.type_id.kind() != XTypes::TK_NONE ||
+      wdata.type_info_.complete.typeid_with_size.type_id.kind() != XTypes::TK_NONE) {
+    const GUID_t& remote_guid = wdata.writer_data_.writerProxy.remoteWriterGuid;
+    const DDS::BuiltinTopicKey_t key = DCPS::guid_to_bit_key(remote_guid);
+    sedp_.type_lookup_service_->cache_type_info(key, wdata.type_info_);
+  }
+
+  return true;
+}
+
+bool
+Sedp::DiscoveryReader::decode_subscription(const DCPS::ReceivedDataSample& sample,
+  DCPS::Serializer& ser,
+  DCPS::Extensibility extensibility,
+  DiscoveredSubscription& rdata)
+{
+  VendorId_t remote_vendor_id;
+  bool remote_uses_rtps_duration_fraction = false;
+  sedp_.spdp_.get_vendor_id_and_duration_encoding(
+    sample.header_.publication_id_, remote_vendor_id, remote_uses_rtps_duration_fraction);
+  const ParameterListConverter::RtpsDurationEncoding remote_duration_encoding =
+    duration_encoding(remote_uses_rtps_duration_fraction);
+
+  ParameterList data;
+  if (!decode_parameter_list(sample, ser, extensibility, data)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_subscription: "
+                 "failed to deserialize SUBSCRIPTIONS_WRITER data\n"));
+    }
+    return false;
+  }
+
+  if (!ParameterListConverter::from_param_list(
+        data, remote_vendor_id,
+        rdata.reader_data_, sedp_.use_xtypes_, rdata.type_info_,
+        remote_duration_encoding)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_subscription: "
+                 "failed to convert from ParameterList to DiscoveredReaderData\n"));
     }
+    return false;
+  }
+#if OPENDDS_CONFIG_SECURITY
+  rdata.have_ice_agent_info_ = false;
+  ICE::AgentInfoMap ai_map;
+  if (!ParameterListConverter::from_param_list(data, ai_map)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::decode_subscription: "
+                 "failed to convert from ParameterList to ICE Agent info\n"));
+    }
+    return false;
+  }
+  const ICE::AgentInfoMap::const_iterator pos = ai_map.find("DATA");
+  if (pos != ai_map.end()) {
+    rdata.have_ice_agent_info_ = true;
+    rdata.ice_agent_info_ = pos->second;
+  }
 #endif
+  if (rdata.reader_data_.readerProxy.expectsInlineQos) {
+    set_inline_qos(rdata.reader_data_.readerProxy.allLocators);
+  }
 
-    if (wdata.type_info_.minimal.typeid_with_size.type_id.kind() != XTypes::TK_NONE ||
-        wdata.type_info_.complete.typeid_with_size.type_id.kind() != XTypes::TK_NONE) {
-      const GUID_t& remote_guid = wdata.writer_data_.writerProxy.remoteWriterGuid;
-      const DDS::BuiltinTopicKey_t key = DCPS::guid_to_bit_key(remote_guid);
-      sedp_.type_lookup_service_->cache_type_info(key, wdata.type_info_);
+  if (rdata.type_info_.minimal.typeid_with_size.type_id.kind() != XTypes::TK_NONE ||
+      rdata.type_info_.complete.typeid_with_size.type_id.kind() != XTypes::TK_NONE) {
+    const GUID_t& remote_guid = rdata.reader_data_.readerProxy.remoteReaderGuid;
+    const DDS::BuiltinTopicKey_t key = DCPS::guid_to_bit_key(remote_guid);
+    sedp_.type_lookup_service_->cache_type_info(key, rdata.type_info_);
+  }
+
+  return true;
+}
+
+void
+Sedp::DiscoveryReader::data_received_i(const DCPS::ReceivedDataSample& sample,
+  const DCPS::EntityId_t& entity_id,
+  DCPS::Serializer& ser,
+  DCPS::Extensibility extensibility)
+{
+  const DCPS::MessageId id = static_cast<DCPS::MessageId>(sample.header_.message_id_);
+  if (entity_id == ENTITYID_SEDP_BUILTIN_PUBLICATIONS_WRITER) {
+    DiscoveredPublication wdata;
+    if (decode_publication(sample, ser, extensibility, wdata)) {
+      sedp_.data_received(id, wdata);
     }
+    return;
+  }
 
-    sedp_.data_received(id, wdata);
+  if (entity_id == ENTITYID_SEDP_BUILTIN_SUBSCRIPTIONS_WRITER) {
+    DiscoveredSubscription rdata;
+    if (decode_subscription(sample, ser, extensibility, rdata)) {
+      sedp_.data_received(id, rdata);
+    }
+    return;
+  }
 
 #if OPENDDS_CONFIG_SECURITY
-  } else if (entity_id == ENTITYID_SEDP_BUILTIN_PUBLICATIONS_SECURE_WRITER) {
+  VendorId_t remote_vendor_id;
+  bool remote_uses_rtps_duration_fraction = false;
+  sedp_.spdp_.get_vendor_id_and_duration_encoding(
+    sample.header_.publication_id_, remote_vendor_id, remote_uses_rtps_duration_fraction);
+  const ParameterListConverter::RtpsDurationEncoding remote_duration_encoding =
+    duration_encoding(remote_uses_rtps_duration_fraction);
+
+  if (entity_id == ENTITYID_SEDP_BUILTIN_PUBLICATIONS_SECURE_WRITER) {
     ParameterList data;
     if (!decode_parameter_list(sample, ser, extensibility, data)) {
       if (log_level >= LogLevel::Warning) {
@@ -4531,58 +4841,6 @@ Sedp::DiscoveryReader::data_received_i(const DCPS::ReceivedDataSample& sample,
     }
 
     sedp_.data_received(id, wdata_secure);
-#endif
-  } else if (entity_id == ENTITYID_SEDP_BUILTIN_SUBSCRIPTIONS_WRITER) {
-    ParameterList data;
-    if (!decode_parameter_list(sample, ser, extensibility, data)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to deserialize SUBSCRIPTIONS_WRITER data\n"));
-      }
-      return;
-    }
-
-    DiscoveredSubscription rdata;
-    if (!ParameterListConverter::from_param_list(
-          data, remote_vendor_id,
-          rdata.reader_data_, sedp_.use_xtypes_, rdata.type_info_,
-          remote_duration_encoding)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to convert from ParameterList to DiscoveredReaderData\n"));
-      }
-      return;
-    }
-#if OPENDDS_CONFIG_SECURITY
-    rdata.have_ice_agent_info_ = false;
-    ICE::AgentInfoMap ai_map;
-    if (!ParameterListConverter::from_param_list(data, ai_map)) {
-      if (log_level >= LogLevel::Warning) {
-        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: Sedp::DiscoveryReader::data_received_i: "
-                   "failed to convert from ParameterList to ICE Agent info\n"));
-      }
-      return;
-    }
-    const ICE::AgentInfoMap::const_iterator pos = ai_map.find("DATA");
-    if (pos != ai_map.end()) {
-      rdata.have_ice_agent_info_ = true;
-      rdata.ice_agent_info_ = pos->second;
-    }
-#endif
-    if (rdata.reader_data_.readerProxy.expectsInlineQos) {
-      set_inline_qos(rdata.reader_data_.readerProxy.allLocators);
-    }
-
-    if (rdata.type_info_.minimal.typeid_with_size.type_id.kind() != XTypes::TK_NONE ||
-        rdata.type_info_.complete.typeid_with_size.type_id.kind() != XTypes::TK_NONE) {
-      const GUID_t& remote_guid = rdata.reader_data_.readerProxy.remoteReaderGuid;
-      const DDS::BuiltinTopicKey_t key = DCPS::guid_to_bit_key(remote_guid);
-      sedp_.type_lookup_service_->cache_type_info(key, rdata.type_info_);
-    }
-
-    sedp_.data_received(id, rdata);
-
-#if OPENDDS_CONFIG_SECURITY
   } else if (entity_id == ENTITYID_SEDP_BUILTIN_SUBSCRIPTIONS_SECURE_WRITER) {
     ParameterList data;
     if (!decode_parameter_list(sample, ser, extensibility, data)) {
@@ -4657,9 +4915,8 @@ Sedp::DiscoveryReader::data_received_i(const DCPS::ReceivedDataSample& sample,
     const GUID_t guid = make_part_guid(sample.header_.publication_id_);
     sedp_.spdp_.process_participant_ice(data, pdata, guid);
     sedp_.spdp_.handle_participant_data(id, pdata, DCPS::MonotonicTimePoint::now(), DCPS::SequenceNumber::ZERO(), DCPS::NetworkAddress(), true);
-
-#endif
   }
+#endif
 }
 
 void
@@ -6514,6 +6771,7 @@ bool Sedp::add_publication(
 
   DCPS::TopicDetails& td = topics_[topic_name];
   td.add_local_publication(rid);
+  td.set_publication_partitions(rid, publisherQos.partition);
 
   if (DDS::RETCODE_OK != add_publication_i(rid, pb)) {
     return false;
@@ -6670,6 +6928,7 @@ bool Sedp::add_subscription(
 
   DCPS::TopicDetails& td = topics_[topic_name];
   td.add_local_subscription(rid);
+  td.set_subscription_partitions(rid, subscriberQos.partition);
 
   if (DDS::RETCODE_OK != add_subscription_i(rid, sb)) {
     return false;
@@ -7086,6 +7345,29 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
   }
 
   const bool reader = DCPS::GuidConverter(repoId).isReader();
+  const bool is_remote = !equal_guid_prefixes(repoId, participant_id_);
+
+  if (is_remote && (reader ? td.local_publications() : td.local_subscriptions()).empty()) {
+    // Nothing to match.
+    return;
+  }
+
+  // Only the endpoints in a matching partition are visited. The others can't
+  // be matched, and the QoS they're incompatible with is reported once a
+  // partition change makes them candidates.
+  RepoIdSet candidates;
+  if (!remove && endpoints_in_partitions(repoId, reader, is_remote, td, candidates)) {
+    for (RepoIdSet::const_iterator iter = candidates.begin();
+         iter != candidates.end(); ++iter) {
+      // Remote/remote matches are a waste of time
+      if (is_remote && !equal_guid_prefixes(*iter, participant_id_)) {
+        continue;
+      }
+      match(reader ? *iter : repoId, reader ? repoId : *iter);
+    }
+    return;
+  }
+
   // Copy the endpoint set - lock can be released in match()
   RepoIdSet local_endpoints;
   RepoIdSet discovered_endpoints;
@@ -7097,12 +7379,6 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
     discovered_endpoints = td.discovered_subscriptions();
   }
 
-  const bool is_remote = !equal_guid_prefixes(repoId, participant_id_);
-  if (is_remote && local_endpoints.empty()) {
-    // Nothing to match.
-    return;
-  }
-
   for (RepoIdSet::const_iterator iter = local_endpoints.begin();
        iter != local_endpoints.end(); ++iter) {
     // check to make sure it's a Reader/Writer or Writer/Reader match
@@ -7133,6 +7409,52 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
   }
 }
 
+bool Sedp::endpoints_in_partitions(const GUID_t& repoId, bool reader, bool is_remote,
+                                   const DCPS::TopicDetails& td, RepoIdSet& result) const
+{
+  const DDS::PartitionQosPolicy* partition = 0;
+  const RepoIdSet* matched = 0;
+  if (reader) {
+    if (is_remote) {
+      const DiscoveredSubscriptionMap::const_iterator pos = discovered_subscriptions_.find(repoId);
+      if (pos != discovered_subscriptions_.end()) {
+        partition = &pos->second.reader_data_.ddsSubscriptionData.partition;
+        matched = &pos->second.matched_endpoints_;
+      }
+    } else {
+      const LocalSubscriptionCIter pos = local_subscriptions_.find(repoId);
+      if (pos != local_subscriptions_.end()) {
+        partition = &pos->second.subscriber_qos_.partition;
+        matched = &pos->second.matched_endpoints_;
+      }
+    }
+  } else {
+    if (is_remote) {
+      const DiscoveredPublicationMap::const_iterator pos = discovered_publications_.find(repoId);
+      if (pos != discovered_publications_.end()) {
+        partition = &pos->second.writer_data_.ddsPublicationData.partition;
+        matched = &pos->second.matched_endpoints_;
+      }
+    } else {
+      const LocalPublicationCIter pos = local_publications_.find(repoId);
+      if (pos != local_publications_.end()) {
+        partition = &pos->second.publisher_qos_.partition;
+        matched = &pos->second.matched_endpoints_;
+      }
+    }
+  }
+
+  if (!partition ||
+      !(reader ? td.publications_in_partitions(*partition, result) : td.subscriptions_in_partitions(*partition, result))) {
+    return false;
+  }
+
+  // The partitions might have changed, so also visit the endpoints that are
+  // matched now so they can be unmatched.
+  result.insert(matched->begin(), matched->end());
+  return true;
+}
+
 void Sedp::cleanup_writer_association(DCPS::DataWriterCallbacks_wrch callbacks,
                                       const GUID_t& writer,
                                       const GUID_t& reader)
@@ -7543,34 +7865,8 @@ void Sedp::match_continue(UsedEndpoints& ue,
     topic_name = dpi->second.get_topic_name();
     writer_participant_discovered_at = dpi->second.participant_discovered_at_;
 
-    const DDS::PublicationBuiltinTopicData& bit =
-      dpi->second.writer_data_.ddsPublicationData;
-    tempDwQos.durability = bit.durability;
-    tempDwQos.durability_service = bit.durability_service;
-    tempDwQos.deadline = bit.deadline;
-    tempDwQos.latency_budget = bit.latency_budget;
-    tempDwQos.liveliness = bit.liveliness;
-    tempDwQos.reliability = bit.reliability;
-    tempDwQos.destination_order = bit.destination_order;
-    tempDwQos.history = TheServiceParticipant->initial_HistoryQosPolicy();
-    tempDwQos.resource_limits =
-      TheServiceParticipant->initial_ResourceLimitsQosPolicy();
-    tempDwQos.transport_priority =
-      TheServiceParticipant->initial_TransportPriorityQosPolicy();
-    tempDwQos.lifespan = bit.lifespan;
-    tempDwQos.user_data = bit.user_data;
-    tempDwQos.ownership = bit.ownership;
-    tempDwQos.ownership_strength = bit.ownership_strength;
-    tempDwQos.writer_data_lifecycle =
-      TheServiceParticipant->initial_WriterDataLifecycleQosPolicy();
-    tempDwQos.representation = bit.representation;
+    discovered_qos(dpi->second.writer_data_.ddsPublicationData, tempDwQos, tempPubQos);
     dwQos = &tempDwQos;
-
-    tempPubQos.presentation = bit.presentation;
-    tempPubQos.partition = bit.partition;
-    tempPubQos.group_data = bit.group_data;
-    tempPubQos.entity_factory =
-      TheServiceParticipant->initial_EntityFactoryQosPolicy();
     pubQos = &tempPubQos;
 
     populate_transport_locator_sequence(*wTls, dpi, writer);
@@ -7626,31 +7922,8 @@ void Sedp::match_continue(UsedEndpoints& ue,
     populate_transport_locator_sequence(*rTls, dsi, reader);
     rTransportContext = dsi->second.transport_context_;
 
-    const DDS::SubscriptionBuiltinTopicData& bit =
-      dsi->second.reader_data_.ddsSubscriptionData;
-    tempDrQos.durability = bit.durability;
-    tempDrQos.deadline = bit.deadline;
-    tempDrQos.latency_budget = bit.latency_budget;
-    tempDrQos.liveliness = bit.liveliness;
-    tempDrQos.reliability = bit.reliability;
-    tempDrQos.destination_order = bit.destination_order;
-    tempDrQos.history = TheServiceParticipant->initial_HistoryQosPolicy();
-    tempDrQos.resource_limits =
-      TheServiceParticipant->initial_ResourceLimitsQosPolicy();
-    tempDrQos.user_data = bit.user_data;
-    tempDrQos.ownership = bit.ownership;
-    tempDrQos.time_based_filter = bit.time_based_filter;
-    tempDrQos.reader_data_lifecycle =
-      TheServiceParticipant->initial_ReaderDataLifecycleQosPolicy();
-    tempDrQos.representation = bit.representation;
-    tempDrQos.type_consistency = bit.type_consistency;
+    discovered_qos(dsi->second.reader_data_.ddsSubscriptionData, tempDrQos, tempSubQos);
     drQos = &tempDrQos;
-
-    tempSubQos.presentation = bit.presentation;
-    tempSubQos.partition = bit.partition;
-    tempSubQos.group_data = bit.group_data;
-    tempSubQos.entity_factory =
-      TheServiceParticipant->initial_EntityFactoryQosPolicy();
     subQos = &tempSubQos;
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
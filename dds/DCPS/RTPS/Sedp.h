@@ -14,6 +14,7 @@
 #include "MessageTypes.h"
 #include "MessageUtils.h"
 #include "ParameterListConverter.h"
+#include "ReorderBuffer.h"
 #include "TypeLookupTypeSupportImpl.h"
 #include "RtpsRpcTypeSupportImpl.h"
 #include "RtpsCoreTypeSupportImpl.h"
@@ -894,17 +895,46 @@ private:
 
   class DiscoveryReader : public Reader {
   public:
-    DiscoveryReader(const DCPS::GUID_t& sub_id, Sedp& sedp)
-      : Reader(sub_id, sedp)
-    {}
+    DiscoveryReader(const DCPS::GUID_t& sub_id, Sedp& sedp);
 
     virtual ~DiscoveryReader();
 
+    /// If Sedp has decode threads, publications and subscriptions are decoded
+    /// on them and then passed to Sedp in the order they were received.
+    void data_received(const DCPS::ReceivedDataSample& sample);
+
+    /// Samples from participant that are still being decoded are dropped.
+    void drop_decoding(const DCPS::GUID_t& participant);
+
+    /// Samples that are still being decoded are dropped.
+    void stop_decoding();
+
   private:
     virtual void data_received_i(const DCPS::ReceivedDataSample& sample,
       const DCPS::EntityId_t& entity_id,
       DCPS::Serializer& ser,
       DCPS::Extensibility extensibility);
+
+    bool decode_publication(const DCPS::ReceivedDataSample& sample,
+                            DCPS::Serializer& ser,
+                            DCPS::Extensibility extensibility,
+                            DiscoveredPublication& wdata);
+    bool decode_subscription(const DCPS::ReceivedDataSample& sample,
+                             DCPS::Serializer& ser,
+                             DCPS::Extensibility extensibility,
+                             DiscoveredSubscription& rdata);
+
+    /// Decodes a sample on a decode thread and holds the result until it's
+    /// passed to Sedp.
+    class DecodeEvent;
+    typedef DCPS::RcHandle<DecodeEvent> DecodeEvent_rch;
+    class Commit;
+
+    /// Passes decoded samples to Sedp in the order they were received.
+    /// Samples of a participant that SPDP removes are dropped, so they can't
+    /// be applied after it's discovered again.
+    typedef ReorderBuffer<DecodeEvent_rch, DCPS::GUID_t, DCPS::GUID_tKeyLessThan> DecodeOrder;
+    DecodeOrder decode_order_;
   };
 
   typedef DCPS::RcHandle<DiscoveryReader> DiscoveryReader_rch;
@@ -1029,6 +1059,8 @@ private:
   DCPS::ReactorTask_rch reactor_task_;
   DCPS::JobQueue_rch job_queue_;
   DCPS::EventDispatcher_rch event_dispatcher_;
+  /// Decodes publications and subscriptions if SedpDecodeThreads is set.
+  DCPS::EventDispatcher_rch decode_dispatcher_;
 
   void populate_discovered_writer_msg(
       DCPS::DiscoveredWriterData& dwd,
@@ -1324,6 +1356,12 @@ protected:
   void match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td,
                        bool remove = false);
 
+  /// Add to result the endpoints of td that could match repoId based on
+  /// its partitions, along with the ones it's matched with now. Returns false
+  /// if the partition index can't narrow the search.
+  bool endpoints_in_partitions(const GUID_t& repoId, bool reader, bool is_remote,
+                               const DCPS::TopicDetails& td, RepoIdSet& result) const;
+
   void remove_assoc(const GUID_t& remove_from, const GUID_t& removing);
 
   struct MatchingData {
@@ -282,6 +282,8 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , total_writer_associated_(0)
   , total_reader_pending_(0)
   , total_reader_associated_(0)
+  , announcement_cache_hits_(0)
+  , announcement_cache_misses_(0)
 {
   ACE_GUARD(ACE_Thread_Mutex, g, lock_);
 
@@ -354,6 +356,8 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , total_writer_associated_(0)
   , total_reader_pending_(0)
   , total_reader_associated_(0)
+  , announcement_cache_hits_(0)
+  , announcement_cache_misses_(0)
 {
   ACE_GUARD(ACE_Thread_Mutex, g, lock_);
 
@@ -1113,10 +1117,81 @@ Spdp::validateSequenceNumber(const DCPS::MonotonicTimePoint& now, const DCPS::Se
   return true;
 }
 
+bool
+Spdp::announcement_unchanged(const DataSubmessage& data,
+                             const DCPS::GuidPrefix_t& prefix,
+                             const char* payload,
+                             size_t payload_length,
+                             ACE_CDR::ULong user_tag,
+                             const DCPS::NetworkAddress& from)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, lock_, false);
+  if (!initialized_flag_ || shutdown_flag_) {
+    return false;
+  }
+
+  const GUID_t guid = DCPS::make_part_guid(prefix);
+  DiscoveredParticipantIter iter = participants_.find(guid);
+  const DCPS::SequenceNumber seq = to_opendds_seqnum(data.writerSN);
+  const bool from_relay = sedp_->core().from_relay(from);
+
+  // Anything that handle_participant_data does more for than refresh the
+  // lease goes through data_received: security, disposes, sequence number
+  // resets, the RtpsRelay application participant, and IP addresses that
+  // aren't in the participant's locators.
+  bool unchanged = iter != participants_.end() &&
+#if OPENDDS_CONFIG_SECURITY
+    !is_security_enabled() &&
+#endif
+    payload_length != 0 &&
+    iter->second.last_announcement_.size() == payload_length &&
+    iter->second.last_announcement_user_tag_ == user_tag &&
+    std::memcmp(&iter->second.last_announcement_[0], payload, payload_length) == 0 &&
+    !(data.inlineQos.length() && disposed(data.inlineQos)) &&
+    !sedp_->ignoring(guid) &&
+    !iter->second.pdata_.participantProxy.opendds_rtps_relay_application_participant &&
+    (seq.getValue() == 0 || iter->second.max_seq_ == DCPS::SequenceNumber::MAX_VALUE || !(seq < iter->second.max_seq_));
+
+#ifndef OPENDDS_SAFETY_PROFILE
+  if (unchanged && check_source_ip_ && !from_relay &&
+      !ip_in_locator_list(from, iter->second.pdata_.participantProxy.metatrafficUnicastLocatorList)) {
+    unchanged = false;
+  }
+#endif
+
+  if (!unchanged) {
+    ++announcement_cache_misses_;
+    return false;
+  }
+  ++announcement_cache_hits_;
+
+  // Not calling process_participant_ice is safe. The cached announcement was
+  // applied by data_received while the participant was already known, so its
+  // ICE agent info was stored and passed to start_ice or stop_ice then. The
+  // same bytes carry the same agent info, and start_ice with unchanged info
+  // doesn't do anything.
+  const MonotonicTimePoint now = MonotonicTimePoint::now();
+#ifndef DDS_HAS_MINIMUM_BIT
+  enqueue_location_update_i(iter, compute_location_mask(from, from_relay), from, "unchanged participant");
+#endif
+  validateSequenceNumber(now, seq, iter);
+  update_lease_expiration_i(iter, now);
+  if (!from_relay && from) {
+    iter->second.last_recv_address_ = from;
+  }
+#ifndef DDS_HAS_MINIMUM_BIT
+  process_location_updates_i(iter, "unchanged SPDP");
+#endif
+  return true;
+}
+
 void
 Spdp::data_received(const DataSubmessage& data,
                     const ParameterList& plist,
-                    const DCPS::NetworkAddress& from)
+                    const DCPS::NetworkAddress& from,
+                    const char* payload,
+                    size_t payload_length,
+                    ACE_CDR::ULong user_tag)
 {
   ACE_Guard<ACE_Thread_Mutex> guard(lock_);
   if (!initialized_flag_ || shutdown_flag_) {
@@ -1154,6 +1229,10 @@ Spdp::data_received(const DataSubmessage& data,
 
   const DCPS::MessageId msg_id = (data.inlineQos.length() && disposed(data.inlineQos)) ? DCPS::DISPOSE_INSTANCE : DCPS::SAMPLE_DATA;
 
+  // The announcement that discovers a participant isn't cached since some
+  // of it (the ICE info) is only stored when the participant is known.
+  const bool cache_announcement = payload && participants_.count(guid);
+
 #if OPENDDS_CONFIG_SECURITY
   const bool from_relay = sedp_->core().from_relay(from);
 
@@ -1184,7 +1263,19 @@ Spdp::data_received(const DataSubmessage& data,
   guard.release();
 #endif
 
-  handle_participant_data(msg_id, pdata, now, to_opendds_seqnum(data.writerSN), from, false);
+  const DCPS::SequenceNumber seq = to_opendds_seqnum(data.writerSN);
+  handle_participant_data(msg_id, pdata, now, seq, from, false);
+
+  if (cache_announcement) {
+    ACE_GUARD(ACE_Thread_Mutex, g, lock_);
+    const DiscoveredParticipantIter iter = participants_.find(guid);
+    // Only cache the announcement if it was applied, which moves max_seq_ to
+    // its sequence number.
+    if (iter != participants_.end() && iter->second.max_seq_ == seq) {
+      iter->second.last_announcement_.assign(payload, payload + payload_length);
+      iter->second.last_announcement_user_tag_ = user_tag;
+    }
+  }
 }
 
 void
@@ -2807,53 +2898,15 @@ Spdp::SpdpTransport::write_i(WriteFlags flags)
     return;
   }
 
-  const ParticipantData_t pdata = outer->build_local_pdata(
-#if OPENDDS_CONFIG_SECURITY
-    true, outer->is_security_enabled() ? Security::DPDK_ENHANCED : Security::DPDK_ORIGINAL
-#endif
-  );
-
-  data_.writerSN = to_rtps_seqnum(seq_);
-  ++seq_;
-
-  ParameterList plist;
-  if (!ParameterListConverter::to_param_list(pdata, plist)) {
-    if (DCPS::DCPS_debug_level > 0) {
-      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
-        ACE_TEXT("Spdp::SpdpTransport::write_i: ")
-        ACE_TEXT("failed to convert from SPDPdiscoveredParticipantData ")
-        ACE_TEXT("to ParameterList\n")));
-    }
+  if (!update_announcement(*outer)) {
     return;
   }
 
-#if OPENDDS_CONFIG_SECURITY
-  if (!outer->is_security_enabled()) {
-    ICE::AgentInfoMap ai_map;
-    DCPS::WeakRcHandle<ICE::Endpoint> sedp_endpoint = outer->sedp_->get_ice_endpoint();
-    if (sedp_endpoint) {
-      ai_map[SEDP_AGENT_INFO_KEY] = outer->ice_agent_->get_local_agent_info(sedp_endpoint);
-    }
-    DCPS::WeakRcHandle<ICE::Endpoint> spdp_endpoint = get_ice_endpoint();
-    if (spdp_endpoint) {
-      ai_map[SPDP_AGENT_INFO_KEY] = outer->ice_agent_->get_local_agent_info(spdp_endpoint);
-    }
-
-    if (!ParameterListConverter::to_param_list(ai_map, plist)) {
-      if (DCPS::DCPS_debug_level > 0) {
-        ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
-                  ACE_TEXT("Spdp::SpdpTransport::write_i: ")
-                  ACE_TEXT("failed to convert from ICE::AgentInfo ")
-                  ACE_TEXT("to ParameterList\n")));
-      }
-      return;
-    }
-  }
-#endif
+  data_.writerSN = to_rtps_seqnum(seq_);
+  ++seq_;
 
   wbuff_.reset();
   DCPS::Serializer ser(&wbuff_, encoding_plain_native);
-  DCPS::EncapsulationHeader encap(ser.encoding(), DCPS::MUTABLE);
   if (!(ser << hdr_)) {
     if (log_level >= LogLevel::Error) {
       ACE_ERROR((LM_ERROR,
@@ -2873,7 +2926,9 @@ Spdp::SpdpTransport::write_i(WriteFlags flags)
     }
     return;
   }
-  if (!(ser << data_) || !(ser << encap) || !(ser << plist)) {
+  if (!(ser << data_) ||
+      !ser.write_octet_array(reinterpret_cast<const ACE_CDR::Octet*>(announcement_->rd_ptr()),
+                             static_cast<ACE_CDR::ULong>(announcement_->length()))) {
     if (log_level >= LogLevel::Error) {
       ACE_ERROR((LM_ERROR,
         ACE_TEXT("(%P|%t) ERROR: Spdp::SpdpTransport::write_i: ")
@@ -2885,6 +2940,109 @@ Spdp::SpdpTransport::write_i(WriteFlags flags)
   send(flags);
 }
 
+namespace {
+  bool locators_equal(const DCPS::LocatorSeq& x, const DCPS::LocatorSeq& y)
+  {
+    if (x.length() != y.length()) {
+      return false;
+    }
+    for (CORBA::ULong i = 0; i < x.length(); ++i) {
+      if (x[i].kind != y[i].kind || x[i].port != y[i].port ||
+          std::memcmp(x[i].address, y[i].address, sizeof x[i].address) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+bool
+Spdp::SpdpTransport::update_announcement(Spdp& outer)
+{
+  // Everything else in the announcement only changes with the participant's
+  // QoS, which resets announcement_.
+  const DCPS::LocatorSeq unicast_locators = outer.sedp_->unicast_locators();
+  const DCPS::LocatorSeq multicast_locators = outer.sedp_->multicast_locators();
+
+#if OPENDDS_CONFIG_SECURITY
+  ICE::AgentInfoMap ai_map;
+  if (!outer.is_security_enabled()) {
+    DCPS::WeakRcHandle<ICE::Endpoint> sedp_endpoint = outer.sedp_->get_ice_endpoint();
+    if (sedp_endpoint) {
+      ai_map[SEDP_AGENT_INFO_KEY] = outer.ice_agent_->get_local_agent_info(sedp_endpoint);
+    }
+    DCPS::WeakRcHandle<ICE::Endpoint> spdp_endpoint = get_ice_endpoint();
+    if (spdp_endpoint) {
+      ai_map[SPDP_AGENT_INFO_KEY] = outer.ice_agent_->get_local_agent_info(spdp_endpoint);
+    }
+  }
+#endif
+
+  if (announcement_ &&
+      locators_equal(unicast_locators, announced_unicast_locators_) &&
+      locators_equal(multicast_locators, announced_multicast_locators_)
+#if OPENDDS_CONFIG_SECURITY
+      && ai_map == announced_agent_info_
+#endif
+      ) {
+    return true;
+  }
+  announcement_.reset();
+
+  const ParticipantData_t pdata = outer.build_local_pdata(
+#if OPENDDS_CONFIG_SECURITY
+    true, outer.is_security_enabled() ? Security::DPDK_ENHANCED : Security::DPDK_ORIGINAL
+#endif
+  );
+
+  ParameterList plist;
+  if (!ParameterListConverter::to_param_list(pdata, plist)) {
+    if (DCPS::DCPS_debug_level > 0) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
+        ACE_TEXT("Spdp::SpdpTransport::update_announcement: ")
+        ACE_TEXT("failed to convert from SPDPdiscoveredParticipantData ")
+        ACE_TEXT("to ParameterList\n")));
+    }
+    return false;
+  }
+
+#if OPENDDS_CONFIG_SECURITY
+  if (!outer.is_security_enabled() && !ParameterListConverter::to_param_list(ai_map, plist)) {
+    if (DCPS::DCPS_debug_level > 0) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
+                ACE_TEXT("Spdp::SpdpTransport::update_announcement: ")
+                ACE_TEXT("failed to convert from ICE::AgentInfo ")
+                ACE_TEXT("to ParameterList\n")));
+    }
+    return false;
+  }
+#endif
+
+  // The encapsulation header resets the alignment, so the ParameterList can
+  // be serialized on its own and copied after any submessages.
+  size_t size = DCPS::EncapsulationHeader::serialized_size;
+  DCPS::serialized_size(encoding_plain_native, size, plist);
+  DCPS::Message_Block_Ptr announcement(new ACE_Message_Block(size));
+  DCPS::Serializer ser(announcement.get(), encoding_plain_native);
+  DCPS::EncapsulationHeader encap(ser.encoding(), DCPS::MUTABLE);
+  if (!(ser << encap) || !(ser << plist)) {
+    if (log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR,
+        ACE_TEXT("(%P|%t) ERROR: Spdp::SpdpTransport::update_announcement: ")
+        ACE_TEXT("failed to serialize ParameterList for SPDP\n")));
+    }
+    return false;
+  }
+
+  announcement_.reset(announcement.release());
+  announced_unicast_locators_ = unicast_locators;
+  announced_multicast_locators_ = multicast_locators;
+#if OPENDDS_CONFIG_SECURITY
+  announced_agent_info_ = ai_map;
+#endif
+  return true;
+}
+
 void
 Spdp::update_rtps_relay_application_participant_i(DiscoveredParticipantIter iter, bool new_participant)
 {
@@ -2937,47 +3095,12 @@ Spdp::SpdpTransport::write_i(const DCPS::GUID_t& guid, const DCPS::NetworkAddres
   DCPS::RcHandle<Spdp> outer = outer_.lock();
   if (!outer) return;
 
-  const ParticipantData_t pdata = outer->build_local_pdata(
-#if OPENDDS_CONFIG_SECURITY
-    true, outer->is_security_enabled() ? Security::DPDK_ENHANCED : Security::DPDK_ORIGINAL
-#endif
-  );
-
-  data_.writerSN = to_rtps_seqnum(seq_);
-  ++seq_;
-
-  ParameterList plist;
-  if (!ParameterListConverter::to_param_list(pdata, plist)) {
-    if (DCPS::DCPS_debug_level > 0) {
-      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
-        ACE_TEXT("Spdp::SpdpTransport::write_i() - ")
-        ACE_TEXT("failed to convert from SPDPdiscoveredParticipantData ")
-        ACE_TEXT("to ParameterList\n")));
-    }
+  if (!update_announcement(*outer)) {
     return;
   }
 
-#if OPENDDS_CONFIG_SECURITY
-  if (!outer->is_security_enabled()) {
-    ICE::AgentInfoMap ai_map;
-    DCPS::WeakRcHandle<ICE::Endpoint> sedp_endpoint = outer->sedp_->get_ice_endpoint();
-    if (sedp_endpoint) {
-      ai_map[SEDP_AGENT_INFO_KEY] = outer->ice_agent_->get_local_agent_info(sedp_endpoint);
-    }
-    DCPS::WeakRcHandle<ICE::Endpoint> spdp_endpoint = get_ice_endpoint();
-    if (spdp_endpoint) {
-      ai_map[SPDP_AGENT_INFO_KEY] = outer->ice_agent_->get_local_agent_info(spdp_endpoint);
-    }
-
-    if (!ParameterListConverter::to_param_list(ai_map, plist)) {
-      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: ")
-                 ACE_TEXT("Spdp::SpdpTransport::write_i() - ")
-                 ACE_TEXT("failed to convert from ICE::AgentInfo ")
-                 ACE_TEXT("to ParameterList\n")));
-      return;
-    }
-  }
-#endif
+  data_.writerSN = to_rtps_seqnum(seq_);
+  ++seq_;
 
   InfoDestinationSubmessage info_dst;
   info_dst.smHeader.submessageId = INFO_DST;
@@ -2987,7 +3110,6 @@ Spdp::SpdpTransport::write_i(const DCPS::GUID_t& guid, const DCPS::NetworkAddres
 
   wbuff_.reset();
   DCPS::Serializer ser(&wbuff_, encoding_plain_native);
-  DCPS::EncapsulationHeader encap(ser.encoding(), DCPS::MUTABLE);
   if (!(ser << hdr_)) {
     if (log_level >= LogLevel::Error) {
       ACE_ERROR((LM_ERROR,
@@ -3008,7 +3130,9 @@ Spdp::SpdpTransport::write_i(const DCPS::GUID_t& guid, const DCPS::NetworkAddres
     return;
   }
 
-  if (!(ser << info_dst) || !(ser << data_) || !(ser << encap) || !(ser << plist)) {
+  if (!(ser << info_dst) || !(ser << data_) ||
+      !ser.write_octet_array(reinterpret_cast<const ACE_CDR::Octet*>(announcement_->rd_ptr()),
+                             static_cast<ACE_CDR::ULong>(announcement_->length()))) {
     if (DCPS::DCPS_debug_level > 0) {
       ACE_ERROR((LM_ERROR,
         ACE_TEXT("(%P|%t) ERROR: Spdp::SpdpTransport::write_i() - ")
@@ -3236,8 +3360,26 @@ Spdp::SpdpTransport::handle_input(ACE_HANDLE h)
           break;
         }
 
+        // The serialized payload, starting with the encapsulation header, so
+        // an announcement that hasn't changed doesn't have to be decoded.
+        const char* const payload = buff_.rd_ptr();
+        size_t payload_length = buff_.length();
+        if (submessageLength) {
+          const size_t read = start - buff_.length();
+          const size_t end = static_cast<size_t>(submessageLength + SMHDR_SZ);
+          payload_length = read < end ? std::min(payload_length, end - read) : 0;
+        }
+        DCPS::RcHandle<Spdp> outer_rc = outer_.lock();
+        if (!outer_rc) {
+          break;
+        }
+
         ParameterList plist;
         if (data.smHeader.flags & (FLAG_D | FLAG_K_IN_DATA)) {
+          if ((data.smHeader.flags & FLAG_D) &&
+              outer_rc->announcement_unchanged(data, header.guidPrefix, payload, payload_length, userTag, remote_na)) {
+            break;
+          }
           DCPS::EncapsulationHeader encap;
           DCPS::Encoding enc;
           if (!(ser >> encap) || !to_encoding(enc, encap, DCPS::MUTABLE) || enc.kind() != Encoding::KIND_XCDR1) {
@@ -3273,9 +3415,10 @@ Spdp::SpdpTransport::handle_input(ACE_HANDLE h)
           plist[len].user_tag(userTag);
         }
 
-        DCPS::RcHandle<Spdp> outer_rc = outer_.lock();
-        if (outer_rc) {
-          outer_rc->data_received(data, plist, remote_na);
+        if (data.smHeader.flags & FLAG_D) {
+          outer_rc->data_received(data, plist, remote_na, payload, payload_length, userTag);
+        } else {
+          outer_rc->data_received(data, plist, remote_na, 0, 0, userTag);
         }
         break;
       }
@@ -4861,6 +5004,9 @@ bool Spdp::update_domain_participant_qos(const DDS::DomainParticipantQos& qos)
 {
   ACE_GUARD_RETURN(ACE_Thread_Mutex, g, lock_, false);
   qos_ = qos;
+  if (tport_) {
+    tport_->announcement_.reset();
+  }
   return announce_domain_participant_qos();
 }
 
@@ -4908,7 +5054,9 @@ namespace { namespace OPENDDS_RTPS_UNITY_BUILD_ID {
     Stats_Index_TotalReaderPending = 9,
     Stats_Index_TotalReaderAssociated = 10,
     Stats_Index_DirectedGuids = 11,
-    Stats_Len = 12;
+    Stats_Index_AnnouncementCacheHits = 12,
+    Stats_Index_AnnouncementCacheMisses = 13,
+    Stats_Len = 14;
 } }
 
 DCPS::StatisticSeq Spdp::stats_template()
@@ -4929,6 +5077,8 @@ DCPS::StatisticSeq Spdp::stats_template()
   stats[Stats_Index_TotalReaderPending].name = "TotalReaderPending";
   stats[Stats_Index_TotalReaderAssociated].name = "TotalReaderAssociated";
   stats[Stats_Index_DirectedGuids].name = "DirectedGuids";
+  stats[Stats_Index_AnnouncementCacheHits].name = "AnnouncementCacheHits";
+  stats[Stats_Index_AnnouncementCacheMisses].name = "AnnouncementCacheMisses";
   for (DDS::UInt32 i = 0; i < sedp_template.length(); ++i) {
     stats[Stats_Len + i].name = sedp_template[i].name;
   }
@@ -4954,6 +5104,8 @@ void Spdp::fill_stats(DCPS::StatisticSeq& stats) const
   stats[Stats_Index_TotalReaderPending].value = total_reader_pending_;
   stats[Stats_Index_TotalReaderAssociated].value = total_reader_associated_;
   stats[Stats_Index_DirectedGuids].value = tport_ ? tport_->directed_guids_.size() : 0;
+  stats[Stats_Index_AnnouncementCacheHits].value = announcement_cache_hits_;
+  stats[Stats_Index_AnnouncementCacheMisses].value = announcement_cache_misses_;
   sedp_->fill_stats(stats, Stats_Len);
 }
 
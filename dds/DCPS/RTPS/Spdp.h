@@ -17,6 +17,7 @@
 #include <dds/DCPS/Discovery.h>
 #include <dds/DCPS/GuidUtils.h>
 #include <dds/DCPS/JobQueue.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
 #include <dds/DCPS/MulticastManager.h>
 #include <dds/DCPS/PeriodicEvent.h>
 #include <dds/DCPS/PoolAllocationBase.h>
@@ -437,7 +438,29 @@ private:
   DDS::UInt16 ipv6_participant_port_id_;
 #endif
 
-  void data_received(const DataSubmessage& data, const ParameterList& plist, const DCPS::NetworkAddress& from);
+  /**
+   * If payload, the serialized ParameterList of an SPDP announcement from
+   * the participant with prefix, is the same as the last one that was fully
+   * processed for that participant, treat it as liveliness: update the
+   * lease, sequence number, and location without decoding it and return
+   * true. Otherwise return false and the caller passes the announcement on
+   * to data_received.
+   */
+  bool announcement_unchanged(const DataSubmessage& data,
+                              const DCPS::GuidPrefix_t& prefix,
+                              const char* payload,
+                              size_t payload_length,
+                              ACE_CDR::ULong user_tag,
+                              const DCPS::NetworkAddress& from);
+
+  /// payload, payload_length, and user_tag are the raw announcement that plist
+  /// was deserialized from. If payload is null the announcement isn't cached.
+  void data_received(const DataSubmessage& data,
+                     const ParameterList& plist,
+                     const DCPS::NetworkAddress& from,
+                     const char* payload,
+                     size_t payload_length,
+                     ACE_CDR::ULong user_tag);
 
   void match_unauthenticated(const DiscoveredParticipantIter& dp_iter);
 
@@ -523,6 +546,7 @@ private:
     void write(WriteFlags flags);
     void write_i(WriteFlags flags);
     void write_i(const DCPS::GUID_t& guid, const DCPS::NetworkAddress& local_address, WriteFlags flags);
+    bool update_announcement(Spdp& outer);
     void send(WriteFlags flags, const DCPS::NetworkAddress& local_address = DCPS::NetworkAddress());
     const ACE_SOCK_Dgram& choose_send_socket(const DCPS::NetworkAddress& addr) const;
     ssize_t send(const DCPS::NetworkAddress& addr);
@@ -569,6 +593,15 @@ private:
     DCPS::MulticastManager multicast_manager_;
     DCPS::NetworkAddressSet send_addrs_;
     ACE_Message_Block buff_, wbuff_;
+    /// Encapsulated ParameterList of the local participant's announcement,
+    /// null when it has to be built again. The locators and ICE agent info it
+    /// was built with are kept to tell when they change.
+    DCPS::Message_Block_Ptr announcement_;
+    DCPS::LocatorSeq announced_unicast_locators_;
+    DCPS::LocatorSeq announced_multicast_locators_;
+#if OPENDDS_CONFIG_SECURITY
+    ICE::AgentInfoMap announced_agent_info_;
+#endif
     typedef DCPS::PmfEvent<SpdpTransport> SpdpTransportEvent;
     void send_local();
     DCPS::PeriodicEvent_rch local_send_event_;
@@ -705,6 +738,9 @@ private:
   const DCPS::StatisticSeq stats_template_;
   size_t total_location_updates_, total_builtin_pending_, total_builtin_associated_,
     total_writer_pending_, total_writer_associated_, total_reader_pending_, total_reader_associated_;
+  /// SPDP announcements that did and didn't match the participant's last
+  /// announcement (see announcement_unchanged).
+  size_t announcement_cache_hits_, announcement_cache_misses_;
 
   friend class ::DDS_TEST;
 };
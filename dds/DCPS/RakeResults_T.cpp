@@ -84,6 +84,8 @@ bool RakeResults<MessageType>::insert_sample(ReceivedDataElement* sample,
                                              SubscriptionInstance_rch instance,
                                              size_t index_in_instance)
 {
+  sample->materialize();
+
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
   if (do_filter_) {
@@ -8,6 +8,7 @@
 #include "ReceivedDataElementList.h"
 
 #include "DataReaderImpl.h"
+#include "GuidConverter.h"
 
 #if !defined (__ACE_INLINE__)
 # include "ReceivedDataElementList.inl"
@@ -54,6 +55,18 @@ void OpenDDS::DCPS::ReceivedDataElement::operator delete(void* memory, ACE_New_A
   operator delete(memory);
 }
 
+void OpenDDS::DCPS::ReceivedDataElement::materialize()
+{
+  if (valid_data_ && registered_data_ && !materialize_i()) {
+    valid_data_ = false;
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: ReceivedDataElement::materialize: "
+                 "deserialization of sample %q from %C failed\n",
+                 sequence_.getValue(), LogGuid(pub_).c_str()));
+    }
+  }
+}
+
 OpenDDS::DCPS::ReceivedDataElementList::ReceivedDataElementList(const DataReaderImpl_rch& reader, const InstanceState_rch& instance_state)
   : reader_(reader), head_(0), tail_(0), size_(0)
   , read_sample_count_(0), not_read_sample_count_(0), sample_states_(0)
@@ -83,6 +83,14 @@ public:
     return ref_count_;
   }
 
+  /**
+   * Deserialize registered_data_ if the DataReader stored the sample without
+   * doing so (see DCPSLazyDeserialization). This must be done before
+   * registered_data_ or valid_data_ are used. If deserialization fails the
+   * sample is left without valid data.
+   */
+  void materialize();
+
   GUID_t pub_;
 
   /**
@@ -140,6 +148,10 @@ public:
   void operator delete(void* memory);
   void operator delete(void* memory, ACE_New_Allocator& pool);
 
+protected:
+  /// Returns false if the deferred deserialization failed.
+  virtual bool materialize_i() { return true; }
+
 private:
   Atomic<long> ref_count_;
 protected:
@@ -168,6 +180,12 @@ public:
               *mx_)
     delete static_cast<DataTypeWithAllocator*> (registered_data_);
   }
+
+protected:
+  bool materialize_i()
+  {
+    return static_cast<DataTypeWithAllocator*>(registered_data_)->materialize();
+  }
 };
 
 class OpenDDS_Dcps_Export ReceivedDataFilter {
@@ -213,6 +231,8 @@ public:
 
   bool has_zero_copies() const;
   bool matches(CORBA::ULong sample_states) const;
+  /// The sample states of the samples in the list, 0 if it's empty.
+  CORBA::ULong sample_states() const { return sample_states_; }
   ReceivedDataElement* get_next_match(CORBA::ULong sample_states, ReceivedDataElement* prev);
 
   void mark_read(ReceivedDataElement* item);
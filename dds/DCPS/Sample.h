@@ -70,6 +70,8 @@ public:
   virtual bool deserialize(Serializer& ser) = 0;
   virtual size_t serialized_size(const Encoding& enc) const = 0;
   virtual bool compare(const Sample& other) const = 0;
+  /// Hash of the key fields, consistent with compare().
+  virtual size_t key_hash() const = 0;
   virtual bool to_message_block(ACE_Message_Block& mb) const = 0;
   virtual bool from_message_block(const ACE_Message_Block& mb) = 0;
   virtual Sample_rch copy(Mutability mutability, Extent extent) const = 0;
@@ -101,6 +103,20 @@ struct OpenDDS_Dcps_Export SampleRchCmp {
   }
 };
 
+struct OpenDDS_Dcps_Export SampleRchHash {
+  size_t operator()(const Sample_rch& sample) const
+  {
+    return sample->key_hash();
+  }
+};
+
+struct OpenDDS_Dcps_Export SampleRchEqual {
+  bool operator()(const Sample_rch& lhs, const Sample_rch& rhs) const
+  {
+    return !lhs->compare(*rhs) && !rhs->compare(*lhs);
+  }
+};
+
 template <typename NativeType>
 class Sample_T : public Sample {
 public:
@@ -213,6 +229,11 @@ public:
     return typename TraitsType::LessThanType()(*data_, *other_same_kind->data_);
   }
 
+  size_t key_hash() const
+  {
+    return typename TraitsType::KeyHashType()(*data_);
+  }
+
   bool to_message_block(ACE_Message_Block& mb) const
   {
     return MarshalTraitsType::to_message_block(mb, data());
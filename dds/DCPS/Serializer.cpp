@@ -11,6 +11,7 @@
 # include "Serializer.inl"
 #endif /* !__ACE_INLINE__ */
 
+#include "ByteSwap.h"
 #include "SafetyProfileStreams.h"
 
 #ifndef OPENDDS_UTIL_BUILD
@@ -288,6 +289,70 @@ Serializer::swapcpy(char* to, const char* from, size_t n)
   }
 }
 
+void
+Serializer::read_swapped_array(char* x, size_t size, ACE_CDR::ULong length)
+{
+  while (length > 0) {
+    if (!current_) {
+      good_bit_ = false;
+      return;
+    }
+    const size_t n = (std::min)(size_t(length), current_->length() / size);
+    if (n) {
+      const size_t bytes = n * size;
+      swap_array(x, current_->rd_ptr(), size, n);
+      current_->rd_ptr(bytes);
+      rpos_ += bytes;
+      x += bytes;
+      length -= static_cast<ACE_CDR::ULong>(n);
+      if (current_->length() == 0) {
+        if (encoding().alignment()) {
+          align_cont_r();
+        } else {
+          current_ = current_->cont();
+        }
+      }
+    } else {
+      // The next element is split between blocks.
+      buffer_read(x, size, true);
+      x += size;
+      --length;
+    }
+  }
+}
+
+void
+Serializer::write_swapped_array(const char* x, size_t size, ACE_CDR::ULong length)
+{
+  while (length > 0) {
+    if (!current_) {
+      good_bit_ = false;
+      return;
+    }
+    const size_t n = (std::min)(size_t(length), current_->space() / size);
+    if (n) {
+      const size_t bytes = n * size;
+      swap_array(current_->wr_ptr(), x, size, n);
+      current_->wr_ptr(bytes);
+      wpos_ += bytes;
+      x += bytes;
+      length -= static_cast<ACE_CDR::ULong>(n);
+      if (current_->space() == 0) {
+        if (encoding().alignment()) {
+          align_cont_w();
+        } else {
+          current_ = current_->cont();
+        }
+      }
+    } else {
+      // The next element is split between blocks.
+      buffer_write(x, size, true);
+      x += size;
+      --length;
+    }
+  }
+}
+
 size_t
 Serializer::read_string(ACE_CDR::Char*& dest,
                         StrAllocate str_alloc,
@@ -754,6 +754,13 @@ private:
   void write_array(const char* x, size_t size, ACE_CDR::ULong length, bool swap);
   ///@}
 
+  ///@{
+  /// Byte swapping array copies for 2, 4, and 8 byte elements. Elements that
+  /// are wholly inside the current block are swapped in bulk.
+  void read_swapped_array(char* x, size_t size, ACE_CDR::ULong length);
+  void write_swapped_array(const char* x, size_t size, ACE_CDR::ULong length);
+  ///@}
+
   /// Efficient straight copy for quad words and shorter.  This is
   /// an instance method to match the swapcpy semantics.
   void smemcpy(char* to, const char* from, size_t n);
@@ -447,6 +447,9 @@ Serializer::read_array(char* x, size_t size,
     //
     buffer_read(x, size * length, false);
 
+  } else if (size == 2 || size == 4 || size == 8) {
+    read_swapped_array(x, size, length);
+
   } else {
     //
     // Swapping _must_ be done at 'size' boundaries, so we need to spin
@@ -476,6 +479,9 @@ Serializer::write_array(const char* x, size_t size,
     //
     buffer_write(x, size * length, false);
 
+  } else if (size == 2 || size == 4 || size == 8) {
+    write_swapped_array(x, size, length);
+
   } else {
     //
     // Swapping _must_ be done at 'size' boundaries, so we need to spin
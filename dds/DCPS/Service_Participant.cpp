@@ -1686,6 +1686,19 @@ Service_Participant::publisher_content_filter() const
                                     COMMON_DCPS_PUBLISHER_CONTENT_FILTER_default);
 }
 
+void
+Service_Participant::lazy_deserialization(bool flag)
+{
+  config_store_->set_boolean(COMMON_DCPS_LAZY_DESERIALIZATION, flag);
+}
+
+bool
+Service_Participant::lazy_deserialization() const
+{
+  return config_store_->get_boolean(COMMON_DCPS_LAZY_DESERIALIZATION,
+                                    COMMON_DCPS_LAZY_DESERIALIZATION_default);
+}
+
 TimeDuration
 Service_Participant::pending_timeout() const
 {
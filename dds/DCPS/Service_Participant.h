@@ -107,6 +107,9 @@ const String COMMON_DCPS_GLOBAL_TRANSPORT_CONFIG_default = "";
 
 const char COMMON_DCPS_INFO_REPO[] = "COMMON_DCPS_INFO_REPO";
 
+const char COMMON_DCPS_LAZY_DESERIALIZATION[] = "COMMON_DCPS_LAZY_DESERIALIZATION";
+const bool COMMON_DCPS_LAZY_DESERIALIZATION_default = false;
+
 const char COMMON_DCPS_LIVELINESS_FACTOR[] = "COMMON_DCPS_LIVELINESS_FACTOR";
 const int COMMON_DCPS_LIVELINESS_FACTOR_default = 80;
 
@@ -424,6 +427,12 @@ public:
   bool publisher_content_filter() const;
   //@}
 
+  /// Accessors for LazyDeserialization.
+  //@{
+  void lazy_deserialization(bool);
+  bool lazy_deserialization() const;
+  //@}
+
   /// Accessors for pending data timeout.
   //@{
   TimeDuration pending_timeout() const;
@@ -26,6 +26,7 @@ SubscriptionInstance::SubscriptionInstance(const DataReaderImpl_rch& reader,
   , sample_states_(0)
   , instance_handle_(handle)
   , owns_handle_(owns_handle)
+  , combined_states_(0)
 {
   switch (qos.destination_order.kind) {
   case DDS::BY_RECEPTION_TIMESTAMP_DESTINATIONORDER_QOS:
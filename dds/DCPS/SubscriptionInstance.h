@@ -66,6 +66,10 @@ public:
 
   const bool owns_handle_;
 
+  /// Combined states the DataReader's lookup maps have this instance under,
+  /// 0 if it's not in them.
+  CORBA::ULong combined_states_;
+
   MonotonicTimePoint last_sample_tv_;
 
   MonotonicTimePoint cur_sample_tv_;
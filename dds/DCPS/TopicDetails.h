@@ -7,6 +7,7 @@
 #define OPENDDS_DCPS_TOPICDETAILS_H
 
 #include "TopicCallbacks.h"
+#include "DCPS_Utils.h"
 #include "GuidUtils.h"
 #include "debug.h"
 #include "Definitions.h"
@@ -21,6 +22,92 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
   namespace DCPS {
 
+    /**
+     * Index of the partitions of a topic's publications or subscriptions so
+     * an endpoint can be matched with just the ones that might be in a
+     * matching partition instead of all of them.
+     */
+    class PartitionIndex {
+    public:
+      void insert(const GUID_t& guid, const DDS::PartitionQosPolicy& partition)
+      {
+        remove(guid);
+        Names& names = guid_names_[guid];
+        if (partition.name.length() == 0) {
+          names.push_back("");
+        }
+        for (CORBA::ULong i = 0; i < partition.name.length(); ++i) {
+          const char* const name = partition.name[i];
+          if (is_wildcard(name)) {
+            wildcards_.insert(guid);
+          } else {
+            names.push_back(name);
+          }
+        }
+        for (Names::const_iterator pos = names.begin(), limit = names.end(); pos != limit; ++pos) {
+          by_name_[*pos].insert(guid);
+        }
+      }
+
+      void remove(const GUID_t& guid)
+      {
+        const GuidNames::iterator pos = guid_names_.find(guid);
+        if (pos == guid_names_.end()) {
+          return;
+        }
+        for (Names::const_iterator n = pos->second.begin(), limit = pos->second.end(); n != limit; ++n) {
+          const NameMap::iterator by_name = by_name_.find(*n);
+          if (by_name != by_name_.end()) {
+            by_name->second.erase(guid);
+            if (by_name->second.empty()) {
+              by_name_.erase(by_name);
+            }
+          }
+        }
+        wildcards_.erase(guid);
+        guid_names_.erase(pos);
+      }
+
+      /// Add the endpoints that could be in a partition that matches
+      /// partition to result. Returns false if partition has a wildcard,
+      /// since it could match any of them.
+      bool find(const DDS::PartitionQosPolicy& partition, RepoIdSet& result) const
+      {
+        for (CORBA::ULong i = 0; i < partition.name.length(); ++i) {
+          if (is_wildcard(partition.name[i])) {
+            return false;
+          }
+        }
+        result.insert(wildcards_.begin(), wildcards_.end());
+        if (partition.name.length() == 0) {
+          find_i("", result);
+        }
+        for (CORBA::ULong i = 0; i < partition.name.length(); ++i) {
+          const char* const name = partition.name[i];
+          find_i(name, result);
+        }
+        return true;
+      }
+
+    private:
+      void find_i(const String& name, RepoIdSet& result) const
+      {
+        const NameMap::const_iterator pos = by_name_.find(name);
+        if (pos != by_name_.end()) {
+          result.insert(pos->second.begin(), pos->second.end());
+        }
+      }
+
+      typedef OPENDDS_VECTOR(String) Names;
+      typedef OPENDDS_MAP_CMP(GUID_t, Names, GUID_tKeyLessThan) GuidNames;
+      /// The names without wildcards of each endpoint, "" for the default partition
+      GuidNames guid_names_;
+      typedef OPENDDS_MAP(String, RepoIdSet) NameMap;
+      NameMap by_name_;
+      /// Endpoints with a partition name with a wildcard
+      RepoIdSet wildcards_;
+    };
+
     struct TopicDetails {
 
       TopicDetails()
@@ -73,6 +160,7 @@ namespace OpenDDS {
       void remove_local_publication(const DCPS::GUID_t& guid)
       {
         local_publications_.erase(guid);
+        publication_partitions_.remove(guid);
       }
 
       const RepoIdSet& local_publications() const
@@ -88,6 +176,7 @@ namespace OpenDDS {
       void remove_local_subscription(const DCPS::GUID_t& guid)
       {
         local_subscriptions_.erase(guid);
+        subscription_partitions_.remove(guid);
       }
 
       const RepoIdSet& local_subscriptions() const
@@ -103,6 +192,7 @@ namespace OpenDDS {
       void remove_discovered_publication(const DCPS::GUID_t& guid)
       {
         discovered_publications_.erase(guid);
+        publication_partitions_.remove(guid);
       }
 
       const RepoIdSet& discovered_publications() const
@@ -118,6 +208,7 @@ namespace OpenDDS {
       void remove_discovered_subscription(const DCPS::GUID_t& guid)
       {
         discovered_subscriptions_.erase(guid);
+        subscription_partitions_.remove(guid);
       }
 
       const RepoIdSet& discovered_subscriptions() const
@@ -125,6 +216,40 @@ namespace OpenDDS {
         return discovered_subscriptions_;
       }
 
+      /// Index the partitions of a publication or subscription that was added
+      /// or whose partitions changed. Not indexed endpoints aren't returned by
+      /// publications_in_partitions or subscriptions_in_partitions.
+      ///@{
+      void set_publication_partitions(const DCPS::GUID_t& guid,
+                                      const DDS::PartitionQosPolicy& partition)
+      {
+        publication_partitions_.insert(guid, partition);
+      }
+
+      void set_subscription_partitions(const DCPS::GUID_t& guid,
+                                       const DDS::PartitionQosPolicy& partition)
+      {
+        subscription_partitions_.insert(guid, partition);
+      }
+      ///@}
+
+      /// Add the local and discovered publications or subscriptions that
+      /// could be in a partition matching partition to result. Returns false
+      /// if that could be any of them.
+      ///@{
+      bool publications_in_partitions(const DDS::PartitionQosPolicy& partition,
+                                      RepoIdSet& result) const
+      {
+        return publication_partitions_.find(partition, result);
+      }
+
+      bool subscriptions_in_partitions(const DDS::PartitionQosPolicy& partition,
+                                       RepoIdSet& result) const
+      {
+        return subscription_partitions_.find(partition, result);
+      }
+      ///@}
+
       void increment_inconsistent()
       {
         ++inconsistent_topic_count_;
@@ -158,6 +283,8 @@ namespace OpenDDS {
       RepoIdSet local_subscriptions_;
       RepoIdSet discovered_publications_;
       RepoIdSet discovered_subscriptions_;
+      PartitionIndex publication_partitions_;
+      PartitionIndex subscription_partitions_;
       int inconsistent_topic_count_;
       int assertion_count_;
     };
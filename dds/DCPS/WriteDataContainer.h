@@ -241,6 +241,20 @@ public:
    */
   size_t num_all_samples();
 
+  /**
+   * Return true if obtain_buffer could replace or wait for one of the
+   * instance_pending samples most recently enqueued for an instance, or the
+   * total_pending samples enqueued overall, before they are sent. Once an
+   * instance has history_depth_ samples, reaching max_samples overall makes
+   * obtain_buffer remove its oldest one, so that also needs a flush.
+   */
+  bool batch_needs_flush(size_t instance_pending, size_t total_pending) const
+  {
+    return instance_pending >= static_cast<size_t>(max_samples_per_instance_) ||
+      instance_pending >= static_cast<size_t>(history_depth_) ||
+      (max_num_samples_ > 0 && total_pending >= static_cast<size_t>(max_num_samples_));
+  }
+
   /**
    * Obtain a list of data that has not yet been sent.  The data
    * on the list returned is moved from the internal unsent_data_
@@ -14,6 +14,8 @@
 #include "Utils.h"
 
 #include <dds/DCPS/DCPS_Utils.h>
+#include <dds/DCPS/Hash.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
 #include <dds/DCPS/debug.h>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -299,6 +301,43 @@ bool DynamicSample::compare(const Sample& other) const
   return is_less_than;
 }
 
+size_t DynamicSample::key_hash() const
+{
+  // Hash the canonical key-only serialization, so samples with equal keys hash
+  // the same no matter how their DynamicData is backed.
+  const DynamicDataBase* const ddb = dynamic_cast<DynamicDataBase*>(data_.in());
+  if (!ddb) {
+    return 0;
+  }
+  static const Encoding encoding(Encoding::KIND_XCDR2, ENDIAN_BIG);
+  size_t size = 0;
+  if (!ddb->serialized_size(encoding, size, Sample::KeyOnly)) {
+    return 0;
+  }
+
+  // This is called for every instance lookup, most keys fit on the stack.
+  ACE_UINT64 buffer[32];
+  ACE_Data_Block db(sizeof buffer, ACE_Message_Block::MB_DATA, reinterpret_cast<const char*>(buffer),
+                    0 /*alloc*/, 0 /*lock*/, ACE_Message_Block::DONT_DELETE, 0 /*db_alloc*/);
+  ACE_Message_Block stack_mb(&db, ACE_Message_Block::DONT_DELETE, 0 /*mb_alloc*/);
+  Message_Block_Ptr heap_mb;
+  ACE_Message_Block* mb = &stack_mb;
+  if (size > sizeof buffer) {
+    heap_mb.reset(new ACE_Message_Block(size));
+    mb = heap_mb.get();
+  }
+
+  Serializer ser(mb, encoding);
+  if (!ddb->serialize(ser, Sample::KeyOnly)) {
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: DynamicSample::key_hash: "
+        "serialize failed\n"));
+    }
+    return 0;
+  }
+  return fnv_1a_hash(reinterpret_cast<const unsigned char*>(mb->rd_ptr()), mb->length());
+}
+
 }
 }
 OPENDDS_END_VERSIONED_NAMESPACE_DECL
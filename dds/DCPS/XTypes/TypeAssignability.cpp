@@ -256,6 +256,27 @@ bool TypeAssignability::assignable(const TypeIdentifier& ta,
 
 bool TypeAssignability::assignable(const TypeInformation& ta,
                                    const TypeInformation& tb) const
+{
+  // Endpoints of the same types are matched many times, so the result is
+  // memoized by the TypeLookupService.
+  const ACE_CDR::Octet consistency =
+    (type_consistency_.prevent_type_widening ? 1 : 0) |
+    (type_consistency_.ignore_sequence_bounds ? 2 : 0) |
+    (type_consistency_.ignore_string_bounds ? 4 : 0) |
+    (type_consistency_.ignore_member_names ? 8 : 0);
+  const TypeLookupService::AssignabilityKey key(ta, tb, consistency);
+  bool result = false;
+  ACE_UINT64 generation = 0;
+  if (tl_service_->get_assignable(key, result, generation)) {
+    return result;
+  }
+  result = assignable_i(ta, tb);
+  tl_service_->cache_assignable(key, result, generation);
+  return result;
+}
+
+bool TypeAssignability::assignable_i(const TypeInformation& ta,
+                                     const TypeInformation& tb) const
 {
   if (use_complete_type_objects()) {
     const TypeIdentifier& complete_ta = ta.complete.typeid_with_size.type_id;
@@ -85,6 +85,7 @@ public:
   }
 
 private:
+  bool assignable_i(const TypeInformation& ta, const TypeInformation& tb) const;
   bool assignable_alias(const MinimalTypeObject& ta, const MinimalTypeObject& tb) const;
   bool assignable_annotation(const MinimalTypeObject& ta, const MinimalTypeObject& tb) const;
   bool assignable_annotation(const MinimalTypeObject& ta, const TypeIdentifier& tb) const;
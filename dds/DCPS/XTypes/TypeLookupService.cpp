@@ -35,6 +35,7 @@ namespace OpenDDS {
 namespace XTypes {
 
 TypeLookupService::TypeLookupService()
+  : assignability_generation_(0)
 {
   to_empty_.minimal.kind = TK_NONE;
   to_empty_.complete.kind = TK_NONE;
@@ -145,6 +146,7 @@ void TypeLookupService::add_type_objects_to_cache(const TypeIdentifierTypeObject
       TypeObject to = types[i].type_object;
       if (set_type_object_defaults(to)) {
         type_map_.insert(std::make_pair(types[i].type_identifier, to));
+        clear_assignable_i();
       }
     }
   }
@@ -153,7 +155,11 @@ void TypeLookupService::add_type_objects_to_cache(const TypeIdentifierTypeObject
 void TypeLookupService::add(TypeMap::const_iterator begin, TypeMap::const_iterator end)
 {
   ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
+  const size_t size = type_map_.size();
   type_map_.insert(begin, end);
+  if (type_map_.size() != size) {
+    clear_assignable_i();
+  }
 }
 
 void TypeLookupService::add(const TypeIdentifier& ti, const TypeObject& tobj)
@@ -162,14 +168,18 @@ void TypeLookupService::add(const TypeIdentifier& ti, const TypeObject& tobj)
   TypeMap::const_iterator pos = type_map_.find(ti);
   if (pos == type_map_.end()) {
     type_map_.insert(std::make_pair(ti, tobj));
+    clear_assignable_i();
   }
 }
 
 void TypeLookupService::update_type_identifier_map(const TypeIdentifierPairSeq& tid_pairs)
 {
+  ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
   for (ACE_CDR::ULong i = 0; i < tid_pairs.length(); ++i) {
     const TypeIdentifierPair& pair = tid_pairs[i];
-    complete_to_minimal_ti_map_.insert(std::make_pair(pair.type_identifier1, pair.type_identifier2));
+    if (complete_to_minimal_ti_map_.insert(std::make_pair(pair.type_identifier1, pair.type_identifier2)).second) {
+      clear_assignable_i();
+    }
   }
 }
 
@@ -198,6 +208,63 @@ const TypeInformation& TypeLookupService::get_type_info(const DDS::BuiltinTopicK
   return type_info_empty_;
 }
 
+TypeLookupService::AssignabilityKey::AssignabilityKey(const TypeInformation& reader,
+                                                     const TypeInformation& writer,
+                                                     ACE_CDR::Octet consistency)
+  : reader_minimal(reader.minimal.typeid_with_size.type_id)
+  , reader_complete(reader.complete.typeid_with_size.type_id)
+  , writer_minimal(writer.minimal.typeid_with_size.type_id)
+  , writer_complete(writer.complete.typeid_with_size.type_id)
+  , consistency(consistency)
+{
+}
+
+bool TypeLookupService::AssignabilityKey::operator<(const AssignabilityKey& other) const
+{
+  if (reader_minimal < other.reader_minimal) return true;
+  if (other.reader_minimal < reader_minimal) return false;
+  if (writer_minimal < other.writer_minimal) return true;
+  if (other.writer_minimal < writer_minimal) return false;
+  if (reader_complete < other.reader_complete) return true;
+  if (other.reader_complete < reader_complete) return false;
+  if (writer_complete < other.writer_complete) return true;
+  if (other.writer_complete < writer_complete) return false;
+  return consistency < other.consistency;
+}
+
+bool TypeLookupService::get_assignable(const AssignabilityKey& key, bool& assignable,
+                                       ACE_UINT64& generation) const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, mutex_, false);
+  const AssignabilityMap::const_iterator pos = assignability_map_.find(key);
+  if (pos != assignability_map_.end()) {
+    assignable = pos->second;
+    return true;
+  }
+  generation = assignability_generation_;
+  return false;
+}
+
+void TypeLookupService::cache_assignable(const AssignabilityKey& key, bool assignable,
+                                         ACE_UINT64 generation)
+{
+  ACE_GUARD(ACE_Thread_Mutex, g, mutex_);
+  if (generation != assignability_generation_) {
+    // A type was added while the result was being computed.
+    return;
+  }
+  if (assignability_map_.size() >= MAX_ASSIGNABILITY_MAP_SIZE) {
+    assignability_map_.clear();
+  }
+  assignability_map_[key] = assignable;
+}
+
+void TypeLookupService::clear_assignable_i()
+{
+  assignability_map_.clear();
+  ++assignability_generation_;
+}
+
 bool TypeLookupService::get_minimal_type_identifier(const TypeIdentifier& ct, TypeIdentifier& mt) const
 {
   if (ct.kind() == TK_NONE || is_fully_descriptive(ct)) {
@@ -77,6 +77,31 @@ public:
   void clear_type_info(const DDS::BuiltinTopicKey_t& key);
   const TypeInformation& get_type_info(const DDS::BuiltinTopicKey_t& key) const;
 
+  /// For memoizing TypeAssignability results of reader and writer TypeInformation.
+  /// The results are forgotten when type objects or type identifier mappings
+  /// are added, since those can change them.
+  ///@{
+  struct OpenDDS_Dcps_Export AssignabilityKey {
+    AssignabilityKey(const TypeInformation& reader,
+                     const TypeInformation& writer,
+                     ACE_CDR::Octet consistency);
+
+    bool operator<(const AssignabilityKey& other) const;
+
+    TypeIdentifier reader_minimal;
+    TypeIdentifier reader_complete;
+    TypeIdentifier writer_minimal;
+    TypeIdentifier writer_complete;
+    /// TypeConsistencyAttributes as bit flags
+    ACE_CDR::Octet consistency;
+  };
+
+  /// Returns true and sets assignable if key is cached. Otherwise sets
+  /// generation to pass to cache_assignable once the result is known.
+  bool get_assignable(const AssignabilityKey& key, bool& assignable, ACE_UINT64& generation) const;
+  void cache_assignable(const AssignabilityKey& key, bool assignable, ACE_UINT64 generation);
+  ///@}
+
 private:
   const TypeObject& get_type_object_i(const TypeIdentifier& type_id) const;
   void get_type_dependencies_i(const TypeIdentifierSeq& type_ids,
@@ -124,6 +149,15 @@ private:
                           DCPS::BuiltinTopicKey_tKeyLessThan) TypeInformationMap;
   TypeInformationMap type_info_map_;
   TypeInformation type_info_empty_;
+
+  void clear_assignable_i();
+
+  typedef OPENDDS_MAP(AssignabilityKey, bool) AssignabilityMap;
+  AssignabilityMap assignability_map_;
+  /// Incremented by clear_assignable_i so results computed before a new type
+  /// was added aren't cached.
+  ACE_UINT64 assignability_generation_;
+  static const size_t MAX_ASSIGNABILITY_MAP_SIZE = 1024;
 };
 
 typedef DCPS::RcHandle<TypeLookupService> TypeLookupService_rch;
@@ -73,6 +73,7 @@ TransportSendStrategy::TransportSendStrategy(
     max_header_size_(0),
     header_block_(0),
     pkt_chain_(0),
+    current_send_packet_(0),
     header_complete_(false),
     start_counter_(0),
     mode_(MODE_DIRECT),
@@ -1788,7 +1789,13 @@ TransportSendStrategy::do_send_packet(const ACE_Message_Block* packet, int& bp)
   VDBG_LVL((LM_DEBUG, "(%P|%t) DBG:   "
             "Attempt to send_bytes() now.\n"), 5);
 
+#if OPENDDS_CONFIG_SECURITY
+  current_send_packet_ = substitute ? substitute.get() : packet;
+#else
+  current_send_packet_ = packet;
+#endif
   const ssize_t num_bytes_sent = send_bytes(iov, num_blocks, bp);
+  current_send_packet_ = 0;
 
   VDBG_LVL((LM_DEBUG, "(%P|%t) DBG:   "
             "The send_bytes() said that num_bytes_sent == [%d].\n",
@@ -201,6 +201,11 @@ protected:
 
   TransportQueueElement* current_packet_first_element() const;
 
+  /// The packet whose bytes are being passed to send_bytes_i(), or 0 when
+  /// send_bytes_i() was called from elsewhere.  A subclass that sends the
+  /// bytes after send_bytes_i() returns can duplicate() it to keep them.
+  const ACE_Message_Block* current_send_packet() const;
+
   /// The maximum size of a message allowed by the this TransportImpl, or 0
   /// if there is no such limit.  This is expected to be a constant, for example
   /// UDP/IPv4 can send messages of up to 65466 bytes.
@@ -383,6 +388,9 @@ private:
   /// current transport packet.
   ACE_Message_Block* pkt_chain_;
 
+  /// See current_send_packet().
+  const ACE_Message_Block* current_send_packet_;
+
   /// Set to false when the packet header hasn't been fully sent.
   /// Set to true once the packet header has been fully sent.
   bool header_complete_;
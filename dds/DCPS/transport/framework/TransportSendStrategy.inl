@@ -155,6 +155,12 @@ TransportQueueElement* TransportSendStrategy::current_packet_first_element() con
   return this->elems_.peek();
 }
 
+ACE_INLINE
+const ACE_Message_Block* TransportSendStrategy::current_send_packet() const
+{
+  return current_send_packet_;
+}
+
 } // namespace DCPS
 } // namespace OpenDDS
 
@@ -408,6 +408,34 @@ RtpsUdpDataLink::open(const ACE_SOCK_Dgram& unicast_socket
 #endif
   }
 
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  // The receive strategy splits coalesced datagrams using the segment size
+  // reported with each read.  The ICE receive path doesn't read it.
+  if (cfg->use_udp_gro() && !cfg->use_ice()) {
+    int gro = 1;
+    if (unicast_socket_.set_option(SOL_UDP, UDP_GRO, &gro, sizeof gro) < 0) {
+      if (log_level >= LogLevel::Notice) {
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: RtpsUdpDataLink::open: "
+                   "failed to enable UDP_GRO: %m\n"));
+      }
+    }
+#ifdef ACE_HAS_IPV6
+    if (ipv6_unicast_socket_.set_option(SOL_UDP, UDP_GRO, &gro, sizeof gro) < 0) {
+      if (log_level >= LogLevel::Notice) {
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: RtpsUdpDataLink::open: "
+                   "failed to enable UDP_GRO on the IPv6 socket: %m\n"));
+      }
+    }
+#endif
+  }
+#endif
+
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  if (cfg->receive_shards() > 1 && !cfg->use_ice()) {
+    open_receive_shards(cfg);
+  }
+#endif
+
   send_strategy()->send_buffer(&multi_buff_);
 
   if (start(send_strategy_,
@@ -421,11 +449,96 @@ RtpsUdpDataLink::open(const ACE_SOCK_Dgram& unicast_socket
     return false;
   }
 
+  for (ReceiveShards::iterator it = receive_shards_.begin(); it != receive_shards_.end(); ++it) {
+    it->strategy_->start();
+  }
+
   TheServiceParticipant->network_interface_address_topic()->connect(network_interface_address_reader_);
 
   return true;
 }
 
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+bool
+RtpsUdpDataLink::open_reuseport_socket(ACE_SOCK_Dgram& sock, const ACE_INET_Addr& addr)
+{
+  const ACE_HANDLE handle = ACE_OS::socket(addr.get_type(), SOCK_DGRAM, 0);
+  if (handle == ACE_INVALID_HANDLE) {
+    return false;
+  }
+  sock.set_handle(handle);
+
+  if (!set_sock_opt(sock, SOL_SOCKET, SO_REUSEPORT, 1) ||
+      ACE_OS::bind(handle, static_cast<sockaddr*>(addr.get_addr()), addr.get_size()) != 0) {
+    sock.close();
+    return false;
+  }
+  return true;
+}
+
+bool
+RtpsUdpDataLink::open_first_reuseport_socket(ACE_SOCK_Dgram& sock, const ACE_INET_Addr& addr)
+{
+  // A socket with SO_REUSEPORT can join a port other sockets of the same user
+  // bound with SO_REUSEPORT, the probe can't.
+  ACE_SOCK_Dgram probe;
+  if (probe.open(addr, addr.get_type()) != 0) {
+    return false;
+  }
+  ACE_INET_Addr probed;
+  const bool have_addr = probe.get_local_addr(probed) == 0;
+  probe.close();
+  return have_addr && open_reuseport_socket(sock, probed);
+}
+
+void
+RtpsUdpDataLink::open_receive_shards(const RtpsUdpInst_rch& cfg)
+{
+  ACE_INET_Addr addr;
+  if (unicast_socket_.get_local_addr(addr) != 0) {
+    return;
+  }
+
+  // unicast_socket_ is the first shard.
+  const size_t count = cfg->receive_shards() - 1;
+  for (size_t i = 0; i < count; ++i) {
+    ReceiveShard shard;
+    if (!open_reuseport_socket(shard.socket_, addr)) {
+      if (log_level >= LogLevel::Notice) {
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: RtpsUdpDataLink::open_receive_shards: "
+                   "failed to open receive shard %u for %C: %m\n",
+                   unsigned(i + 1), LogAddr(addr).c_str()));
+      }
+      return;
+    }
+
+    if (cfg->rcv_buffer_size() > 0) {
+      set_sock_opt(shard.socket_, SOL_SOCKET, SO_RCVBUF, int(cfg->rcv_buffer_size()), true);
+    }
+    set_recvpktinfo(shard.socket_, true);
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    if (cfg->use_udp_gro()) {
+      set_sock_opt(shard.socket_, SOL_UDP, UDP_GRO, 1);
+    }
+#endif
+
+    shard.reactor_task_ = make_rch<ReactorTask>(false);
+    shard.reactor_task_->job_queue(job_queue_);
+    if (shard.reactor_task_->open_reactor_task(&TheServiceParticipant->get_thread_status_manager(),
+                                               "RtpsUdpReceiveShard " + to_dds_string(unsigned(i + 1))) != 0) {
+      shard.socket_.close();
+      return;
+    }
+
+    shard.strategy_ = make_rch<RtpsUdpReceiveStrategy>(this, local_prefix_,
+                                                       ref(TheServiceParticipant->get_thread_status_manager()),
+                                                       receive_strategy().get(),
+                                                       shard.socket_, shard.reactor_task_);
+    receive_shards_.push_back(shard);
+  }
+}
+#endif
+
 void RtpsUdpDataLink::on_data_available(RcHandle<InternalDataReader<NetworkInterfaceAddress> >)
 {
   const RtpsUdpTransport_rch tport = transport();
@@ -1025,6 +1138,11 @@ RtpsUdpDataLink::stop_i()
 
   heartbeat_->disable();
   heartbeatchecker_->disable();
+  for (ReceiveShards::iterator it = receive_shards_.begin(); it != receive_shards_.end(); ++it) {
+    it->strategy_->stop();
+    it->reactor_task_->stop();
+    it->socket_.close();
+  }
   unicast_socket_.close();
   multicast_socket_.close();
 #ifdef ACE_HAS_IPV6
@@ -2862,6 +2980,8 @@ RtpsUdpDataLink::bundle_and_send_submessages(MetaSubmessageVec& meta_submessages
   }
 
   // Allocate buffers, seralize, and send bundles
+  RtpsUdpSendStrategy_rch ss = send_strategy();
+  RtpsUdpSendStrategy::ControlBatch batch;
   GUID_t prev_dst; // used to determine when we need to write a new info_dst
   for (size_t i = 0; i < bundles.size(); ++i) {
     RTPS::Message rtps_message;
@@ -2944,11 +3064,13 @@ RtpsUdpDataLink::bundle_and_send_submessages(MetaSubmessageVec& meta_submessages
       }
       prev_dst = dst;
     }
-    RtpsUdpSendStrategy_rch ss = send_strategy();
     if (ss) {
-      ss->send_rtps_control(rtps_message, *(mb_bundle.get()), bundles[i].proxy_.addrs());
+      ss->send_rtps_control(rtps_message, *(mb_bundle.get()), bundles[i].proxy_.addrs(), batch);
     }
   }
+  if (ss) {
+    ss->send_control_batch(batch);
+  }
 }
 
 void
@@ -4683,7 +4805,16 @@ RtpsUdpDataLink::send_strategy() const
 RtpsUdpReceiveStrategy_rch
 RtpsUdpDataLink::receive_strategy() const
 {
-  return dynamic_rchandle_cast<RtpsUdpReceiveStrategy>(receive_strategy_);
+  RtpsUdpReceiveStrategy_rch primary = dynamic_rchandle_cast<RtpsUdpReceiveStrategy>(receive_strategy_);
+  if (primary) {
+    // Submessage handlers call back into the strategy that is receiving.
+    for (ReceiveShards::const_iterator it = receive_shards_.begin(); it != receive_shards_.end(); ++it) {
+      if (it->strategy_->is_shard_thread()) {
+        return it->strategy_;
+      }
+    }
+  }
+  return primary;
 }
 
 NetworkAddressSet
@@ -5029,9 +5160,14 @@ void RtpsUdpDataLink::fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const
   if (send) {
     send->fill_stats(stats, idx);
   }
-  const RtpsUdpReceiveStrategy_rch recv = receive_strategy();
+  // Not receive_strategy(), which is a shard's strategy on its thread.
+  const RtpsUdpReceiveStrategy_rch recv = dynamic_rchandle_cast<RtpsUdpReceiveStrategy>(receive_strategy_);
   if (recv) {
+    const DDS::UInt32 recv_idx = idx;
     recv->fill_stats(stats, idx);
+    for (ReceiveShards::const_iterator it = receive_shards_.begin(); it != receive_shards_.end(); ++it) {
+      it->strategy_->add_shard_stats(stats, recv_idx);
+    }
   }
 }
 
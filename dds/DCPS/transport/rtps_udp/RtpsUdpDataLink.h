@@ -128,6 +128,17 @@ public:
 #endif
             );
 
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  /// Open sock bound to addr with SO_REUSEPORT set.
+  static bool open_reuseport_socket(ACE_SOCK_Dgram& sock, const ACE_INET_Addr& addr);
+
+  /// Open the first of the sockets sharing addr's port with SO_REUSEPORT.
+  /// The port is probed with a socket that doesn't set SO_REUSEPORT, so this
+  /// fails if anything is already bound to it.  If addr's port is 0, the port
+  /// given to the probe is used.
+  static bool open_first_reuseport_socket(ACE_SOCK_Dgram& sock, const ACE_INET_Addr& addr);
+#endif
+
   void received(const RTPS::DataSubmessage& data,
                 const GuidPrefix_t& src_prefix,
                 const NetworkAddress& remote_addr);
@@ -331,6 +342,20 @@ private:
   ACE_SOCK_Dgram_Mcast ipv6_multicast_socket_;
 #endif
 
+  /// Additional IPv4 unicast sockets sharing unicast_socket_'s port, see
+  /// RtpsUdpInst::receive_shards().  Only modified by open().
+  struct ReceiveShard {
+    ACE_SOCK_Dgram socket_;
+    ReactorTask_rch reactor_task_;
+    RtpsUdpReceiveStrategy_rch strategy_;
+  };
+  typedef OPENDDS_VECTOR(ReceiveShard) ReceiveShards;
+  ReceiveShards receive_shards_;
+
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  void open_receive_shards(const RtpsUdpInst_rch& cfg);
+#endif
+
   MessageBlockAllocator mb_allocator_;
   DataBlockAllocator db_allocator_;
   Dynamic_Cached_Allocator_With_Overflow<ACE_Thread_Mutex> custom_allocator_;
@@ -41,9 +41,23 @@ RtpsUdpInst::RtpsUdpInst(const OPENDDS_STRING& name,
   , receive_address_duration_(*this, &RtpsUdpInst::receive_address_duration, &RtpsUdpInst::receive_address_duration)
   , responsive_mode_(*this, &RtpsUdpInst::responsive_mode, &RtpsUdpInst::responsive_mode)
   , send_delay_(*this, &RtpsUdpInst::send_delay, &RtpsUdpInst::send_delay)
+  , receive_batch_size_(*this, &RtpsUdpInst::receive_batch_size, &RtpsUdpInst::receive_batch_size)
+  , send_batch_size_(*this, &RtpsUdpInst::send_batch_size, &RtpsUdpInst::send_batch_size)
+  , use_udp_gso_(*this, &RtpsUdpInst::use_udp_gso, &RtpsUdpInst::use_udp_gso)
+  , use_udp_gro_(*this, &RtpsUdpInst::use_udp_gro, &RtpsUdpInst::use_udp_gro)
+  , busy_poll_idle_(*this, &RtpsUdpInst::busy_poll_idle, &RtpsUdpInst::busy_poll_idle)
+  , receive_shards_(*this, &RtpsUdpInst::receive_shards, &RtpsUdpInst::receive_shards)
   , opendds_discovery_guid_(GUID_UNKNOWN)
 {}
 
+RtpsUdpConfigSnapshot::RtpsUdpConfigSnapshot(const RtpsUdpInst& inst)
+  : use_multicast_(inst.use_multicast())
+  , send_delay_(inst.send_delay())
+  , heartbeat_period_(inst.heartbeat_period())
+  , nak_response_delay_(inst.nak_response_delay())
+  , receive_address_duration_(inst.receive_address_duration())
+{}
+
 void
 RtpsUdpInst::send_buffer_size(ACE_INT32 sbs)
 {
@@ -230,6 +244,83 @@ RtpsUdpInst::send_delay() const
                                                     ConfigStoreImpl::Format_IntegerMilliseconds);
 }
 
+void
+RtpsUdpInst::receive_batch_size(size_t rbs)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("RECEIVE_BATCH_SIZE").c_str(), static_cast<DDS::UInt32>(rbs));
+}
+
+size_t
+RtpsUdpInst::receive_batch_size() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("RECEIVE_BATCH_SIZE").c_str(), 1);
+}
+
+void
+RtpsUdpInst::send_batch_size(size_t sbs)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("SEND_BATCH_SIZE").c_str(), static_cast<DDS::UInt32>(sbs));
+}
+
+size_t
+RtpsUdpInst::send_batch_size() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("SEND_BATCH_SIZE").c_str(), 1);
+}
+
+void
+RtpsUdpInst::use_udp_gso(bool flag)
+{
+  TheServiceParticipant->config_store()->set_boolean(config_key("USE_UDP_GSO").c_str(), flag);
+}
+
+bool
+RtpsUdpInst::use_udp_gso() const
+{
+  return TheServiceParticipant->config_store()->get_boolean(config_key("USE_UDP_GSO").c_str(), false);
+}
+
+void
+RtpsUdpInst::use_udp_gro(bool flag)
+{
+  TheServiceParticipant->config_store()->set_boolean(config_key("USE_UDP_GRO").c_str(), flag);
+}
+
+bool
+RtpsUdpInst::use_udp_gro() const
+{
+  return TheServiceParticipant->config_store()->get_boolean(config_key("USE_UDP_GRO").c_str(), false);
+}
+
+void
+RtpsUdpInst::busy_poll_idle(const TimeDuration& bpi)
+{
+  TheServiceParticipant->config_store()->set(config_key("BUSY_POLL_IDLE").c_str(),
+                                             bpi,
+                                             ConfigStoreImpl::Format_FractionalSeconds);
+}
+
+TimeDuration
+RtpsUdpInst::busy_poll_idle() const
+{
+  return TheServiceParticipant->config_store()->get(config_key("BUSY_POLL_IDLE").c_str(),
+                                                    TimeDuration::zero_value,
+                                                    ConfigStoreImpl::Format_FractionalSeconds);
+}
+
+void
+RtpsUdpInst::receive_shards(size_t rs)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("RECEIVE_SHARDS").c_str(),
+                                                    static_cast<DDS::UInt32>(rs));
+}
+
+size_t
+RtpsUdpInst::receive_shards() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("RECEIVE_SHARDS").c_str(), 1);
+}
+
 RTPS::PortMode RtpsUdpInst::port_mode() const
 {
   return get_port_mode(config_key("PORT_MODE"), RTPS::PortMode_System);
@@ -640,6 +731,12 @@ RtpsUdpInst::dump_to_str(DDS::DomainId_t domain) const
   ret += formatNameForDump("nak_response_delay") + nak_response_delay().str() + '\n';
   ret += formatNameForDump("heartbeat_period") + heartbeat_period().str() + '\n';
   ret += formatNameForDump("responsive_mode") + (responsive_mode() ? "true" : "false") + '\n';
+  ret += formatNameForDump("receive_batch_size") + to_dds_string(unsigned(receive_batch_size())) + '\n';
+  ret += formatNameForDump("send_batch_size") + to_dds_string(unsigned(send_batch_size())) + '\n';
+  ret += formatNameForDump("use_udp_gso") + (use_udp_gso() ? "true" : "false") + '\n';
+  ret += formatNameForDump("use_udp_gro") + (use_udp_gro() ? "true" : "false") + '\n';
+  ret += formatNameForDump("busy_poll_idle") + busy_poll_idle().str() + '\n';
+  ret += formatNameForDump("receive_shards") + to_dds_string(unsigned(receive_shards())) + '\n';
   ret += formatNameForDump("multicast_group_address") + LogAddr(multicast_group_address(domain)).str() + '\n';
   ret += formatNameForDump("local_address") + LogAddr(local_address()).str() + '\n';
   ret += formatNameForDump("advertised_address") + LogAddr(advertised_address()).str() + '\n';
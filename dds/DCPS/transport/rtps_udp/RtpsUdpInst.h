@@ -15,6 +15,28 @@
 #include <dds/DCPS/RTPS/MessageUtils.h>
 #include <dds/DCPS/transport/framework/TransportInst.h>
 
+#if (defined ACE_LINUX || defined ACE_ANDROID) && !defined ACE_LACKS_SENDMSG
+#  define OPENDDS_RTPS_UDP_HAS_MMSG 1
+#else
+#  define OPENDDS_RTPS_UDP_HAS_MMSG 0
+#endif
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+#  include <netinet/udp.h>
+#  if defined UDP_SEGMENT && defined UDP_GRO
+#    define OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD 1
+#  endif
+#endif
+#ifndef OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+#  define OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD 0
+#endif
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG && defined SO_REUSEPORT
+#  define OPENDDS_RTPS_UDP_HAS_REUSEPORT 1
+#else
+#  define OPENDDS_RTPS_UDP_HAS_REUSEPORT 0
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -85,6 +107,47 @@ public:
   void send_delay(const TimeDuration& sd);
   TimeDuration send_delay() const;
 
+  /// Maximum number of datagrams read from a socket per reactor
+  /// notification.  Values greater than 1 enable batched receive on
+  /// platforms that support it (see OPENDDS_RTPS_UDP_HAS_MMSG).
+  ConfigValue<RtpsUdpInst, size_t> receive_batch_size_;
+  void receive_batch_size(size_t rbs);
+  size_t receive_batch_size() const;
+
+  /// Maximum number of RTPS messages handed to the socket in one call when
+  /// sending the bundles produced by a flush of the send queue.  Values
+  /// greater than 1 enable batched send where supported.
+  ConfigValue<RtpsUdpInst, size_t> send_batch_size_;
+  void send_batch_size(size_t sbs);
+  size_t send_batch_size() const;
+
+  /// Hand consecutive, equally sized DATA_FRAG datagrams of one sample to the
+  /// kernel as a single UDP segmentation offload (GSO) send.  Only has an
+  /// effect where OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD is set.
+  ConfigValue<RtpsUdpInst, bool> use_udp_gso_;
+  void use_udp_gso(bool flag);
+  bool use_udp_gso() const;
+
+  /// Enable UDP receive offload (GRO) on the unicast sockets so the kernel
+  /// can deliver several datagrams from the same peer in one read.
+  ConfigValue<RtpsUdpInst, bool> use_udp_gro_;
+  void use_udp_gro(bool flag);
+  bool use_udp_gro() const;
+
+  /// When nonzero, a dedicated thread polls the unicast sockets instead of
+  /// the reactor.  After this long without receiving anything it hands the
+  /// sockets back to the reactor until the next datagram arrives.
+  ConfigValueRef<RtpsUdpInst, TimeDuration> busy_poll_idle_;
+  void busy_poll_idle(const TimeDuration& bpi);
+  TimeDuration busy_poll_idle() const;
+
+  /// Number of IPv4 unicast sockets bound to the same port with SO_REUSEPORT,
+  /// each read by its own reactor thread.  Only has an effect where
+  /// OPENDDS_RTPS_UDP_HAS_REUSEPORT is set and ICE is not in use.
+  ConfigValue<RtpsUdpInst, size_t> receive_shards_;
+  void receive_shards(size_t rs);
+  size_t receive_shards() const;
+
   /// Diagnostic aid.
   virtual OPENDDS_STRING dump_to_str(DDS::DomainId_t domain) const;
 
@@ -200,6 +263,21 @@ private:
   GUID_t opendds_discovery_guid_;
 };
 
+/// Typed, immutable copy of the RtpsUdpInst settings that are read while
+/// associating and on the heartbeat and nack paths.  RtpsUdpCore holds the
+/// current one and replaces it when the configuration changes, so readers
+/// don't build config keys or search the ConfigStore.
+struct OpenDDS_Rtps_Udp_Export RtpsUdpConfigSnapshot : public virtual RcObject {
+  explicit RtpsUdpConfigSnapshot(const RtpsUdpInst& inst);
+
+  const bool use_multicast_;
+  const TimeDuration send_delay_;
+  const TimeDuration heartbeat_period_;
+  const TimeDuration nak_response_delay_;
+  const TimeDuration receive_address_duration_;
+};
+typedef RcHandle<RtpsUdpConfigSnapshot> RtpsUdpConfigSnapshot_rch;
+
 } // namespace DCPS
 } // namespace OpenDDS
 
@@ -15,15 +15,18 @@
 
 #include <dds/DCPS/GuidUtils.h>
 #include <dds/DCPS/LogAddr.h>
+#include <dds/DCPS/Logging.h>
 #include <dds/DCPS/Util.h>
 
 #include "dds/DCPS/transport/framework/TransportDebug.h"
 
 #include <dds/OpenDDSConfigWrapper.h>
 
+#include "ace/ACE.h"
 #include "ace/Reactor.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 
 
@@ -32,18 +35,72 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+namespace {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  const size_t GRO_CONTROL_SIZE = CMSG_SPACE(sizeof(int));
+#else
+  const size_t GRO_CONTROL_SIZE = 0;
+#endif
+
+  bool use_udp_gro(const RtpsUdpInst& config)
+  {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    // The ICE receive path doesn't read ancillary data, see RtpsUdpDataLink::open.
+    return config.use_udp_gro() && !config.use_ice();
+#else
+    ACE_UNUSED_ARG(config);
+    return false;
+#endif
+  }
+
+  /// Size of each datagram the kernel coalesced into "msg", or "length" if
+  /// it wasn't a GRO receive.
+  size_t gro_segment_size(const msghdr& msg, size_t length)
+  {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    if (msg.msg_control) {
+      for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          int segment = 0;
+          std::memcpy(&segment, CMSG_DATA(cmsg), std::min(sizeof segment, size_t(cmsg->cmsg_len - CMSG_LEN(0))));
+          return segment > 0 ? std::min(static_cast<size_t>(segment), length) : length;
+        }
+      }
+    }
+#else
+    ACE_UNUSED_ARG(msg);
+#endif
+    return length;
+  }
+}
+#endif
+
 RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link,
                                                const GuidPrefix_t& local_prefix,
-                                               ThreadStatusManager& thread_status_manager)
+                                               ThreadStatusManager& thread_status_manager,
+                                               RtpsUdpReceiveStrategy* primary,
+                                               const ACE_SOCK_Dgram& shard_socket,
+                                               const ReactorTask_rch& shard_reactor_task)
   : BaseReceiveStrategy(link->config(), BUFFER_COUNT)
+  , shard_socket_(shard_socket)
+  , shard_reactor_task_(shard_reactor_task)
+  , shard_thread_(ACE_thread_t())
   , link_(link)
   , last_received_()
   , recvd_sample_(0)
   , fragment_size_(0)
   , total_frags_(0)
-  , reassembly_(link->config()->fragment_reassembly_timeout())
+  , owned_reassembly_(primary ? 0 : new TransportReassembly(link->config()->fragment_reassembly_timeout()))
+  , reassembly_(primary ? primary->reassembly_ : *owned_reassembly_)
   , receiver_(local_prefix)
   , thread_status_manager_(thread_status_manager)
+  , batches_received_(0)
+  , batch_datagrams_received_(0)
+  , batches_full_(0)
+  , batch_max_datagrams_(0)
+  , gro_buffers_received_(0)
+  , gro_segments_received_(0)
 #if OPENDDS_CONFIG_SECURITY
   , secure_sample_()
   , encoded_rtps_(false)
@@ -54,34 +111,121 @@ RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link,
   const size_t INDEX = 0;
 
   if (receive_buffers_[INDEX] == 0) {
-    ACE_NEW_MALLOC(
-      receive_buffers_[INDEX],
-      (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
-      ACE_Message_Block(
-        RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
-        ACE_Message_Block::MB_DATA,         // Default
-        0,                                  // Start with no continuation
-        0,                                  // Let the constructor allocate
-        &data_allocator_,                   // Our buffer cache
-        &receive_lock_,                     // Our locking strategy
-        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
-        ACE_Time_Value::zero,               // Default
-        ACE_Time_Value::max_time,           // Default
-        &db_allocator_,                     // Our data block cache
-        &mb_allocator_                      // Our message block cache
-      ));
+    receive_buffers_[INDEX] = make_receive_buffer();
+  }
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  const size_t batch_size = std::min(link->config()->receive_batch_size(), MAX_RECEIVE_BATCH_SIZE);
+  // GRO delivers the segment size as ancillary data, which only the
+  // recvmmsg path reads, so it uses a ring of (at least) one slot.
+  const bool gro = use_udp_gro(*link->config());
+  if (batch_size > 1 || gro) {
+    const size_t slots = std::max(batch_size, size_t(1));
+    batch_buffers_.resize(slots, 0);
+    for (size_t i = 0; i < slots; ++i) {
+      batch_buffers_[i] = make_receive_buffer();
+    }
+    batch_msgs_.resize(slots);
+    batch_iov_.resize(slots);
+    batch_addrs_.resize(slots);
+    if (gro) {
+      batch_control_.resize(slots * GRO_CONTROL_SIZE);
+    }
   }
+#endif
 
 #if OPENDDS_CONFIG_SECURITY
   secure_prefix_.smHeader.submessageId = SUBMESSAGE_NONE;
 #endif
 }
 
+RtpsUdpReceiveStrategy::~RtpsUdpReceiveStrategy()
+{
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  for (size_t i = 0; i < batch_buffers_.size(); ++i) {
+    if (batch_buffers_[i]) {
+      ACE_DES_FREE(
+        batch_buffers_[i],
+        mb_allocator_.free,
+        ACE_Message_Block);
+    }
+  }
+#endif
+}
+
+ACE_Message_Block*
+RtpsUdpReceiveStrategy::make_receive_buffer()
+{
+  ACE_Message_Block* buffer = 0;
+  ACE_NEW_MALLOC_RETURN(
+    buffer,
+    (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
+    ACE_Message_Block(
+      RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
+      ACE_Message_Block::MB_DATA,         // Default
+      0,                                  // Start with no continuation
+      0,                                  // Let the constructor allocate
+      &data_allocator_,                   // Our buffer cache
+      &receive_lock_,                     // Our locking strategy
+      ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
+      ACE_Time_Value::zero,               // Default
+      ACE_Time_Value::max_time,           // Default
+      &db_allocator_,                     // Our data block cache
+      &mb_allocator_                      // Our message block cache
+    ),
+    0);
+  return buffer;
+}
+
+void
+RtpsUdpReceiveStrategy::replace_if_shared(ACE_Message_Block*& buffer)
+{
+  // If the buffer's data block is still referenced by a sample (for example
+  // held for reassembly), we'll need to allocate a new one for the next read
+  if (buffer->data_block()->reference_count() > 1) {
+
+    VDBG_LVL((LM_DEBUG, "(%P|%t) DBG: RtpsUdpReceiveStrategy::replace_if_shared: reallocating receive buffer based on reference count\n"), 5);
+
+    ACE_DES_FREE(
+      buffer,
+      mb_allocator_.free,
+      ACE_Message_Block);
+
+    buffer = make_receive_buffer();
+  }
+}
+
 int
 RtpsUdpReceiveStrategy::handle_input(ACE_HANDLE fd)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(input_mutex_);
+  if (is_shard()) {
+    shard_thread_ = ACE_Thread::self();
+  }
+  const int result = handle_input_i(fd);
+  if (result == -1 && busy_poll_task_ && is_unicast_handle(fd)) {
+    // The reactor removes fd, don't poll it either.
+    failed_handles_.insert(fd);
+    return result;
+  }
+  if (busy_poll_task_ && is_unicast_handle(fd) && busy_poll_task_->resume_polling()) {
+    remove_unicast_handlers(ACE_Event_Handler::READ_MASK | ACE_Event_Handler::DONT_CALL);
+    return 0;
+  }
+  return result;
+}
+
+int
+RtpsUdpReceiveStrategy::handle_input_i(ACE_HANDLE fd)
 {
   ThreadStatusManager::Event ev(thread_status_manager_);
 
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  if (use_batch_receive()) {
+    return handle_input_batch(fd);
+  }
+#endif
+
   // Since BUFFER_COUNT is 1, the index will always be 0
   const size_t INDEX = 0;
 
@@ -118,10 +262,6 @@ RtpsUdpReceiveStrategy::handle_input(ACE_HANDLE fd)
     return -1;
   }
 
-  ACE_UINT32 bytes_remaining_unsigned = static_cast<ACE_UINT32>(bytes_remaining);
-
-  cur_rb->wr_ptr(bytes_remaining_unsigned);
-
   if (bytes_remaining == 0) {
     if (gracefully_disconnected_) {
       return -1;
@@ -131,97 +271,203 @@ RtpsUdpReceiveStrategy::handle_input(ACE_HANDLE fd)
     }
   }
 
+  process_datagram(*cur_rb, static_cast<ACE_UINT32>(bytes_remaining), remote_address);
+
+  replace_if_shared(receive_buffers_[INDEX]);
+  return receive_buffers_[INDEX] ? 0 : -1;
+}
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+bool
+RtpsUdpReceiveStrategy::use_batch_receive() const
+{
+  if (batch_buffers_.empty()) {
+    return false;
+  }
+#if OPENDDS_CONFIG_SECURITY
+  // ICE needs the local address of each STUN message, which is only
+  // available through the single-datagram receive path.
+  if (link_->get_ice_endpoint()) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+int
+RtpsUdpReceiveStrategy::handle_input_batch(ACE_HANDLE fd)
+{
+  const ACE_SOCK_Dgram& socket = choose_recv_socket(fd);
+  const size_t batch_size = batch_buffers_.size();
+
+  for (size_t i = 0; i < batch_size; ++i) {
+    ACE_Message_Block* const mb = batch_buffers_[i];
+    if (!mb) {
+      return -1;
+    }
+    mb->reset();
+    batch_iov_[i].iov_base = mb->wr_ptr();
+    batch_iov_[i].iov_len = mb->space();
+    std::memset(&batch_msgs_[i], 0, sizeof batch_msgs_[i]);
+    batch_msgs_[i].msg_hdr.msg_name = &batch_addrs_[i];
+    batch_msgs_[i].msg_hdr.msg_namelen = sizeof batch_addrs_[i];
+    batch_msgs_[i].msg_hdr.msg_iov = &batch_iov_[i];
+    batch_msgs_[i].msg_hdr.msg_iovlen = 1;
+    if (!batch_control_.empty()) {
+      batch_msgs_[i].msg_hdr.msg_control = &batch_control_[i * GRO_CONTROL_SIZE];
+      batch_msgs_[i].msg_hdr.msg_controllen = GRO_CONTROL_SIZE;
+    }
+  }
+
+  const int count = ::recvmmsg(socket.get_handle(), &batch_msgs_[0],
+                               static_cast<unsigned int>(batch_size), MSG_DONTWAIT, 0);
+  if (count < 0) {
+    if (errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR) {
+      return 0;
+    }
+    relink();
+    return -1;
+  }
+
+  const size_t received = static_cast<size_t>(count);
+  ++batches_received_;
+  batch_datagrams_received_ += received;
+  if (received == batch_size) {
+    ++batches_full_;
+  }
+  if (received > batch_max_datagrams_.load()) {
+    // Only the reactor thread updates the counters
+    batch_max_datagrams_ = received;
+  }
+
+  for (size_t i = 0; i < received; ++i) {
+    ACE_INET_Addr remote_address;
+    remote_address.set(reinterpret_cast<sockaddr_in*>(&batch_addrs_[i]),
+                       static_cast<int>(batch_msgs_[i].msg_hdr.msg_namelen));
+
+    process_batch_slot(i, batch_msgs_[i].msg_len, remote_address);
+
+    replace_if_shared(batch_buffers_[i]);
+    if (!batch_buffers_[i]) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+void
+RtpsUdpReceiveStrategy::process_batch_slot(size_t i, size_t length,
+                                           const ACE_INET_Addr& remote_address)
+{
+  ACE_Message_Block& mb = *batch_buffers_[i];
+  char* const start = mb.rd_ptr();
+  const size_t segment_size = gro_segment_size(batch_msgs_[i].msg_hdr, length);
+  if (segment_size < length) {
+    ++gro_buffers_received_;
+  }
+
+  // Empty datagrams yield a single empty segment
+  size_t offset = 0;
+  do {
+    const size_t segment_length = std::min(segment_size, length - offset);
+    if (segment_size < length) {
+      ++gro_segments_received_;
+    }
+
+    iovec iov;
+    iov.iov_base = start + offset;
+    iov.iov_len = segment_length;
+
+    bool stop = false;
+    ssize_t ret = handle_received_bytes(&iov, 1, static_cast<ssize_t>(segment_length),
+                                        ACE_INET_Addr(), remote_address,
+#if OPENDDS_CONFIG_SECURITY
+                                        link_->get_ice_agent(), link_->get_ice_endpoint(),
+#endif
+                                        *link_->transport(), stop);
+    ret = process_received(&iov, 1, ret, remote_address, stop);
+
+    // Empty datagrams and messages consumed during receive processing
+    // (STUN, dropped secure messages) are skipped.
+    if (!stop && ret > 0) {
+      mb.rd_ptr(start + offset);
+      mb.wr_ptr(start + offset);
+      process_datagram(mb, static_cast<ACE_UINT32>(ret), remote_address);
+    }
+
+    offset += segment_length;
+  } while (offset < length);
+}
+#endif
+
+void
+RtpsUdpReceiveStrategy::process_datagram(ACE_Message_Block& cur_rb,
+                                         ACE_UINT32 bytes,
+                                         const ACE_INET_Addr& remote_address)
+{
+  ACE_UINT32 bytes_remaining_unsigned = bytes;
+
+  cur_rb.wr_ptr(bytes_remaining_unsigned);
+
   if (!pdu_remaining_) {
     receive_transport_header_.length_ = bytes_remaining_unsigned;
   }
 
-  receive_transport_header_ = *cur_rb;
+  receive_transport_header_ = cur_rb;
   if (!receive_transport_header_.valid()) {
-    cur_rb->reset();
+    cur_rb.reset();
     if (DCPS_debug_level > 0) {
-      ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::handle_input: TransportHeader invalid.\n")));
+      ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: RtpsUdpReceiveStrategy::process_datagram: TransportHeader invalid.\n")));
     }
-    return 0;
+    return;
   }
 
   bytes_remaining_unsigned = static_cast<ACE_UINT32>(receive_transport_header_.length_);
   if (!check_header(receive_transport_header_)) {
-    return 0;
+    return;
   }
 
-  {
-    const ScopedHeaderProcessing shp(*this);
-    while (bytes_remaining_unsigned > 0) {
-      data_sample_header_.pdu_remaining(bytes_remaining_unsigned);
-      data_sample_header_ = *cur_rb;
-      if (!check_header(data_sample_header_)) {
-        return 0;
-      }
-      const ACE_UINT32 serialized_size = static_cast<ACE_UINT32>(data_sample_header_.get_serialized_size());
-      if (!RtpsSampleHeader::has_valid_cursor(*cur_rb) || serialized_size > bytes_remaining_unsigned) {
-        return 0;
-      }
-      bytes_remaining_unsigned -= serialized_size;
-      const ACE_UINT32 message_length = data_sample_header_.message_length();
-      if (message_length > bytes_remaining_unsigned) {
-        return 0;
-      }
-      ReceivedDataSample rds = data_sample_header_.message_length() ? ReceivedDataSample(*cur_rb) : ReceivedDataSample();
-      if (data_sample_header_.into_received_data_sample(rds)) {
-
-        if (data_sample_header_.more_fragments() || receive_transport_header_.last_fragment()) {
-          VDBG((LM_DEBUG,"(%P|%t) DBG:   Attempt reassembly of fragments\n"));
+  const ScopedHeaderProcessing shp(*this);
+  while (bytes_remaining_unsigned > 0) {
+    data_sample_header_.pdu_remaining(bytes_remaining_unsigned);
+    data_sample_header_ = cur_rb;
+    if (!check_header(data_sample_header_)) {
+      return;
+    }
+    const ACE_UINT32 serialized_size = static_cast<ACE_UINT32>(data_sample_header_.get_serialized_size());
+    if (!RtpsSampleHeader::has_valid_cursor(cur_rb) || serialized_size > bytes_remaining_unsigned) {
+      return;
+    }
+    bytes_remaining_unsigned -= serialized_size;
+    const ACE_UINT32 message_length = data_sample_header_.message_length();
+    if (message_length > bytes_remaining_unsigned) {
+      return;
+    }
+    ReceivedDataSample rds = data_sample_header_.message_length() ? ReceivedDataSample(cur_rb) : ReceivedDataSample();
+    if (data_sample_header_.into_received_data_sample(rds)) {
 
-          if (reassemble(rds)) {
-            VDBG((LM_DEBUG,"(%P|%t) DBG:   Reassembled complete message\n"));
-            deliver_sample(rds, remote_address);
-          }
-          // If reassemble() returned false, it takes ownership of the data
-          // just like deliver_sample() does.
+      if (data_sample_header_.more_fragments() || receive_transport_header_.last_fragment()) {
+        VDBG((LM_DEBUG,"(%P|%t) DBG:   Attempt reassembly of fragments\n"));
 
-        } else {
+        if (reassemble(rds)) {
+          VDBG((LM_DEBUG,"(%P|%t) DBG:   Reassembled complete message\n"));
           deliver_sample(rds, remote_address);
         }
-      }
-      cur_rb->rd_ptr(message_length);
-      bytes_remaining_unsigned -= message_length;
+        // If reassemble() returned false, it takes ownership of the data
+        // just like deliver_sample() does.
 
-      // For the reassembly algorithm, the 'last_fragment_' header bit only
-      // applies to the first DataSampleHeader in the TransportHeader
-      receive_transport_header_.last_fragment(false);
+      } else {
+        deliver_sample(rds, remote_address);
+      }
     }
-  }
-
-  // If newly selected buffer index still has a reference count, we'll need to allocate a new one for the read
-  if (receive_buffers_[INDEX]->data_block()->reference_count() > 1) {
-
-    VDBG_LVL((LM_DEBUG, "(%P|%t) DBG: RtpsUdpReceiveStrategy::handle_input: reallocating primary receive buffer based on reference count\n"), 5);
+    cur_rb.rd_ptr(message_length);
+    bytes_remaining_unsigned -= message_length;
 
-    ACE_DES_FREE(
-      receive_buffers_[INDEX],
-      mb_allocator_.free,
-      ACE_Message_Block);
-
-    ACE_NEW_MALLOC_RETURN(
-      receive_buffers_[INDEX],
-      (ACE_Message_Block*) mb_allocator_.malloc(sizeof(ACE_Message_Block)),
-      ACE_Message_Block(
-        RECEIVE_DATA_BUFFER_SIZE,           // Buffer size
-        ACE_Message_Block::MB_DATA,         // Default
-        0,                                  // Start with no continuation
-        0,                                  // Let the constructor allocate
-        &data_allocator_,                   // Our buffer cache
-        &receive_lock_,                     // Our locking strategy
-        ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY, // Default
-        ACE_Time_Value::zero,               // Default
-        ACE_Time_Value::max_time,           // Default
-        &db_allocator_,                     // Our data block cache
-        &mb_allocator_                      // Our message block cache
-      ),
-      -1);
+    // For the reassembly algorithm, the 'last_fragment_' header bit only
+    // applies to the first DataSampleHeader in the TransportHeader
+    receive_transport_header_.last_fragment(false);
   }
-
-  return 0;
 }
 
 ssize_t
@@ -247,8 +493,28 @@ RtpsUdpReceiveStrategy::receive_bytes_helper(iovec iov[],
     return ret;
   }
 
+  return handle_received_bytes(iov, n, ret, local_address, remote_address,
+#if OPENDDS_CONFIG_SECURITY
+                               ice_agent, endpoint,
+#endif
+                               tport, stop);
+}
+
+ssize_t
+RtpsUdpReceiveStrategy::handle_received_bytes(iovec iov[],
+                                              int n,
+                                              ssize_t ret,
+                                              const ACE_INET_Addr& local_address,
+                                              const ACE_INET_Addr& remote_address,
+#if OPENDDS_CONFIG_SECURITY
+                                              DCPS::RcHandle<ICE::Agent> ice_agent,
+                                              DCPS::WeakRcHandle<ICE::Endpoint> endpoint,
+#endif
+                                              RtpsUdpTransport& tport,
+                                              bool& stop)
+{
   if (remote_address.get_size() > remote_address.get_addr_size()) {
-    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: RtpsUdpReceiveStrategy::receive_bytes_helper - invalid address size\n"));
+    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: RtpsUdpReceiveStrategy::handle_received_bytes - invalid address size\n"));
     return 0;
   }
 
@@ -262,9 +528,10 @@ RtpsUdpReceiveStrategy::receive_bytes_helper(iovec iov[],
 #if OPENDDS_CONFIG_SECURITY
   // Assume STUN
 # ifndef ACE_RECVPKTINFO
-  ACE_ERROR((LM_ERROR, "ERROR: RtpsUdpReceiveStrategy::receive_bytes_helper potential STUN message "
+  ACE_ERROR((LM_ERROR, "ERROR: RtpsUdpReceiveStrategy::handle_received_bytes potential STUN message "
              "received but this version of the ACE library doesn't support the local_address "
              "extension in ACE_SOCK_Dgram::recv\n"));
+  ACE_UNUSED_ARG(local_address);
   ACE_UNUSED_ARG(stop);
   ACE_NOTSUP_RETURN(-1);
 # else
@@ -303,6 +570,7 @@ RtpsUdpReceiveStrategy::receive_bytes_helper(iovec iov[],
   head->release();
 # endif
 #else
+  ACE_UNUSED_ARG(local_address);
   ACE_UNUSED_ARG(stop);
 #endif
 
@@ -324,9 +592,18 @@ namespace {
 }
 #endif
 
+bool
+RtpsUdpReceiveStrategy::is_shard_thread() const
+{
+  return is_shard() && ACE_OS::thr_equal(shard_thread_.load(), ACE_Thread::self());
+}
+
 const ACE_SOCK_Dgram&
 RtpsUdpReceiveStrategy::choose_recv_socket(ACE_HANDLE fd) const
 {
+  if (is_shard()) {
+    return shard_socket_;
+  }
 #ifdef ACE_HAS_IPV6
   if (fd == link_->ipv6_multicast_socket().get_handle()) {
     return link_->ipv6_multicast_socket();
@@ -369,6 +646,16 @@ RtpsUdpReceiveStrategy::receive_bytes(iovec iov[],
 #endif
                                            *link_->transport(), stop);
 #endif
+  return process_received(iov, n, ret, remote_address, stop);
+}
+
+ssize_t
+RtpsUdpReceiveStrategy::process_received(iovec iov[],
+                                         int n,
+                                         ssize_t ret,
+                                         const ACE_INET_Addr& remote_address,
+                                         bool& stop)
+{
   remote_address_ = remote_address;
 
 #if OPENDDS_CONFIG_SECURITY
@@ -469,6 +756,10 @@ RtpsUdpReceiveStrategy::receive_bytes(iovec iov[],
     encoded_rtps_ = true;
     return static_cast<ssize_t>(plainLen);
   }
+#else
+  ACE_UNUSED_ARG(iov);
+  ACE_UNUSED_ARG(n);
+  ACE_UNUSED_ARG(stop);
 #endif
 
   return ret;
@@ -1001,14 +1292,37 @@ bool RtpsUdpReceiveStrategy::decode_payload(ReceivedDataSample& sample,
 }
 #endif
 
+ReactorTask_rch
+RtpsUdpReceiveStrategy::reactor_task() const
+{
+  return shard_reactor_task_ ? shard_reactor_task_ : link_->get_reactor_task();
+}
+
 int
 RtpsUdpReceiveStrategy::start_i()
 {
-  ReactorTask_rch ri = link_->get_reactor_task();
-  ri->execute_or_enqueue(make_rch<RegisterHandler>(link_->unicast_socket().get_handle(), this, static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
-#ifdef ACE_HAS_IPV6
-  ri->execute_or_enqueue(make_rch<RegisterHandler>(link_->ipv6_unicast_socket().get_handle(), this, static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
-#endif
+  if (is_shard()) {
+    // Shards always use their own reactor, busy polling applies to the
+    // primary sockets.
+    register_unicast_handlers();
+    return 0;
+  }
+
+  RtpsUdpInst_rch cfg = link_->config();
+  const TimeDuration busy_poll_idle = cfg ? cfg->busy_poll_idle() : TimeDuration::zero_value;
+  if (busy_poll_idle.is_zero()) {
+    register_unicast_handlers();
+  } else {
+    busy_poll_task_.reset(new BusyPollTask(*this, busy_poll_idle));
+    if (busy_poll_task_->activate() != 0) {
+      if (log_level >= LogLevel::Warning) {
+        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: RtpsUdpReceiveStrategy::start_i: "
+                   "failed to start busy-poll thread, using the reactor\n"));
+      }
+      busy_poll_task_.reset();
+      register_unicast_handlers();
+    }
+  }
 
   return 0;
 }
@@ -1016,12 +1330,19 @@ RtpsUdpReceiveStrategy::start_i()
 void
 RtpsUdpReceiveStrategy::stop_i()
 {
-  ReactorTask_rch ri = link_->get_reactor_task();
-  ri->execute_or_enqueue(make_rch<RemoveHandler>(link_->unicast_socket().get_handle(), static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
-#ifdef ACE_HAS_IPV6
-  ri->execute_or_enqueue(make_rch<RemoveHandler>(link_->ipv6_unicast_socket().get_handle(), static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
-#endif
+  if (busy_poll_task_) {
+    if (busy_poll_task_->stop()) {
+      remove_unicast_handlers(ACE_Event_Handler::READ_MASK);
+    }
+  } else {
+    remove_unicast_handlers(ACE_Event_Handler::READ_MASK);
+  }
+
+  if (is_shard()) {
+    return;
+  }
 
+  ReactorTask_rch ri = link_->get_reactor_task();
   RtpsUdpInst_rch cfg = link_->config();
   if (cfg && cfg->use_multicast()) {
     ri->execute_or_enqueue(make_rch<RemoveHandler>(link_->multicast_socket().get_handle(), static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
@@ -1031,6 +1352,160 @@ RtpsUdpReceiveStrategy::stop_i()
   }
 }
 
+void
+RtpsUdpReceiveStrategy::register_unicast_handlers()
+{
+  ReactorTask_rch ri = reactor_task();
+  if (is_shard()) {
+    ri->execute_or_enqueue(make_rch<RegisterHandler>(shard_socket_.get_handle(), this, static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
+    return;
+  }
+  const ACE_HANDLE unicast = link_->unicast_socket().get_handle();
+  if (!failed_handles_.count(unicast)) {
+    ri->execute_or_enqueue(make_rch<RegisterHandler>(unicast, this, static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
+  }
+#ifdef ACE_HAS_IPV6
+  const ACE_HANDLE ipv6_unicast = link_->ipv6_unicast_socket().get_handle();
+  if (!failed_handles_.count(ipv6_unicast)) {
+    ri->execute_or_enqueue(make_rch<RegisterHandler>(ipv6_unicast, this, static_cast<ACE_Reactor_Mask>(ACE_Event_Handler::READ_MASK)));
+  }
+#endif
+}
+
+void
+RtpsUdpReceiveStrategy::remove_unicast_handlers(ACE_Reactor_Mask mask)
+{
+  ReactorTask_rch ri = reactor_task();
+  if (is_shard()) {
+    ri->execute_or_enqueue(make_rch<RemoveHandler>(shard_socket_.get_handle(), mask));
+    return;
+  }
+  ri->execute_or_enqueue(make_rch<RemoveHandler>(link_->unicast_socket().get_handle(), mask));
+#ifdef ACE_HAS_IPV6
+  ri->execute_or_enqueue(make_rch<RemoveHandler>(link_->ipv6_unicast_socket().get_handle(), mask));
+#endif
+}
+
+bool
+RtpsUdpReceiveStrategy::is_unicast_handle(ACE_HANDLE fd) const
+{
+  if (is_shard()) {
+    return fd == shard_socket_.get_handle();
+  }
+#ifdef ACE_HAS_IPV6
+  if (fd == link_->ipv6_unicast_socket().get_handle()) {
+    return true;
+  }
+#endif
+  return fd == link_->unicast_socket().get_handle();
+}
+
+bool
+RtpsUdpReceiveStrategy::poll_unicast()
+{
+  ACE_HANDLE handles[] = {
+    link_->unicast_socket().get_handle(),
+#ifdef ACE_HAS_IPV6
+    link_->ipv6_unicast_socket().get_handle(),
+#endif
+  };
+
+  bool received = false;
+  for (size_t i = 0; i < sizeof handles / sizeof handles[0]; ++i) {
+    if (handles[i] == ACE_INVALID_HANDLE ||
+        ACE::handle_read_ready(handles[i], &ACE_Time_Value::zero) != 1) {
+      continue;
+    }
+    // Don't wait for the reactor thread, it is already receiving.
+    ACE_Guard<ACE_Thread_Mutex> guard(input_mutex_, 0);
+    if (!guard.locked() || failed_handles_.count(handles[i])) {
+      continue;
+    }
+    if (handle_input_i(handles[i]) == -1) {
+      // Same as the reactor removing the handler after handle_input
+      // returns -1.
+      failed_handles_.insert(handles[i]);
+      if (log_level >= LogLevel::Warning) {
+        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: RtpsUdpReceiveStrategy::poll_unicast: "
+                   "input failed, no longer polling the socket\n"));
+      }
+      continue;
+    }
+    received = true;
+  }
+  return received;
+}
+
+RtpsUdpReceiveStrategy::BusyPollTask::BusyPollTask(RtpsUdpReceiveStrategy& outer,
+                                                   const TimeDuration& idle)
+  : outer_(outer)
+  , idle_(idle)
+  , condition_(mutex_)
+  , stopped_(false)
+  , polling_(true)
+{
+}
+
+int
+RtpsUdpReceiveStrategy::BusyPollTask::svc()
+{
+  ThreadStatusManager::Start s(outer_.thread_status_manager_, "RtpsUdpBusyPoll");
+
+  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+  while (!stopped_) {
+    if (!polling_) {
+      condition_.wait(outer_.thread_status_manager_);
+      continue;
+    }
+
+    guard.release();
+    MonotonicTimePoint last_input = MonotonicTimePoint::now();
+    while (!stopped_) {
+      if (outer_.poll_unicast()) {
+        last_input = MonotonicTimePoint::now();
+      } else if (MonotonicTimePoint::now() - last_input >= idle_) {
+        break;
+      }
+    }
+    guard.acquire();
+
+    if (!stopped_) {
+      // Idle, let the reactor wait for the next datagram.
+      polling_ = false;
+      outer_.register_unicast_handlers();
+    }
+  }
+  return 0;
+}
+
+bool
+RtpsUdpReceiveStrategy::BusyPollTask::stop()
+{
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+    stopped_ = true;
+    condition_.notify_one();
+  }
+  {
+    ThreadStatusManager::Sleeper s(outer_.thread_status_manager_);
+    wait();
+  }
+  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+  return !polling_;
+}
+
+bool
+RtpsUdpReceiveStrategy::BusyPollTask::resume_polling()
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+  if (stopped_ || polling_) {
+    return false;
+  }
+  polling_ = true;
+  condition_.notify_one();
+  return true;
+}
+
 bool
 RtpsUdpReceiveStrategy::check_header(const RtpsTransportHeader& header)
 {
@@ -1429,7 +1904,7 @@ RtpsUdpReceiveStrategy::MessageReceiver::fill_header(
 
 StatisticSeq RtpsUdpReceiveStrategy::stats_template()
 {
-  static const DDS::UInt32 num_local_stats = 7;
+  static const DDS::UInt32 num_local_stats = 13;
   const StatisticSeq base = TransportReceiveStrategy::stats_template();
   StatisticSeq stats(base.length() + num_local_stats);
   stats.length(stats.maximum());
@@ -1444,6 +1919,12 @@ StatisticSeq RtpsUdpReceiveStrategy::stats_template()
   stats[local_offset + 4].name = "RtpsUdpRecvReassemblyTotal";
   stats[local_offset + 5].name = "RtpsUdpRecvReassemblyQueue";
   stats[local_offset + 6].name = "RtpsUdpRecvReassemblyCompleted";
+  stats[local_offset + 7].name = "RtpsUdpRecvBatches";
+  stats[local_offset + 8].name = "RtpsUdpRecvBatchDatagrams";
+  stats[local_offset + 9].name = "RtpsUdpRecvBatchesFull";
+  stats[local_offset + 10].name = "RtpsUdpRecvBatchMaxDatagrams";
+  stats[local_offset + 11].name = "RtpsUdpRecvGroBuffers";
+  stats[local_offset + 12].name = "RtpsUdpRecvGroSegments";
   return stats;
 }
 
@@ -1465,6 +1946,35 @@ void RtpsUdpReceiveStrategy::fill_stats(StatisticSeq& stats, DDS::UInt32& idx) c
   stats[idx++].value = reassembly_.total_frags();
   stats[idx++].value = reassembly_.queue_size();
   stats[idx++].value = reassembly_.completed_size();
+  stats[idx++].value = batches_received_.load();
+  stats[idx++].value = batch_datagrams_received_.load();
+  stats[idx++].value = batches_full_.load();
+  stats[idx++].value = batch_max_datagrams_.load();
+  stats[idx++].value = gro_buffers_received_.load();
+  stats[idx++].value = gro_segments_received_.load();
+}
+
+void RtpsUdpReceiveStrategy::add_shard_stats(StatisticSeq& stats, DDS::UInt32 idx) const
+{
+  StatisticSeq shard = stats_template();
+  DDS::UInt32 shard_idx = 0;
+  fill_stats(shard, shard_idx);
+
+  const DDS::UInt32 local_offset = TransportReceiveStrategy::stats_template().length();
+  const DDS::UInt32 reassembly_begin = local_offset + 3;
+  const DDS::UInt32 reassembly_end = local_offset + 7;
+  const DDS::UInt32 batch_max_datagrams = local_offset + 10;
+  for (DDS::UInt32 i = 0; i < shard.length(); ++i) {
+    if (i >= reassembly_begin && i < reassembly_end) {
+      // The shards use the primary strategy's reassembly.
+      continue;
+    }
+    if (i == batch_max_datagrams) {
+      stats[idx + i].value = std::max(stats[idx + i].value, shard[i].value);
+    } else {
+      stats[idx + i].value += shard[i].value;
+    }
+  }
 }
 
 } // namespace DCPS
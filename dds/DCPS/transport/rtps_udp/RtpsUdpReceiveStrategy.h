@@ -11,18 +11,30 @@
 #include "Rtps_Udp_Export.h"
 #include "RtpsTransportHeader.h"
 #include "RtpsSampleHeader.h"
+#include "RtpsUdpInst.h"
 
 #include "dds/DCPS/transport/framework/TransportReceiveStrategy_T.h"
 
 #include "dds/DCPS/RTPS/RtpsCoreC.h"
 #include "dds/DCPS/RTPS/ICE/Ice.h"
 
+#include "dds/DCPS/Atomic.h"
+#include "dds/DCPS/AtomicBool.h"
+#include "dds/DCPS/ConditionVariable.h"
 #include "dds/DCPS/NetworkAddress.h"
+#include "dds/DCPS/PoolAllocator.h"
 #include "dds/DCPS/RcEventHandler.h"
+#include "dds/DCPS/ReactorTask_rch.h"
+#include "dds/DCPS/unique_ptr.h"
 
 #include <dds/OpenDDSConfigWrapper.h>
 
 #include "ace/SOCK_Dgram.h"
+#include "ace/Task.h"
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+#  include <sys/socket.h>
+#endif
 
 #include <cstring>
 
@@ -47,9 +59,24 @@ class OpenDDS_Rtps_Udp_Export RtpsUdpReceiveStrategy
 public:
   static const size_t BUFFER_COUNT = 1u;
 
+  /// Upper bound on RtpsUdpInst::receive_batch_size().  Each slot of the
+  /// batch ring holds a full RECEIVE_DATA_BUFFER_SIZE buffer.
+  static const size_t MAX_RECEIVE_BATCH_SIZE = 64u;
+
+  /// When primary is given, this strategy reads a receive shard: an extra
+  /// SO_REUSEPORT unicast socket with its own reactor task.  It shares
+  /// fragment reassembly with the primary strategy.
   RtpsUdpReceiveStrategy(RtpsUdpDataLink* link,
                          const GuidPrefix_t& local_prefix,
-                         ThreadStatusManager& thread_status_manager);
+                         ThreadStatusManager& thread_status_manager,
+                         RtpsUdpReceiveStrategy* primary = 0,
+                         const ACE_SOCK_Dgram& shard_socket = ACE_SOCK_Dgram(),
+                         const ReactorTask_rch& shard_reactor_task = ReactorTask_rch());
+  ~RtpsUdpReceiveStrategy();
+
+  /// True if the calling thread is the one that last received on this
+  /// strategy's shard socket.
+  bool is_shard_thread() const;
 
   virtual int handle_input(ACE_HANDLE fd);
 
@@ -88,23 +115,86 @@ public:
                                       RtpsUdpTransport& tport,
                                       bool& stop);
 
+  /// Post-processing for "ret" bytes already read from a socket into iov:
+  /// updates statistics and handles non-RTPS (STUN) messages.
+  static ssize_t handle_received_bytes(iovec iov[],
+                                       int n,
+                                       ssize_t ret,
+                                       const ACE_INET_Addr& local_address,
+                                       const ACE_INET_Addr& remote_address,
+#if OPENDDS_CONFIG_SECURITY
+                                       DCPS::RcHandle<ICE::Agent> agent,
+                                       DCPS::WeakRcHandle<ICE::Endpoint> endpoint,
+#endif
+                                       RtpsUdpTransport& tport,
+                                       bool& stop);
+
   virtual void begin_transport_header_processing();
   virtual void end_transport_header_processing();
 
   static StatisticSeq stats_template();
   void fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const;
+  /// Add this receive shard's counters to the ones the primary strategy
+  /// filled in starting at idx.
+  void add_shard_stats(StatisticSeq& stats, DDS::UInt32 idx) const;
 
 private:
   bool getDirectedWriteReaders(RepoIdSet& directedWriteReaders, const RTPS::DataSubmessage& ds) const;
 
   const ACE_SOCK_Dgram& choose_recv_socket(ACE_HANDLE fd) const;
 
+  ACE_Message_Block* make_receive_buffer();
+  void replace_if_shared(ACE_Message_Block*& buffer);
+
   virtual ssize_t receive_bytes(iovec iov[],
                                 int n,
                                 ACE_INET_Addr& remote_address,
                                 ACE_HANDLE fd,
                                 bool& stop);
 
+  /// handle_input() without switching between the reactor and busy-poll
+  /// modes.  input_mutex_ must be held.
+  int handle_input_i(ACE_HANDLE fd);
+
+  /// Common processing of a datagram after it has been read from the socket
+  /// (currently only security decoding).  Returns the number of plaintext
+  /// bytes in iov.
+  ssize_t process_received(iovec iov[],
+                           int n,
+                           ssize_t ret,
+                           const ACE_INET_Addr& remote_address,
+                           bool& stop);
+
+  /// Parse and deliver the RTPS message held in the first "bytes" bytes of cur_rb.
+  void process_datagram(ACE_Message_Block& cur_rb,
+                        ACE_UINT32 bytes,
+                        const ACE_INET_Addr& remote_address);
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  /// Drain up to batch_buffers_.size() datagrams with a single recvmmsg.
+  int handle_input_batch(ACE_HANDLE fd);
+  bool use_batch_receive() const;
+
+  /// Parse each of the datagrams the kernel coalesced (GRO) into the
+  /// "length" bytes of batch slot "i".  Without GRO this is the whole buffer.
+  void process_batch_slot(size_t i, size_t length, const ACE_INET_Addr& remote_address);
+
+  OPENDDS_VECTOR(ACE_Message_Block*) batch_buffers_;
+  OPENDDS_VECTOR(mmsghdr) batch_msgs_;
+  OPENDDS_VECTOR(iovec) batch_iov_;
+  OPENDDS_VECTOR(sockaddr_storage) batch_addrs_;
+  /// Ancillary data space (UDP_GRO segment size) for each slot, empty
+  /// unless UseUdpGro is enabled.
+  OPENDDS_VECTOR(char) batch_control_;
+#endif
+
+  Atomic<size_t> batches_received_;
+  Atomic<size_t> batch_datagrams_received_;
+  Atomic<size_t> batches_full_;
+  Atomic<size_t> batch_max_datagrams_;
+  Atomic<size_t> gro_buffers_received_;
+  Atomic<size_t> gro_segments_received_;
+
   virtual void deliver_sample(ReceivedDataSample& sample,
                               const ACE_INET_Addr& remote_address);
 
@@ -115,6 +205,55 @@ private:
   virtual int start_i();
   virtual void stop_i();
 
+  /// Polls the unicast sockets when RtpsUdpInst::busy_poll_idle() is set.
+  /// After busy_poll_idle() without any input, it registers the sockets
+  /// with the reactor and waits.  The next datagram the reactor dispatches
+  /// removes them again and resumes polling.
+  class BusyPollTask : public ACE_Task_Base {
+  public:
+    BusyPollTask(RtpsUdpReceiveStrategy& outer, const TimeDuration& idle);
+    int svc();
+
+    /// Stop and join the task.  Returns true if the unicast sockets were
+    /// left registered with the reactor.
+    bool stop();
+
+    /// Called by the reactor thread after it received from a unicast
+    /// socket.  Returns true if the task resumed polling, in which case the
+    /// caller removes the sockets from the reactor.
+    bool resume_polling();
+
+  private:
+    RtpsUdpReceiveStrategy& outer_;
+    const TimeDuration idle_;
+    ACE_Thread_Mutex mutex_;
+    ConditionVariable<ACE_Thread_Mutex> condition_;
+    AtomicBool stopped_;
+    bool polling_;
+  };
+
+  /// Receive whatever is available on the unicast sockets without blocking.
+  /// Returns true if anything was received.
+  bool poll_unicast();
+  bool is_unicast_handle(ACE_HANDLE fd) const;
+  void register_unicast_handlers();
+  void remove_unicast_handlers(ACE_Reactor_Mask mask);
+
+  /// Serializes input from the reactor and the BusyPollTask.
+  ACE_Thread_Mutex input_mutex_;
+  /// Unicast handles that failed with busy polling enabled.  They are
+  /// neither polled nor registered with the reactor again.  Protected by
+  /// input_mutex_.
+  OPENDDS_SET(ACE_HANDLE) failed_handles_;
+  unique_ptr<BusyPollTask> busy_poll_task_;
+
+  bool is_shard() const { return shard_socket_.get_handle() != ACE_INVALID_HANDLE; }
+  ReactorTask_rch reactor_task() const;
+
+  ACE_SOCK_Dgram shard_socket_;
+  ReactorTask_rch shard_reactor_task_;
+  Atomic<ACE_thread_t> shard_thread_;
+
   virtual bool check_header(const RtpsTransportHeader& header);
 
   virtual bool check_header(const RtpsSampleHeader& header);
@@ -147,7 +286,8 @@ private:
   ACE_UINT16 fragment_size_;
   FragmentRange frags_;
   ACE_UINT32 total_frags_;
-  TransportReassembly reassembly_;
+  unique_ptr<TransportReassembly> owned_reassembly_;
+  TransportReassembly& reassembly_;
 
   struct MessageReceiver {
 
@@ -14,6 +14,7 @@
 #include <dds/OpenDDSConfigWrapper.h>
 
 #include <dds/DCPS/LogAddr.h>
+#include <dds/DCPS/Logging.h>
 #include <dds/DCPS/Serializer.h>
 
 #include <dds/DCPS/RTPS/MessageUtils.h>
@@ -24,6 +25,7 @@
 #include <dds/DCPS/transport/framework/TransportCustomizedElement.h>
 #include <dds/DCPS/transport/framework/TransportSendElement.h>
 
+#include <algorithm>
 #include <cstring>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -48,7 +50,15 @@ RtpsUdpSendStrategy::RtpsUdpSendStrategy(RtpsUdpDataLink* link,
     rtps_header_db_(RTPS::RTPSHDR_SZ, ACE_Message_Block::MB_DATA,
                     rtps_header_data_, 0, 0, ACE_Message_Block::DONT_DELETE, 0),
     rtps_header_mb_(&rtps_header_db_, ACE_Message_Block::DONT_DELETE),
-    network_is_unreachable_(false)
+    network_is_unreachable_(false),
+    send_batch_size_(std::min(link->config()->send_batch_size(), MAX_SEND_BATCH_SIZE)),
+    batch_calls_(0),
+    batch_messages_(0),
+    gso_sends_(0),
+    gso_segments_(0)
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    , gso_enabled_(link->config()->use_udp_gso())
+#endif
 {
   std::memcpy(rtps_message_.hdr.prefix, RTPS::PROTOCOL_RTPS, sizeof RTPS::PROTOCOL_RTPS);
   rtps_message_.hdr.version = OpenDDS::RTPS::PROTOCOLVERSION;
@@ -58,6 +68,7 @@ RtpsUdpSendStrategy::RtpsUdpSendStrategy(RtpsUdpDataLink* link,
   Serializer writer(&rtps_header_mb_, encoding_unaligned_native);
   // byte order doesn't matter for the RTPS Header
   writer << rtps_message_.hdr;
+
 }
 
 namespace {
@@ -91,10 +102,16 @@ ssize_t
 RtpsUdpSendStrategy::send_bytes_i_helper(const iovec iov[], int n)
 {
   if (override_single_dest_) {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    gso_flush();
+#endif
     return send_single_i(iov, n, *override_single_dest_);
   }
 
   if (override_dest_) {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+    gso_flush();
+#endif
     return send_multi_i(iov, n, *override_dest_);
   }
 
@@ -121,9 +138,214 @@ RtpsUdpSendStrategy::send_bytes_i_helper(const iovec iov[], int n)
     return result;
   }
 
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  if (elem->is_fragment()) {
+    return gso_append(iov, n, addrs, elem->is_last_fragment());
+  }
+  gso_flush();
+#endif
+
   return send_multi_i(iov, n, addrs);
 }
 
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+RtpsUdpSendStrategy::GsoRun::GsoRun()
+  : segment_size_(0)
+  , length_(0)
+{
+  packets_.reserve(MAX_GSO_SEGMENTS);
+  first_iov_.reserve(MAX_GSO_SEGMENTS);
+}
+
+bool
+RtpsUdpSendStrategy::GsoRun::accepts(size_t length, int n,
+                                     const NetworkAddressSet& addrs) const
+{
+  if (empty()) {
+    return true;
+  }
+  return length <= segment_size_
+    && length_ == segment_size_ * segments()
+    && segments() < MAX_GSO_SEGMENTS
+    && length_ + length <= UDP_MAX_MESSAGE_SIZE
+    && iov_.size() + static_cast<size_t>(n) <= MAX_GSO_IOV
+    && addrs_ == addrs;
+}
+
+void
+RtpsUdpSendStrategy::GsoRun::append(const iovec iov[], int n, size_t length,
+                                    const ACE_Message_Block& packet,
+                                    const NetworkAddressSet& addrs)
+{
+  if (empty()) {
+    segment_size_ = length;
+    addrs_ = addrs;
+  }
+  packets_.push_back(Message_Block_Shared_Ptr(packet.duplicate()));
+  first_iov_.push_back(iov_.size());
+  iov_.insert(iov_.end(), iov, iov + n);
+  length_ += length;
+}
+
+const iovec*
+RtpsUdpSendStrategy::GsoRun::segment_iov(size_t i, int& n) const
+{
+  const size_t end = i + 1 < first_iov_.size() ? first_iov_[i + 1] : iov_.size();
+  n = static_cast<int>(end - first_iov_[i]);
+  return &iov_[first_iov_[i]];
+}
+
+void
+RtpsUdpSendStrategy::GsoRun::clear()
+{
+  packets_.clear();
+  iov_.clear();
+  first_iov_.clear();
+  segment_size_ = 0;
+  length_ = 0;
+  addrs_.clear();
+}
+
+ssize_t
+RtpsUdpSendStrategy::gso_append(const iovec iov[], int n,
+                                const NetworkAddressSet& addrs,
+                                bool last_fragment)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, gso_lock_, -1);
+  const ACE_Message_Block* const packet = current_send_packet();
+  if (!gso_enabled_ || !packet) {
+    gso_flush_i();
+    return send_multi_i(iov, n, addrs);
+  }
+
+  size_t length = 0;
+  for (int i = 0; i < n; ++i) {
+    length += iov[i].iov_len;
+  }
+
+#ifdef OPENDDS_TESTING_FEATURES
+  RtpsUdpTransport_rch transport = link_->transport();
+  ssize_t total_length;
+  if (transport && transport->core().should_drop(iov, n, total_length)) {
+    return total_length;
+  }
+#endif
+
+  if (!gso_run_.accepts(length, n, addrs)) {
+    gso_flush_i();
+  }
+
+  if (length > UDP_MAX_MESSAGE_SIZE) {
+    return send_multi_i(iov, n, addrs);
+  }
+
+  gso_run_.append(iov, n, length, *packet, addrs);
+
+  // The run holds a reference to this fragment's packet, so the framework
+  // can release the fragment.  The sample itself is only delivered after its
+  // last fragment is sent, which is always before returning from here.
+  if (last_fragment || length < gso_run_.segment_size()) {
+    gso_flush_i();
+  }
+
+  return static_cast<ssize_t>(length);
+}
+
+void
+RtpsUdpSendStrategy::gso_flush()
+{
+  ACE_GUARD(ACE_Thread_Mutex, g, gso_lock_);
+  gso_flush_i();
+}
+
+void
+RtpsUdpSendStrategy::gso_flush_i()
+{
+  if (gso_run_.empty()) {
+    return;
+  }
+
+  const NetworkAddressSet& addrs = gso_run_.addrs();
+  for (NetworkAddressSet::const_iterator it = addrs.begin(); it != addrs.end(); ++it) {
+    if (*it) {
+      send_gso_i(*it);
+    }
+  }
+
+  gso_run_.clear();
+}
+
+void
+RtpsUdpSendStrategy::send_gso_i(const NetworkAddress& addr)
+{
+  if (gso_run_.segments() == 1 || !gso_enabled_) {
+    send_gso_segments_i(addr);
+    return;
+  }
+
+  RtpsUdpTransport_rch transport = link_->transport();
+  if (!transport) {
+    return;
+  }
+
+  const ACE_INET_Addr inet_addr = addr.to_addr();
+  char control[CMSG_SPACE(sizeof(ACE_UINT16))];
+  std::memset(control, 0, sizeof control);
+
+  msghdr msg;
+  std::memset(&msg, 0, sizeof msg);
+  msg.msg_name = inet_addr.get_addr();
+  msg.msg_namelen = inet_addr.get_size();
+  msg.msg_iov = const_cast<iovec*>(gso_run_.iov());
+  msg.msg_iovlen = gso_run_.iovlen();
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+
+  cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(ACE_UINT16));
+  const ACE_UINT16 segment_size = static_cast<ACE_UINT16>(gso_run_.segment_size());
+  std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof segment_size);
+
+  const ssize_t result = ::sendmsg(choose_send_socket(addr).get_handle(), &msg, 0);
+  if (result < 0) {
+    const int err = errno;
+    if (err == EIO || err == EINVAL || err == ENOPROTOOPT || err == EOPNOTSUPP) {
+      // The kernel or the outgoing device can't segment, don't try again.
+      if (log_level >= LogLevel::Notice) {
+        ACE_ERROR((LM_NOTICE, "(%P|%t) NOTICE: RtpsUdpSendStrategy::send_gso_i: "
+                   "UDP_SEGMENT send to %C failed, disabling GSO: %m\n",
+                   LogAddr(addr).c_str()));
+      }
+      gso_enabled_ = false;
+    }
+    // Send each segment on its own to get the usual error handling.
+    send_gso_segments_i(addr);
+    return;
+  }
+
+  ++gso_sends_;
+  gso_segments_ += gso_run_.segments();
+  const size_t last = gso_run_.length() - gso_run_.segment_size() * (gso_run_.segments() - 1);
+  for (size_t i = 0; i < gso_run_.segments(); ++i) {
+    transport->core().send(addr, MCK_RTPS, static_cast<ssize_t>(
+      i + 1 < gso_run_.segments() ? gso_run_.segment_size() : last));
+  }
+  network_is_unreachable_ = false;
+}
+
+void
+RtpsUdpSendStrategy::send_gso_segments_i(const NetworkAddress& addr)
+{
+  for (size_t i = 0; i < gso_run_.segments(); ++i) {
+    int n;
+    const iovec* const iov = gso_run_.segment_iov(i, n);
+    send_single_i(iov, n, addr);
+  }
+}
+#endif
+
 RtpsUdpSendStrategy::OverrideToken
 RtpsUdpSendStrategy::override_destinations(const NetworkAddress& destination)
 {
@@ -242,6 +464,177 @@ RtpsUdpSendStrategy::send_rtps_control(RTPS::Message& message,
   }
 }
 
+void
+RtpsUdpSendStrategy::send_rtps_control(RTPS::Message& message,
+                                       ACE_Message_Block& submessages,
+                                       const NetworkAddressSet& addrs,
+                                       ControlBatch& batch)
+{
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  if (send_batch_size_ <= 1) {
+    send_rtps_control(message, submessages, addrs);
+    return;
+  }
+
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, rtps_message_mutex_);
+    message.hdr = rtps_message_.hdr;
+  }
+
+  // The message outlives this call, so it gets its own header block instead
+  // of temporarily linking to rtps_header_mb_.  The header bytes never change.
+  Message_Block_Ptr chain(new ACE_Message_Block(rtps_header_data_, RTPS::RTPSHDR_SZ));
+  chain->wr_ptr(RTPS::RTPSHDR_SZ);
+  chain->cont(submessages.duplicate());
+
+#if OPENDDS_CONFIG_SECURITY
+  if (security_config()) {
+    const DDS::Security::CryptoTransform_var crypto = link_->security_config()->get_crypto_transform();
+    if (crypto) {
+      chain.reset(pre_send_packet(chain.get()));
+      if (!chain) {
+        VDBG((LM_DEBUG, "(%P|%t) RtpsUdpSendStrategy::send_rtps_control () - "
+              "pre_send_packet returned NULL, dropping.\n"));
+        return;
+      }
+    }
+  }
+#endif
+
+  batch.entries_.resize(batch.entries_.size() + 1);
+  ControlBatch::Entry& entry = batch.entries_.back();
+  entry.message_ = Message_Block_Shared_Ptr(chain.release());
+  entry.addrs_ = addrs;
+#else
+  ACE_UNUSED_ARG(batch);
+  send_rtps_control(message, submessages, addrs);
+#endif
+}
+
+void
+RtpsUdpSendStrategy::send_control_batch(ControlBatch& batch)
+{
+  if (batch.entries_.empty()) {
+    return;
+  }
+
+  RtpsUdpTransport_rch transport = link_->transport();
+  if (!transport) {
+    batch.entries_.clear();
+    return;
+  }
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  size_t total_blocks = 0;
+  for (size_t i = 0; i < batch.entries_.size(); ++i) {
+    for (const ACE_Message_Block* mb = batch.entries_[i].message_.get(); mb; mb = mb->cont()) {
+      ++total_blocks;
+    }
+  }
+
+  // iovecs for all entries, shared by each destination of an entry
+  OPENDDS_VECTOR(iovec) iovs(total_blocks);
+  OPENDDS_VECTOR(BatchMessage) ipv4_messages;
+#ifdef ACE_HAS_IPV6
+  OPENDDS_VECTOR(BatchMessage) ipv6_messages;
+#endif
+
+  size_t iov_idx = 0;
+  for (size_t i = 0; i < batch.entries_.size(); ++i) {
+    const ControlBatch::Entry& entry = batch.entries_[i];
+    const size_t first = iov_idx;
+    for (const ACE_Message_Block* mb = entry.message_.get(); mb; mb = mb->cont()) {
+      if (mb->length()) {
+        iovs[iov_idx].iov_base = mb->rd_ptr();
+        iovs[iov_idx].iov_len = mb->length();
+        ++iov_idx;
+      }
+    }
+
+    for (NetworkAddressSet::const_iterator it = entry.addrs_.begin(); it != entry.addrs_.end(); ++it) {
+      if (!*it) {
+        continue;
+      }
+#ifdef OPENDDS_TESTING_FEATURES
+      ssize_t total_length;
+      if (transport->core().should_drop(&iovs[first], static_cast<int>(iov_idx - first), total_length)) {
+        continue;
+      }
+#endif
+      const BatchMessage bm = { &iovs[first], iov_idx - first, *it, it->to_addr() };
+#ifdef ACE_HAS_IPV6
+      if (it->get_type() == AF_INET6) {
+        ipv6_messages.push_back(bm);
+        continue;
+      }
+#endif
+      ipv4_messages.push_back(bm);
+    }
+  }
+
+  send_mmsg_i(link_->unicast_socket(), ipv4_messages);
+#ifdef ACE_HAS_IPV6
+  send_mmsg_i(link_->ipv6_unicast_socket(), ipv6_messages);
+#endif
+#else
+  for (size_t i = 0; i < batch.entries_.size(); ++i) {
+    iovec iov[MAX_SEND_BLOCKS];
+    const int num_blocks = mb_to_iov(*batch.entries_[i].message_, iov);
+    send_multi_i(iov, num_blocks, batch.entries_[i].addrs_);
+  }
+#endif
+
+  batch.entries_.clear();
+}
+
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+void
+RtpsUdpSendStrategy::send_mmsg_i(const ACE_SOCK_Dgram& socket,
+                                 OPENDDS_VECTOR(BatchMessage)& messages)
+{
+  if (messages.empty()) {
+    return;
+  }
+
+  RtpsUdpTransport_rch transport = link_->transport();
+  if (!transport) {
+    return;
+  }
+
+  OPENDDS_VECTOR(mmsghdr) msgs(std::min(messages.size(), send_batch_size_));
+  size_t offset = 0;
+  while (offset < messages.size()) {
+    const size_t count = std::min(messages.size() - offset, send_batch_size_);
+    for (size_t i = 0; i < count; ++i) {
+      BatchMessage& bm = messages[offset + i];
+      std::memset(&msgs[i], 0, sizeof msgs[i]);
+      msgs[i].msg_hdr.msg_name = bm.inet_addr_.get_addr();
+      msgs[i].msg_hdr.msg_namelen = bm.inet_addr_.get_size();
+      msgs[i].msg_hdr.msg_iov = const_cast<iovec*>(bm.iov_);
+      msgs[i].msg_hdr.msg_iovlen = bm.iovlen_;
+    }
+
+    const int sent = ::sendmmsg(socket.get_handle(), &msgs[0], static_cast<unsigned int>(count), 0);
+    ++batch_calls_;
+    if (sent <= 0) {
+      // The first message failed, send it on its own to get the usual
+      // error handling and logging, then continue with the rest.
+      const BatchMessage& bm = messages[offset];
+      send_single_i(bm.iov_, static_cast<int>(bm.iovlen_), bm.addr_);
+      ++offset;
+      continue;
+    }
+
+    batch_messages_ += static_cast<size_t>(sent);
+    for (int i = 0; i < sent; ++i) {
+      transport->core().send(messages[offset + i].addr_, MCK_RTPS, msgs[i].msg_len);
+    }
+    network_is_unreachable_ = false;
+    offset += static_cast<size_t>(sent);
+  }
+}
+#endif
+
 void
 RtpsUdpSendStrategy::append_submessages(const RTPS::SubmessageSeq& submessages)
 {
@@ -786,6 +1179,9 @@ RtpsUdpSendStrategy::replace_chunks(const ACE_Message_Block* plain,
 void
 RtpsUdpSendStrategy::stop_i()
 {
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  gso_flush();
+#endif
 }
 
 size_t RtpsUdpSendStrategy::max_message_size() const
@@ -799,6 +1195,32 @@ size_t RtpsUdpSendStrategy::max_message_size() const
     ;
 }
 
+StatisticSeq RtpsUdpSendStrategy::stats_template()
+{
+  static const DDS::UInt32 num_local_stats = 4;
+  const StatisticSeq base = TransportSendStrategy::stats_template();
+  StatisticSeq stats(base.length() + num_local_stats);
+  stats.length(stats.maximum());
+  for (DDS::UInt32 i = 0; i < base.length(); ++i) {
+    stats[i].name = base[i].name;
+  }
+  const DDS::UInt32 local_offset = base.length();
+  stats[local_offset].name = "RtpsUdpSendBatchCalls";
+  stats[local_offset + 1].name = "RtpsUdpSendBatchMessages";
+  stats[local_offset + 2].name = "RtpsUdpSendGsoCalls";
+  stats[local_offset + 3].name = "RtpsUdpSendGsoSegments";
+  return stats;
+}
+
+void RtpsUdpSendStrategy::fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const
+{
+  TransportSendStrategy::fill_stats(stats, idx);
+  stats[idx++].value = batch_calls_.load();
+  stats[idx++].value = batch_messages_.load();
+  stats[idx++].value = gso_sends_.load();
+  stats[idx++].value = gso_segments_.load();
+}
+
 } // namespace DCPS
 } // namespace OpenDDS
 
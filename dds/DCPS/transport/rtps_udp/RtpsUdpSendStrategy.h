@@ -8,8 +8,11 @@
 
 #include "Rtps_Udp_Export.h"
 #include "RtpsUdpDataLink_rch.h"
+#include "RtpsUdpInst.h"
 
+#include <dds/DCPS/Atomic.h>
 #include <dds/DCPS/AtomicBool.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
 #include <dds/DCPS/NetworkAddress.h>
 
 #include <dds/DCPS/transport/framework/TransportSendStrategy.h>
@@ -24,13 +27,15 @@
 
 #include <ace/SOCK_Dgram.h>
 
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+#  include <sys/socket.h>
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
-class RtpsUdpInst;
-
 class OpenDDS_Rtps_Udp_Export RtpsUdpSendStrategy
   : public TransportSendStrategy {
 public:
@@ -57,6 +62,81 @@ public:
                          const NetworkAddressSet& destinations);
   void append_submessages(const RTPS::SubmessageSeq& submessages);
 
+  /// Upper bound on RtpsUdpInst::send_batch_size() (the kernel's UIO_MAXIOV).
+  static const size_t MAX_SEND_BATCH_SIZE = 1024u;
+
+  /// RTPS control messages collected while flushing the send queue so that
+  /// they can be handed to the socket(s) together by send_control_batch().
+  struct ControlBatch {
+    struct Entry {
+      Message_Block_Shared_Ptr message_;
+      NetworkAddressSet addrs_;
+    };
+    OPENDDS_VECTOR(Entry) entries_;
+  };
+
+  /// Add a control message to "batch", or send it immediately if batched
+  /// send is disabled or not supported.
+  void send_rtps_control(RTPS::Message& message,
+                         ACE_Message_Block& submessages,
+                         const NetworkAddressSet& destinations,
+                         ControlBatch& batch);
+  void send_control_batch(ControlBatch& batch);
+
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  /// Upper bound on the number of segments in one GSO send (the kernel's
+  /// UDP_MAX_SEGMENTS).
+  static const size_t MAX_GSO_SEGMENTS = 64u;
+
+  /// Upper bound on the number of iovecs in one GSO send (the kernel's
+  /// UIO_MAXIOV).
+  static const size_t MAX_GSO_IOV = 1024u;
+
+  /// Consecutive equally sized fragment datagrams with the same
+  /// destinations, waiting to be sent with one UDP_SEGMENT sendmsg.  The
+  /// datagrams aren't copied, the run keeps a reference to each packet so
+  /// that its iovecs stay valid.
+  class GsoRun {
+  public:
+    GsoRun();
+
+    bool empty() const { return packets_.empty(); }
+    size_t segments() const { return packets_.size(); }
+    size_t segment_size() const { return segment_size_; }
+    size_t length() const { return length_; }
+    const NetworkAddressSet& addrs() const { return addrs_; }
+
+    /// Can a datagram of "length" bytes in "n" iovecs to "addrs" be added?
+    /// Every segment but the last must be exactly segment_size() bytes.
+    bool accepts(size_t length, int n, const NetworkAddressSet& addrs) const;
+
+    /// Add a datagram.  "iov" refers to the bytes of "packet".
+    void append(const iovec iov[], int n, size_t length,
+                const ACE_Message_Block& packet, const NetworkAddressSet& addrs);
+
+    /// All of the datagrams, for a UDP_SEGMENT sendmsg.
+    const iovec* iov() const { return &iov_[0]; }
+    size_t iovlen() const { return iov_.size(); }
+
+    /// The iovecs of datagram "i", for sending the datagrams one at a time.
+    const iovec* segment_iov(size_t i, int& n) const;
+
+    void clear();
+
+  private:
+    OPENDDS_VECTOR(Message_Block_Shared_Ptr) packets_;
+    OPENDDS_VECTOR(iovec) iov_;
+    /// Index into iov_ of the first iovec of each datagram.
+    OPENDDS_VECTOR(size_t) first_iov_;
+    size_t segment_size_;
+    size_t length_;
+    NetworkAddressSet addrs_;
+  };
+#endif
+
+  static StatisticSeq stats_template();
+  void fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const;
+
 #if OPENDDS_CONFIG_SECURITY
   void encode_payload(const GUID_t& pub_id, Message_Block_Ptr& payload,
                       RTPS::SubmessageSeq& submessages);
@@ -99,6 +179,26 @@ private:
   ssize_t send_single_i(const iovec iov[], int n,
                         const NetworkAddress& addr);
 
+#if OPENDDS_RTPS_UDP_HAS_MMSG
+  struct BatchMessage {
+    const iovec* iov_;
+    size_t iovlen_;
+    NetworkAddress addr_;
+    ACE_INET_Addr inet_addr_;
+  };
+  void send_mmsg_i(const ACE_SOCK_Dgram& socket,
+                   OPENDDS_VECTOR(BatchMessage)& messages);
+#endif
+
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  ssize_t gso_append(const iovec iov[], int n,
+                     const NetworkAddressSet& addrs, bool last_fragment);
+  void gso_flush_i();
+  void gso_flush();
+  void send_gso_i(const NetworkAddress& addr);
+  void send_gso_segments_i(const NetworkAddress& addr);
+#endif
+
 #if OPENDDS_CONFIG_SECURITY
   ACE_Message_Block* pre_send_packet(const ACE_Message_Block* plain);
 
@@ -147,6 +247,16 @@ private:
   ACE_Message_Block rtps_header_mb_;
   ACE_Thread_Mutex rtps_header_mb_lock_;
   AtomicBool network_is_unreachable_;
+  const size_t send_batch_size_;
+  Atomic<size_t> batch_calls_;
+  Atomic<size_t> batch_messages_;
+  Atomic<size_t> gso_sends_;
+  Atomic<size_t> gso_segments_;
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+  bool gso_enabled_;
+  GsoRun gso_run_;
+  ACE_Thread_Mutex gso_lock_;
+#endif
 };
 
 } // namespace DCPS
@@ -37,10 +37,7 @@ namespace OpenDDS {
 namespace DCPS {
 
 RtpsUdpCore::RtpsUdpCore(const RtpsUdpInst_rch& inst)
-  : send_delay_(inst->send_delay())
-  , heartbeat_period_(inst->heartbeat_period())
-  , nak_response_delay_(inst->nak_response_delay())
-  , receive_address_duration_(inst->receive_address_duration())
+  : config_(make_rch<RtpsUdpConfigSnapshot>(*inst))
   , rtps_relay_only_(inst->rtps_relay_only())
   , use_rtps_relay_(inst->use_rtps_relay())
   , rtps_relay_address_(inst->rtps_relay_address())
@@ -352,13 +349,13 @@ RtpsUdpTransport::get_connection_addrs(const TransportBLOB& remote,
     *vendor_id = vid;
   }
 
+  const bool use_multicast = mc_addrs && core_.config()->use_multicast_;
   for (CORBA::ULong i = 0; i < locators.length(); ++i) {
     ACE_INET_Addr addr;
     // If conversion was successful
     if (locator_to_address(addr, locators[i], false) == 0) {
       if (addr.is_multicast()) {
-        RtpsUdpInst_rch cfg = config();
-        if (cfg && cfg->use_multicast() && mc_addrs) {
+        if (use_multicast) {
           mc_addrs->insert(NetworkAddress(addr));
         }
       } else if (uc_addrs) {
@@ -563,6 +560,12 @@ bool RtpsUdpTransport::open_socket(
     config->init_participant_port_id();
 #endif
 
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+  // The receive shards bind the same port, so SO_REUSEPORT has to be set on
+  // this socket before it's bound.
+  const bool reuseport = ipv4 && config->receive_shards() > 1 && !config->use_ice();
+#endif
+
   NetworkAddress address;
   bool fixed_port;
   DDS::UInt16 part_port_id = init_part_port_id;
@@ -579,7 +582,16 @@ bool RtpsUdpTransport::open_socket(
     }
 #endif
 
-    if (sock.open(address.to_addr(), protocol) == 0) {
+    bool opened;
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+    if (reuseport) {
+      opened = RtpsUdpDataLink::open_first_reuseport_socket(sock, address.to_addr());
+    } else
+#endif
+    {
+      opened = sock.open(address.to_addr(), protocol) == 0;
+    }
+    if (opened) {
       break;
     }
 
@@ -850,6 +862,7 @@ RtpsUdpTransport::on_data_available(ConfigReader_rch reader)
 
   if (has_prefix) {
     core_.reload(config_prefix);
+    core_.config(make_rch<RtpsUdpConfigSnapshot>(*cfg));
   }
 }
 
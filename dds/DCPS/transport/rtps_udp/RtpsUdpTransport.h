@@ -37,28 +37,41 @@ class OpenDDS_Rtps_Udp_Export RtpsUdpCore {
 public:
   RtpsUdpCore(const RtpsUdpInst_rch& inst);
 
+  /// The current configuration snapshot.
+  RtpsUdpConfigSnapshot_rch config() const
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+    return config_;
+  }
+
+  void config(const RtpsUdpConfigSnapshot_rch& config)
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+    config_ = config;
+  }
+
   TimeDuration send_delay() const
   {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    return send_delay_;
+    return config_->send_delay_;
   }
 
   TimeDuration heartbeat_period() const
   {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    return heartbeat_period_;
+    return config_->heartbeat_period_;
   }
 
   TimeDuration nak_response_delay() const
   {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    return nak_response_delay_;
+    return config_->nak_response_delay_;
   }
 
   TimeDuration receive_address_duration() const
   {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    return receive_address_duration_;
+    return config_->receive_address_duration_;
   }
 
   void rtps_relay_only(bool flag)
@@ -220,7 +233,7 @@ public:
   void reset_relay_stun_event_falloff()
   {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    relay_stun_event_falloff_.set(heartbeat_period_);
+    relay_stun_event_falloff_.set(config_->heartbeat_period_);
   }
 
   TimeDuration advance_relay_stun_event_falloff()
@@ -277,10 +290,7 @@ public:
 
 private:
   mutable ACE_Thread_Mutex mutex_;
-  const TimeDuration send_delay_;
-  const TimeDuration heartbeat_period_;
-  const TimeDuration nak_response_delay_;
-  const TimeDuration receive_address_duration_;
+  RtpsUdpConfigSnapshot_rch config_;
   bool rtps_relay_only_;
   bool use_rtps_relay_;
   NetworkAddress rtps_relay_address_;
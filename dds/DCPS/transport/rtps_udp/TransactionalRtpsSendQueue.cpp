@@ -5,33 +5,64 @@
 
 #include "TransactionalRtpsSendQueue.h"
 
+#include <dds/DCPS/Hash.h>
+
+#include <ace/Thread.h>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
 TransactionalRtpsSendQueue::TransactionalRtpsSendQueue()
-  : ready_to_send_(false)
+  : size_(0)
+  , ready_to_send_(false)
   , active_transaction_count_(0)
 {
 }
 
+TransactionalRtpsSendQueue::Staging& TransactionalRtpsSendQueue::staging()
+{
+  const ACE_thread_t self = ACE_Thread::self();
+  unsigned hash = fnv_1a_hash(reinterpret_cast<const unsigned char*>(&self), sizeof self);
+  // Thread ids often differ only in their upper bits.
+  hash ^= hash >> 15;
+  return staging_[hash % STAGING_STRIPES];
+}
+
 bool TransactionalRtpsSendQueue::enqueue(const MetaSubmessage& ms)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  const bool empty_before = queue_.empty();
-  queue_.push_back(ms);
-  return empty_before;
+  Staging& staging = this->staging();
+  ACE_Guard<ACE_Thread_Mutex> guard(staging.mutex_);
+  staging.queue_.push_back(ms);
+  return ++size_ == 1;
 }
 
 bool TransactionalRtpsSendQueue::enqueue(const MetaSubmessageVec& vec)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  const bool empty_before = queue_.empty();
-  for (MetaSubmessageVec::const_iterator it = vec.begin(), limit = vec.end(); it != limit; ++it) {
-    queue_.push_back(*it);
+  if (vec.empty()) {
+    return false;
+  }
+
+  Staging& staging = this->staging();
+  ACE_Guard<ACE_Thread_Mutex> guard(staging.mutex_);
+  staging.queue_.insert(staging.queue_.end(), vec.begin(), vec.end());
+  return (size_ += vec.size()) == vec.size();
+}
+
+TransactionalRtpsSendQueue::StagingGuard::StagingGuard(Staging* staging)
+  : staging_(staging)
+{
+  for (size_t i = 0; i != STAGING_STRIPES; ++i) {
+    staging_[i].mutex_.acquire();
+  }
+}
+
+TransactionalRtpsSendQueue::StagingGuard::~StagingGuard()
+{
+  for (size_t i = STAGING_STRIPES; i != 0; --i) {
+    staging_[i - 1].mutex_.release();
   }
-  return empty_before && !queue_.empty();
 }
 
 void TransactionalRtpsSendQueue::begin_transaction()
@@ -54,39 +85,76 @@ void TransactionalRtpsSendQueue::end_transaction(MetaSubmessageVec& vec)
   ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
   --active_transaction_count_;
   if (active_transaction_count_ == 0 && ready_to_send_) {
-    queue_.swap(vec);
+    // Hold every stripe while draining.  If the stripes were drained one at
+    // a time, an enqueue into a drained stripe would still count the
+    // submessages of the stripes not drained yet and wouldn't report that
+    // the queue was empty, so nothing would harvest it again.
+    StagingGuard staging_guard(staging_);
+    for (size_t i = 0; i != STAGING_STRIPES; ++i) {
+      MetaSubmessageVec& queue = staging_[i].queue_;
+      if (queue.empty()) {
+        continue;
+      }
+      if (vec.empty()) {
+        queue.swap(vec);
+      } else {
+        vec.insert(vec.end(), queue.begin(), queue.end());
+        queue.clear();
+      }
+    }
+    size_ = 0;
     ready_to_send_ = false;
   }
 }
 
-void TransactionalRtpsSendQueue::ignore(const GUID_t& local, const GUID_t& remote)
+namespace {
+  struct MatchBoth {
+    MatchBoth(const GUID_t& local, const GUID_t& remote) : local_(local), remote_(remote) {}
+    bool operator()(const MetaSubmessage& ms) const { return ms.src_guid_ == local_ && ms.dst_guid_ == remote_; }
+    const GUID_t& local_;
+    const GUID_t& remote_;
+  };
+
+  struct MatchRemote {
+    explicit MatchRemote(const GUID_t& id) : id_(id) {}
+    bool operator()(const MetaSubmessage& ms) const { return ms.dst_guid_ == id_; }
+    const GUID_t& id_;
+  };
+
+  struct MatchLocal {
+    explicit MatchLocal(const GUID_t& id) : id_(id) {}
+    bool operator()(const MetaSubmessage& ms) const { return ms.src_guid_ == id_; }
+    const GUID_t& id_;
+  };
+}
+
+template <typename Pred>
+void TransactionalRtpsSendQueue::ignore_i(const Pred& pred)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  for (MetaSubmessageVec::iterator pos = queue_.begin(), limit = queue_.end(); pos != limit; ++pos) {
-    if (pos->src_guid_ == local && pos->dst_guid_ == remote) {
-      pos->ignore_ = true;
+  for (size_t i = 0; i != STAGING_STRIPES; ++i) {
+    ACE_Guard<ACE_Thread_Mutex> guard(staging_[i].mutex_);
+    MetaSubmessageVec& queue = staging_[i].queue_;
+    for (MetaSubmessageVec::iterator pos = queue.begin(), limit = queue.end(); pos != limit; ++pos) {
+      if (pred(*pos)) {
+        pos->ignore_ = true;
+      }
     }
   }
 }
 
+void TransactionalRtpsSendQueue::ignore(const GUID_t& local, const GUID_t& remote)
+{
+  ignore_i(MatchBoth(local, remote));
+}
+
 void TransactionalRtpsSendQueue::ignore_remote(const GUID_t& id)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  for (MetaSubmessageVec::iterator pos = queue_.begin(), limit = queue_.end(); pos != limit; ++pos) {
-    if (pos->dst_guid_ == id) {
-      pos->ignore_ = true;
-    }
-  }
+  ignore_i(MatchRemote(id));
 }
 
 void TransactionalRtpsSendQueue::ignore_local(const GUID_t& id)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  for (MetaSubmessageVec::iterator pos = queue_.begin(), limit = queue_.end(); pos != limit; ++pos) {
-    if (pos->src_guid_ == id) {
-      pos->ignore_ = true;
-    }
-  }
+  ignore_i(MatchLocal(id));
 }
 
 } // namespace DCPS
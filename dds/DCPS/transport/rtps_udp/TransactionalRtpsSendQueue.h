@@ -11,6 +11,8 @@
 
 #include "MetaSubmessage.h"
 
+#include "dds/DCPS/Atomic.h"
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -21,6 +23,11 @@ namespace DCPS {
 *
 * This class is designed to collect submessages from various threads
 * in a transactional way so they can be more efficiently bundled.
+*
+* Submessages are staged in one of several stripes chosen by the calling
+* thread so concurrent producers rarely contend.  The stripes are collected
+* when the last transaction ends after ready_to_send().  Submessages from
+* one thread keep their order, submessages from different threads may not.
 */
 class OpenDDS_Rtps_Udp_Export TransactionalRtpsSendQueue {
 public:
@@ -55,15 +62,39 @@ public:
 
   size_t size() const
   {
-    ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-    return queue_.size();
+    return size_;
   }
 
 private:
+  static const size_t STAGING_STRIPES = 8;
 
-  mutable ACE_Thread_Mutex mutex_;
+  struct Staging {
+    ACE_Thread_Mutex mutex_;
+    MetaSubmessageVec queue_;
+  };
+
+  /// Locks every stripe, in order, for as long as it lives.
+  class StagingGuard {
+  public:
+    explicit StagingGuard(Staging* staging);
+    ~StagingGuard();
+
+  private:
+    StagingGuard(const StagingGuard&);
+    StagingGuard& operator=(const StagingGuard&);
 
-  MetaSubmessageVec queue_;
+    Staging* const staging_;
+  };
+
+  Staging& staging();
+  template <typename Pred>
+  void ignore_i(const Pred& pred);
+
+  Staging staging_[STAGING_STRIPES];
+  Atomic<size_t> size_;
+
+  /// Protects the transaction state.  Stripe mutexes are locked after it.
+  mutable ACE_Thread_Mutex mutex_;
   bool ready_to_send_;
   size_t active_transaction_count_;
 };
@@ -274,12 +274,6 @@ ShmemDataLink::local_address()
   return result;
 }
 
-void
-ShmemDataLink::signal_semaphore()
-{
-  OPENDDS_TEST_AND_CALL(ShmemTransport_rch, transport(), signal_semaphore());
-}
-
 pid_t
 ShmemDataLink::peer_pid()
 {
@@ -20,6 +20,9 @@
 
 #include <string>
 #include <set>
+#ifdef ACE_HAS_CPP11
+#  include <atomic>
+#endif
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -28,25 +31,94 @@ namespace DCPS {
 
 class ReceivedDataSample;
 
+/*
+ * The shared memory structures below are used by processes that may have been
+ * built separately.  Fixed-size integer types are used instead of enums or
+ * bool to try to make the in-memory representation independent of
+ * compiler/implementation decisions. We can't guarantee that two processes
+ * running code built with different compilers can communicate over shmem, but
+ * we'll try to support it when possible.
+ */
+
+/// Assumed size of a cache line, used to keep the fields written by different
+/// processes apart.
+const size_t SHMEM_CACHE_LINE_SIZE = 64;
+
+/*
+ * A 32-bit counter in shared memory that is written by one process and read
+ * by another.  store_release() publishes everything written before it to a
+ * reader that sees the new value with load_acquire().
+ */
+struct ShmemAtomicU32 {
+#ifdef ACE_HAS_CPP11
+  ACE_UINT32 load_acquire() const { return value_.load(std::memory_order_acquire); }
+  void store_release(ACE_UINT32 value) { value_.store(value, std::memory_order_release); }
+  static void full_fence() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+  std::atomic<ACE_UINT32> value_;
+#else
+  ACE_UINT32 load_acquire() const
+  {
+    const ACE_UINT32 value = value_;
+    full_fence();
+    return value;
+  }
+
+  void store_release(ACE_UINT32 value)
+  {
+    full_fence();
+    value_ = value;
+  }
+
+  static void full_fence()
+  {
+#  if defined ACE_WIN32
+    MemoryBarrier();
+#  else
+    __sync_synchronize();
+#  endif
+  }
+
+  volatile ACE_UINT32 value_;
+#endif
+};
+
+/// One slot of a DataLink's control ring.
 struct ShmemData {
-  enum Status {
-    Free = 0,
-    InUse = 1,
-    RecvDone = 2,
-    EndOfAlloc = -1
-  };
-
-  /*
-   * This is ACE_INT8 instead of Status to try to make the in-memory
-   * representation independent of compiler/implementation decisions. We can't
-   * guarantee that two processes running code built with different compilers
-   * can communicate over shmem, but we'll try to support it when possible.
-   */
-  ACE_INT8 status_;
   char transport_header_[TRANSPORT_HDR_SERIALIZED_SZ];
   ACE_Based_Pointer_Basic<char> payload_;
 };
 
+/*
+ * Start of each DataLink's control area, a single-producer/single-consumer
+ * ring of ShmemData slots follows it.  The sending process allocates it in its
+ * own pool and is the only one that writes the slots and head_.  The receiving
+ * process is the only one that writes tail_.  Both are free-running counters,
+ * the slot for counter value c is slots()[c & (capacity_ - 1)].  The ring is
+ * empty when head_ == tail_ and full when head_ - tail_ == capacity_.
+ */
+struct ShmemControl {
+  ACE_UINT32 capacity_; // power of 2, not changed after the ring is bound
+  char pad0_[SHMEM_CACHE_LINE_SIZE - sizeof(ACE_UINT32)];
+  ShmemAtomicU32 head_; // next slot the sender will write
+  char pad1_[SHMEM_CACHE_LINE_SIZE - sizeof(ShmemAtomicU32)];
+  ShmemAtomicU32 tail_; // next slot the receiver will read
+  char pad2_[SHMEM_CACHE_LINE_SIZE - sizeof(ShmemAtomicU32)];
+
+  ShmemData* slots() { return reinterpret_cast<ShmemData*>(this + 1); }
+  ShmemData& slot(ACE_UINT32 counter) { return slots()[counter & (capacity_ - 1)]; }
+};
+
+/*
+ * Precedes each payload in the pool.  When a packet is sent on several
+ * DataLinks, they all reference the same payload, see
+ * ShmemTransport::acquire_payload().  Only the writing process accesses this.
+ */
+struct ShmemPayloadHeader {
+  ACE_UINT32 refcount_;
+  ACE_UINT32 reserved_; // keeps the payload 8-byte aligned
+};
+
 class OpenDDS_Shmem_Export ShmemDataLink
   : public DataLink {
 public:
@@ -80,8 +152,7 @@ public:
   ShmemAllocator* local_allocator();
   ShmemAllocator* peer_allocator();
 
-  void read() { recv_strategy_->read(); }
-  void signal_semaphore();
+  bool read() { return recv_strategy_->read(); }
   ShmemTransport_rch transport() const;
   ShmemInst_rch config() const;
 
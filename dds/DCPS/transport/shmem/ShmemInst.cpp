@@ -25,6 +25,7 @@ ShmemInst::ShmemInst(const std::string& name)
   : TransportInst("shmem", name)
   , pool_size_(*this, &ShmemInst::pool_size, &ShmemInst::pool_size)
   , datalink_control_size_(*this, &ShmemInst::datalink_control_size, &ShmemInst::datalink_control_size)
+  , busy_poll_spins_(*this, &ShmemInst::busy_poll_spins, &ShmemInst::busy_poll_spins)
 {
   std::ostringstream pool;
   pool << "OpenDDS-" << ACE_OS::getpid() << '-' << this->name();
@@ -44,6 +45,7 @@ ShmemInst::dump_to_str(DDS::DomainId_t domain) const
   os << TransportInst::dump_to_str(domain);
   os << formatNameForDump("pool_size") << pool_size() << "\n"
      << formatNameForDump("datalink_control_size") << datalink_control_size() << "\n"
+     << formatNameForDump("busy_poll_spins") << busy_poll_spins() << "\n"
      << formatNameForDump("pool_name") << this->poolname_ << "\n"
      << formatNameForDump("host_name") << this->hostname() << "\n"
      << formatNameForDump("association_resend_period") << association_resend_period().str() << "\n";
@@ -97,6 +99,18 @@ ShmemInst::datalink_control_size() const
   return TheServiceParticipant->config_store()->get_uint32(config_key("DATALINK_CONTROL_SIZE").c_str(), 4 * 1024);
 }
 
+void
+ShmemInst::busy_poll_spins(ACE_UINT32 bps)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("BUSY_POLL_SPINS").c_str(), bps);
+}
+
+ACE_UINT32
+ShmemInst::busy_poll_spins() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("BUSY_POLL_SPINS").c_str(), 0);
+}
+
 void
 ShmemInst::hostname(const String& h)
 {
@@ -36,6 +36,15 @@ public:
   void datalink_control_size(size_t dcs);
   size_t datalink_control_size() const;
 
+  /// Number of times the receiving thread checks for more data after the
+  /// last data it received before waiting on the semaphore.  Each sender
+  /// only posts the semaphore while the receiver is waiting, so polling
+  /// saves semaphore operations on busy links at the cost of CPU time.
+  /// Defaults to 0 (wait right away).
+  ConfigValue<ShmemInst, ACE_UINT32> busy_poll_spins_;
+  void busy_poll_spins(ACE_UINT32 bps);
+  ACE_UINT32 busy_poll_spins() const;
+
   bool is_reliable() const { return true; }
 
   virtual size_t populate_locator(OpenDDS::DCPS::TransportLocator& trans_info,
@@ -23,58 +23,64 @@ namespace DCPS {
 ShmemReceiveStrategy::ShmemReceiveStrategy(ShmemDataLink* link)
   : TransportReceiveStrategy<>(link->config())
   , link_(link)
+  , control_(0)
   , current_data_(0)
   , partial_recv_remaining_(0)
   , partial_recv_ptr_(0)
 {
 }
 
-void
+bool
 ShmemReceiveStrategy::read()
 {
-  if (partial_recv_remaining_) {
-    VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
-          "resuming partial recv\n", link_));
-    handle_dds_input(ACE_INVALID_HANDLE);
-    return;
-  }
-
   if (bound_name_.empty()) {
     bound_name_ = "Write-" + link_->local_address();
   }
 
-  ShmemAllocator* alloc = link_->peer_allocator();
-  void* mem = 0;
-  if (alloc == 0 || -1 == alloc->find(bound_name_.c_str(), mem)) {
-    VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
-              "peer allocator not found, receive_bytes will close link\n",
-              link_), 1);
-    handle_dds_input(ACE_INVALID_HANDLE); // will return 0 to the TRecvStrateg.
-    return;
-  }
+  bool progress = false;
+  for (;;) {
+    if (partial_recv_remaining_) {
+      VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
+            "resuming partial recv\n", link_));
+      const size_t remaining = partial_recv_remaining_;
+      handle_dds_input(ACE_INVALID_HANDLE);
+      if (partial_recv_remaining_ && partial_recv_remaining_ >= remaining) {
+        return progress;
+      }
+      progress = true;
+      continue;
+    }
 
-  if (!current_data_) {
-    current_data_ = reinterpret_cast<ShmemData*>(mem);
-  }
+    ShmemAllocator* alloc = link_->peer_allocator();
+    void* mem = 0;
+    if (alloc == 0 || -1 == alloc->find(bound_name_.c_str(), mem)) {
+      VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
+                "peer allocator not found, receive_bytes will close link\n",
+                link_), 1);
+      control_ = 0;
+      current_data_ = 0;
+      handle_dds_input(ACE_INVALID_HANDLE); // will return 0 to the TRecvStrateg.
+      return progress;
+    }
 
-  for (ShmemData* start = 0; current_data_->status_ == ShmemData::Free ||
-         current_data_->status_ == ShmemData::RecvDone; ++current_data_) {
-    if (!start) {
-      start = current_data_;
-    } else if (start == current_data_) {
-      return; // none found => don't call handle_dds_input()
+    control_ = reinterpret_cast<ShmemControl*>(mem);
+    const ACE_UINT32 tail = control_->tail_.load_acquire();
+    if (control_->head_.load_acquire() == tail) {
+      current_data_ = 0;
+      return progress; // none found => don't call handle_dds_input()
     }
-    if (current_data_[1].status_ == ShmemData::EndOfAlloc) {
-      current_data_ = reinterpret_cast<ShmemData*>(mem) - 1; // incremented by the for loop
+
+    VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
+          "reading at control block #%u\n",
+          link_, tail & (control_->capacity_ - 1)));
+    // handle_dds_input() will call our receive_bytes() to get the data.
+    current_data_ = &control_->slot(tail);
+    handle_dds_input(ACE_INVALID_HANDLE);
+    if (!partial_recv_remaining_ && control_->tail_.load_acquire() == tail) {
+      return progress; // receive_bytes didn't consume the slot, link is closing
     }
+    progress = true;
   }
-
-  VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
-        "reading at control block #%d\n",
-        link_, current_data_ - reinterpret_cast<ShmemData*>(mem)));
-  // If we get this far, current_data_ points to the first ShmemData::DataInUse.
-  // handle_dds_input() will call our receive_bytes() to get the data.
-  handle_dds_input(ACE_INVALID_HANDLE);
 }
 
 ssize_t
@@ -91,7 +97,7 @@ ShmemReceiveStrategy::receive_bytes(iovec iov[],
   ShmemAllocator* alloc = link_->peer_allocator();
   void* mem;
   if (!alloc || -1 == alloc->find(bound_name_.c_str(), mem) || !current_data_
-      || current_data_->status_ != ShmemData::InUse) {
+      || mem != control_) {
     VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::receive_bytes closing\n"),
              1);
     gracefully_disconnected_ = true; // do not attempt reconnect via relink()
@@ -164,14 +170,15 @@ ShmemReceiveStrategy::receive_bytes(iovec iov[],
     partial_recv_ptr_ = src_iter;
     VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::receive_bytes "
           "receive was partial\n"));
-    link_->signal_semaphore();
 
   } else {
     partial_recv_remaining_ = 0;
     partial_recv_ptr_ = 0;
     VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::receive_bytes "
           "receive done\n"));
-    current_data_->status_ = ShmemData::RecvDone;
+    // Let the sender reuse the slot and release the payload.
+    control_->tail_.store_release(control_->tail_.load_acquire() + 1);
+    current_data_ = 0;
   }
 
   return total;
@@ -20,6 +20,7 @@ namespace OpenDDS {
 namespace DCPS {
 
 class ShmemDataLink;
+struct ShmemControl;
 struct ShmemData;
 
 class OpenDDS_Shmem_Export ShmemReceiveStrategy
@@ -27,7 +28,9 @@ class OpenDDS_Shmem_Export ShmemReceiveStrategy
 public:
   explicit ShmemReceiveStrategy(ShmemDataLink* link);
 
-  void read();
+  /// Receive everything available from the peer.  Returns true if anything
+  /// was received.
+  bool read();
 
 protected:
   virtual ssize_t receive_bytes(iovec iov[],
@@ -45,6 +48,7 @@ protected:
 private:
   ShmemDataLink* link_;
   std::string bound_name_;
+  ShmemControl* control_;
   ShmemData* current_data_;
   size_t partial_recv_remaining_;
   const char* partial_recv_ptr_;
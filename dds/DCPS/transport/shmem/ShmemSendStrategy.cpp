@@ -8,10 +8,12 @@
 #include "ShmemSendStrategy.h"
 #include "ShmemDataLink.h"
 #include "ShmemInst.h"
+#include "ShmemTransport.h"
 
 #include "dds/DCPS/transport/framework/NullSynchStrategy.h"
 
 #include <cstring>
+#include <new>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -24,7 +26,9 @@ ShmemSendStrategy::ShmemSendStrategy(ShmemDataLink* link)
                           link->transport_priority(),
                           make_rch<NullSynchStrategy>())
   , link_(link)
-  , current_data_(0)
+  , peer_read_waiting_(0)
+  , head_(0)
+  , reclaimed_(0)
   , datalink_control_size_(link->config()->datalink_control_size())
 {
 #ifdef OPENDDS_SHMEM_UNIX
@@ -38,8 +42,19 @@ ShmemSendStrategy::start_i()
   bound_name_ = "Write-" + link_->peer_address();
   ShmemAllocator* alloc = link_->local_allocator();
 
-  const size_t n_elems = datalink_control_size_ / sizeof(ShmemData),
-    extra = datalink_control_size_ % sizeof(ShmemData);
+  // The number of slots is rounded down to a power of 2 so that the ring's
+  // free-running counters map to slots without a discontinuity when they wrap.
+  const size_t max_slots = datalink_control_size_ > sizeof(ShmemControl)
+    ? (datalink_control_size_ - sizeof(ShmemControl)) / sizeof(ShmemData) : 0;
+  if (max_slots == 0) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
+              "datalink_control_size %B is too small\n", link_, datalink_control_size_), 0);
+    return false;
+  }
+  ACE_UINT32 capacity = 1;
+  while (capacity <= max_slots / 2 && capacity < 0x80000000u) {
+    capacity *= 2;
+  }
 
   void* mem = 0;
   if (alloc == 0 || (mem = alloc->calloc(datalink_control_size_)) == 0) {
@@ -48,12 +63,17 @@ ShmemSendStrategy::start_i()
     return false;
   }
 
-  ShmemData* data = reinterpret_cast<ShmemData*>(mem);
-  const size_t limit = (extra >= sizeof(int)) ? n_elems : (n_elems - 1);
-  data[limit].status_ = ShmemData::EndOfAlloc;
+  ShmemControl* const control = new(mem) ShmemControl;
+  control->capacity_ = capacity;
+  control->head_.store_release(0);
+  control->tail_.store_release(0);
+  head_ = reclaimed_ = 0;
   alloc->bind(bound_name_.c_str(), mem);
 
   ShmemAllocator* peer = link_->peer_allocator();
+  if (peer->find("ReadWaiting", mem) == 0) {
+    peer_read_waiting_ = reinterpret_cast<ShmemAtomicU32*>(mem);
+  }
   peer->find("Semaphore", mem);
   ShmemSharedSemaphore* sem = reinterpret_cast<ShmemSharedSemaphore*>(mem);
 #if defined OPENDDS_SHMEM_WINDOWS
@@ -76,7 +96,7 @@ ShmemSendStrategy::start_i()
 ssize_t
 ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
 {
-  const size_t hdr_sz = sizeof(current_data_->transport_header_);
+  const size_t hdr_sz = TRANSPORT_HDR_SERIALIZED_SZ;
   if (static_cast<size_t>(iov[0].iov_len) != hdr_sz) {
     VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
               "expecting iov[0] of size %B, got %B\n",
@@ -91,87 +111,60 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
     return -1;
   }
 
-  //FUTURE: use the ShmemTransport object to see if we already have the
-  //        same payload data available in the pool (from other DataLinks),
-  //        and if so, add a refcount to the start of the "from_pool" allocation
-
   size_t pool_alloc_size = 0;
   for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
     pool_alloc_size += iov[i].iov_len;
   }
 
+  // The payload is written to the pool once per packet, DataLinks to other
+  // processes sending the same packet share it.
+  ShmemTransport_rch transport = link_->transport();
   ShmemAllocator* alloc = link_->local_allocator();
-  void* from_pool = 0;
-  if (alloc == 0 || (from_pool = alloc->malloc(pool_alloc_size)) == 0) {
+  char* const payload = (transport && alloc)
+    ? transport->acquire_payload(current_packet_first_element(), iov, n, pool_alloc_size) : 0;
+  if (!payload) {
     VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ failed "
               "to allocate %B bytes for data\n", link_, pool_alloc_size), 0);
     errno = ENOMEM;
     return -1;
   }
 
-  char* payload = reinterpret_cast<char*>(from_pool);
-  char* iter = payload;
-  for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
-    std::memcpy(iter, iov[i].iov_base, iov[i].iov_len);
-    iter += iov[i].iov_len;
-  }
-
   void* mem = 0;
   if (-1 == alloc->find(bound_name_.c_str(), mem) || mem == 0) {
     VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ failed "
               "to find control segment with bound name %C\n", link_, bound_name_.c_str()), 0);
+    transport->release_payload(payload);
     errno = ENOENT;
     return -1;
   }
 
-  for (ShmemData* it = reinterpret_cast<ShmemData*>(mem);
-       it->status_ != ShmemData::EndOfAlloc; ++it) {
-    if (it->status_ == ShmemData::RecvDone) {
-      alloc->free(it->payload_);
-      // This will eventually be refcounted so instead of a free(), the previous
-      // statement would decrement the refcount and check for 0 before free().
-      // See the 'FUTURE' comment above.
-      it->status_ = ShmemData::Free;
-      VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
-                "releasing control block #%d\n", link_,
-                it - reinterpret_cast<ShmemData*>(mem)), 5);
-    }
-  }
+  ShmemControl* const control = reinterpret_cast<ShmemControl*>(mem);
 
-  if (!current_data_) {
-    current_data_ = reinterpret_cast<ShmemData*>(mem);
-  }
-
-  for (ShmemData* start = 0; current_data_->status_ == ShmemData::InUse ||
-         current_data_->status_ == ShmemData::RecvDone; ++current_data_) {
-    if (!start) {
-      start = current_data_;
-    } else if (start == current_data_) {
-      VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ out of "
-                "space for control\n", link_), 0);
-      return -1;
-    }
-    if (current_data_[1].status_ == ShmemData::EndOfAlloc) {
-      current_data_ = reinterpret_cast<ShmemData*>(mem) - 1; // incremented by the for loop
-    }
-  }
+  // Slots before the receiver's tail_ have been read, release their payloads.
+  transport->release_payloads(*control, reclaimed_, control->tail_.load_acquire());
 
-  if (current_data_->status_ == ShmemData::Free) {
-    VDBG((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
-          "writing at control block #%d header %@ payload %@ len %B\n",
-          link_, current_data_ - reinterpret_cast<ShmemData*>(mem),
-          current_data_->transport_header_, payload, pool_alloc_size));
-    std::memcpy(current_data_->transport_header_, iov[0].iov_base,
-                sizeof(current_data_->transport_header_));
-    current_data_->payload_ = payload;
-    current_data_->status_ = ShmemData::InUse;
-  } else {
-    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
-              "failed to find space for control\n", link_), 0);
+  if (head_ - reclaimed_ >= control->capacity_) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ out of "
+              "space for control\n", link_), 0);
+    transport->release_payload(payload);
     return -1;
   }
 
-  ACE_OS::sema_post(&peer_semaphore_);
+  ShmemData& slot = control->slot(head_);
+  VDBG((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
+        "writing at control block #%u header %@ payload %@ len %B\n",
+        link_, head_ & (control->capacity_ - 1),
+        slot.transport_header_, payload, pool_alloc_size));
+  std::memcpy(slot.transport_header_, iov[0].iov_base, sizeof(slot.transport_header_));
+  slot.payload_ = payload;
+  control->head_.store_release(++head_);
+
+  // The receiving process only needs to be woken up if its ReadTask is (about
+  // to be) waiting on the semaphore, see ShmemTransport::ReadTask::svc().
+  ShmemAtomicU32::full_fence();
+  if (!peer_read_waiting_ || peer_read_waiting_->load_acquire()) {
+    ACE_OS::sema_post(&peer_semaphore_);
+  }
 
   return static_cast<ssize_t>(pool_alloc_size + iov[0].iov_len);
 }
@@ -179,6 +172,15 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
 void
 ShmemSendStrategy::stop_i()
 {
+  // The peer won't read the rest of the ring, release the payloads it still
+  // references.
+  ShmemTransport_rch transport = link_->transport();
+  ShmemAllocator* alloc = link_->local_allocator();
+  void* mem = 0;
+  if (transport && alloc && alloc->find(bound_name_.c_str(), mem) == 0 && mem) {
+    transport->release_payloads(*reinterpret_cast<ShmemControl*>(mem), reclaimed_, head_);
+  }
+
 #ifdef OPENDDS_SHMEM_WINDOWS
   ::CloseHandle(peer_semaphore_);
 #endif
@@ -23,7 +23,7 @@ namespace DCPS {
 
 class ShmemDataLink;
 class ShmemInst;
-struct ShmemData;
+struct ShmemAtomicU32;
 typedef RcHandle<ShmemInst> ShmemInst_rch;
 
 class OpenDDS_Shmem_Export ShmemSendStrategy
@@ -41,7 +41,11 @@ private:
   ShmemDataLink* link_;
   std::string bound_name_;
   ACE_sema_t peer_semaphore_;
-  ShmemData* current_data_;
+  ShmemAtomicU32* peer_read_waiting_;
+  /// Copy of the control ring's head_ (only this object writes it).
+  ACE_UINT32 head_;
+  /// Slots before this have had their payloads released.
+  ACE_UINT32 reclaimed_;
   const size_t datalink_control_size_;
 };
 
@@ -14,11 +14,15 @@
 #include <dds/DCPS/NetworkResource.h>
 #include <dds/DCPS/transport/framework/TransportExceptions.h>
 #include <dds/DCPS/transport/framework/TransportClient.h>
+#include <dds/DCPS/transport/framework/TransportQueueElement.h>
 
 #include <ace/Log_Msg.h>
 
 #include <sstream>
 #include <cstring>
+#include <new>
+#include <algorithm>
+#include <functional>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -199,7 +203,19 @@ ShmemTransport::configure_i(const ShmemInst_rch& config)
                      false);
   }
 
-  read_task_.reset(new ReadTask(this, ace_sema));
+  mem = alloc_->calloc(sizeof(ShmemAtomicU32));
+  if (mem == 0) {
+    if (log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: ShmemTransport::configure_i: failed to allocate"
+                 " space for read status in shared memory!\n"));
+    }
+    return false;
+  }
+  ShmemAtomicU32* const waiting = new(mem) ShmemAtomicU32;
+  waiting->store_release(0);
+  alloc_->bind("ReadWaiting", waiting);
+
+  read_task_.reset(new ReadTask(this, ace_sema, waiting, config->busy_poll_spins()));
 
   VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemTransport %@ configured with address %C\n",
             this, config->poolname().c_str()), 1);
@@ -229,6 +245,10 @@ ShmemTransport::shutdown_i()
 
   read_task_.reset();
 
+  GuardType payloads_guard(payloads_lock_);
+  payloads_.clear();
+  payload_keys_.clear();
+
   if (alloc_) {
 #ifndef OPENDDS_SHMEM_UNSUPPORTED
     void* mem = 0;
@@ -298,9 +318,12 @@ ShmemTransport::release_datalink(DataLink* link)
             link), 1);
 }
 
-ShmemTransport::ReadTask::ReadTask(ShmemTransport* outer, ACE_sema_t semaphore)
+ShmemTransport::ReadTask::ReadTask(ShmemTransport* outer, ACE_sema_t semaphore,
+                                   ShmemAtomicU32* waiting, ACE_UINT32 busy_poll_spins)
   : outer_(outer)
   , semaphore_(semaphore)
+  , waiting_(waiting)
+  , busy_poll_spins_(busy_poll_spins)
   , stopped_(false)
 {
   activate();
@@ -311,12 +334,36 @@ ShmemTransport::ReadTask::svc()
 {
   ThreadStatusManager::Start s(TheServiceParticipant->get_thread_status_manager(), "ShmemTransport");
 
+  ACE_UINT32 idle_spins = 0;
   while (!stopped_) {
-    ACE_OS::sema_wait(&semaphore_);
-    if (stopped_) {
-      return 0;
+    if (outer_->read_from_links()) {
+      idle_spins = 0;
+      continue;
     }
-    outer_->read_from_links();
+
+    // Keep polling for a while after receiving something, the sender is likely
+    // to write more and this avoids a semaphore wait and post per sample.
+    if (idle_spins < busy_poll_spins_) {
+      ++idle_spins;
+      if (idle_spins % 64 == 0) {
+        ACE_OS::thr_yield();
+      }
+      continue;
+    }
+
+    // Announce the wait before checking the links one last time so a sender
+    // either sees waiting_ set and posts, or wrote before the check.
+    waiting_->store_release(1);
+    ShmemAtomicU32::full_fence();
+    if (outer_->read_from_links()) {
+      waiting_->store_release(0);
+      idle_spins = 0;
+      continue;
+    }
+
+    ACE_OS::sema_wait(&semaphore_);
+    waiting_->store_release(0);
+    idle_spins = 0;
   }
   return 0;
 }
@@ -333,16 +380,7 @@ ShmemTransport::ReadTask::stop()
   wait();
 }
 
-void
-ShmemTransport::ReadTask::signal_semaphore()
-{
-  if (stopped_) {
-    return;
-  }
-  ACE_OS::sema_post(&semaphore_);
-}
-
-void
+bool
 ShmemTransport::read_from_links()
 {
   std::vector<ShmemDataLink_rch> dl_copies;
@@ -354,19 +392,141 @@ ShmemTransport::read_from_links()
     }
   }
 
+  bool progress = false;
   typedef std::vector<ShmemDataLink_rch>::iterator dl_iter_t;
   for (dl_iter_t dl_it = dl_copies.begin(); !is_shut_down() && dl_it != dl_copies.end(); ++dl_it) {
-    dl_it->in()->read();
+    if (dl_it->in()->read()) {
+      progress = true;
+    }
+  }
+  return progress;
+}
+
+bool
+ShmemTransport::PayloadKey::operator<(const PayloadKey& other) const
+{
+  if (sequence_ != other.sequence_) {
+    return sequence_ < other.sequence_;
+  }
+  if (size_ != other.size_) {
+    return size_ < other.size_;
+  }
+  if (publication_ != other.publication_) {
+    return publication_ < other.publication_;
   }
+  return std::lexicographical_compare(data_.begin(), data_.end(),
+                                      other.data_.begin(), other.data_.end(),
+                                      std::less<const void*>());
+}
+
+namespace {
+  /// Does "payload" hold the bytes of iov[1..n-1]?
+  bool same_payload(const char* payload, const iovec iov[], int n)
+  {
+    for (int i = 1; i < n; ++i) {
+      if (std::memcmp(payload, iov[i].iov_base, iov[i].iov_len) != 0) {
+        return false;
+      }
+      payload += iov[i].iov_len;
+    }
+    return true;
+  }
+}
+
+char*
+ShmemTransport::acquire_payload(const TransportQueueElement* first,
+                                const iovec iov[], int n, size_t size)
+{
+  // Only data samples have an identity that is the same on all DataLinks.
+  const bool shareable = first && n > 1 && first->publication_id() != GUID_UNKNOWN
+    && first->sequence() != SequenceNumber::SEQUENCENUMBER_UNKNOWN();
+  PayloadKey key;
+  key.size_ = size;
+  if (shareable) {
+    key.publication_ = first->publication_id();
+    key.sequence_ = first->sequence();
+    key.data_.reserve(n - 1);
+    for (int i = 1; i < n; ++i) {
+      key.data_.push_back(iov[i].iov_base);
+    }
+
+    GuardType guard(payloads_lock_);
+    const PayloadMap::iterator it = payloads_.find(key);
+    if (it != payloads_.end()) {
+      // The sample's memory can be changed in place while it's being sent
+      // (WriteDataContainer sets HISTORIC_SAMPLE_FLAG in the header), so
+      // the key alone doesn't mean the bytes are the same.
+      if (same_payload(it->second, iov, n)) {
+        ++(reinterpret_cast<ShmemPayloadHeader*>(it->second) - 1)->refcount_;
+        VDBG((LM_DEBUG, "(%P|%t) ShmemTransport::acquire_payload "
+              "sharing payload %@ len %B\n", it->second, size));
+        return it->second;
+      }
+      // DataLinks holding the old copy keep it, it just isn't shared anymore.
+      payload_keys_.erase(it->second);
+      payloads_.erase(it);
+    }
+  }
+
+  // Copy outside of payloads_lock_, the allocator has its own lock.
+  void* mem = alloc_ ? alloc_->malloc(sizeof(ShmemPayloadHeader) + size) : 0;
+  if (!mem) {
+    return 0;
+  }
+
+  ShmemPayloadHeader* const header = static_cast<ShmemPayloadHeader*>(mem);
+  header->refcount_ = 1;
+  header->reserved_ = 0;
+  char* const payload = reinterpret_cast<char*>(header + 1);
+  char* iter = payload;
+  for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
+    std::memcpy(iter, iov[i].iov_base, iov[i].iov_len);
+    iter += iov[i].iov_len;
+  }
+
+  if (shareable) {
+    GuardType guard(payloads_lock_);
+    // If another DataLink got here first this copy just isn't shared.
+    if (payloads_.insert(PayloadMap::value_type(key, payload)).second) {
+      payload_keys_[payload] = key;
+    }
+  }
+  return payload;
 }
 
 void
-ShmemTransport::signal_semaphore()
+ShmemTransport::release_payload(char* payload)
 {
-  if (is_shut_down()) {
+  if (!payload) {
+    return;
+  }
+
+  GuardType guard(payloads_lock_);
+  if (!alloc_) {
+    return; // the pool is already gone
+  }
+
+  ShmemPayloadHeader* const header = reinterpret_cast<ShmemPayloadHeader*>(payload) - 1;
+  if (--header->refcount_) {
     return;
   }
-  read_task_->signal_semaphore();
+
+  const PayloadKeyMap::iterator it = payload_keys_.find(payload);
+  if (it != payload_keys_.end()) {
+    payloads_.erase(it->second);
+    payload_keys_.erase(it);
+  }
+
+  alloc_->free(header);
+}
+
+void
+ShmemTransport::release_payloads(ShmemControl& control, ACE_UINT32& from, ACE_UINT32 to)
+{
+  for (; from != to; ++from) {
+    ShmemData& slot = control.slot(from);
+    release_payload(slot.payload_);
+  }
 }
 
 std::string
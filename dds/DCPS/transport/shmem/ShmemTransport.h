@@ -23,6 +23,7 @@ namespace OpenDDS {
 namespace DCPS {
 
 class ShmemInst;
+class TransportQueueElement;
 
 class OpenDDS_Shmem_Export ShmemTransport : public TransportImpl {
 public:
@@ -32,7 +33,21 @@ public:
   // used by our DataLink:
   ShmemAllocator* alloc() { return alloc_.get(); }
   std::string address();
-  void signal_semaphore();
+
+  /// Get a pool allocation holding iov[1..n-1] (everything but the transport
+  /// header) for the packet starting with "first".  If another DataLink
+  /// already wrote the same packet and hasn't released it, that allocation
+  /// is shared instead of making a copy.  Returns 0 if the pool is full.
+  char* acquire_payload(const TransportQueueElement* first,
+                        const iovec iov[], int n, size_t size);
+
+  /// Drop a reference taken by acquire_payload(), freeing the allocation
+  /// once no DataLink is using it.
+  void release_payload(char* payload);
+
+  /// Release the payloads of the slots of "control" from counter value
+  /// "from" up to (not including) "to", and advance "from" to "to".
+  void release_payloads(ShmemControl& control, ACE_UINT32& from, ACE_UINT32 to);
 
   ShmemInst_rch config() const;
 
@@ -68,7 +83,7 @@ private:
 
   std::pair<std::string, std::string> blob_to_key(const TransportBLOB& blob);
 
-  void read_from_links(); // callback from ReadTask
+  bool read_from_links(); // callback from ReadTask, true if anything was read
 
   typedef ACE_Thread_Mutex LockType;
   typedef ACE_Guard<LockType> GuardType;
@@ -82,16 +97,38 @@ private:
 
   unique_ptr<ShmemAllocator> alloc_;
 
+  /// Identifies a packet by its first sample and the memory it's sent from.
+  /// The data pointers can only match for the same samples because they
+  /// keep the memory alive while they are being sent.
+  struct PayloadKey {
+    GUID_t publication_;
+    SequenceNumber sequence_;
+    OPENDDS_VECTOR(const void*) data_;
+    size_t size_;
+
+    bool operator<(const PayloadKey& other) const;
+  };
+
+  LockType payloads_lock_;
+  typedef OPENDDS_MAP(PayloadKey, char*) PayloadMap;
+  PayloadMap payloads_;
+  typedef OPENDDS_MAP(char*, PayloadKey) PayloadKeyMap;
+  PayloadKeyMap payload_keys_;
+
   class ReadTask : public ACE_Task_Base {
   public:
-    ReadTask(ShmemTransport* outer, ACE_sema_t semaphore);
+    ReadTask(ShmemTransport* outer, ACE_sema_t semaphore,
+             ShmemAtomicU32* waiting, ACE_UINT32 busy_poll_spins);
     int svc();
     void stop();
-    void signal_semaphore();
 
   private:
     ShmemTransport* outer_;
     ACE_sema_t semaphore_;
+    /// In the pool, nonzero while this task is (about to be) waiting on
+    /// semaphore_.  Senders only post semaphore_ when it's set.
+    ShmemAtomicU32* waiting_;
+    const ACE_UINT32 busy_poll_spins_;
     AtomicBool stopped_;
   };
   unique_ptr<ReadTask> read_task_;
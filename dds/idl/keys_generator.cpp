@@ -12,16 +12,21 @@
 #include "utl_identifier.h"
 
 #include <string>
+#include <vector>
 using std::string;
 
 struct KeyLessThanWrapper {
   size_t n_;
   const string cxx_name_;
+  const string local_name_;
+  std::vector<string> members_;
 
   explicit KeyLessThanWrapper(UTL_ScopedName* name)
     : n_(0)
     , cxx_name_(scoped(name))
+    , local_name_(name->last_component()->get_string())
   {
+    be_global->add_include("dds/DCPS/KeyHash.h", BE_GlobalData::STREAM_H);
     be_global->header_ << be_global->versioning_begin() << "\n";
 
     for (UTL_ScopedName* sn = name; sn && sn->tail();
@@ -63,18 +68,53 @@ struct KeyLessThanWrapper {
     be_global->header_ <<
       "    if (v1." << member << " < v2." << member << ") return true;\n"
       "    if (v2." << member << " < v1." << member << ") return false;\n";
+    members_.push_back(member);
   }
 
   ~KeyLessThanWrapper()
   {
     be_global->header_ <<
       "    return false;\n"
+      "  }\n};\n\n"
+      "/// Hash of the keys, consistent with " << local_name_ << "_OpenDDS_KeyLessThan.\n"
+      "struct " << be_global->export_macro() << ' ' << local_name_ << "_OpenDDS_KeyHash {\n";
+    if (members_.empty()) {
+      be_global->header_ <<
+        "  size_t operator()(const " << cxx_name_ << "&) const\n"
+        "  {\n"
+        "    return 0;\n";
+    } else {
+      be_global->header_ <<
+        "  size_t operator()(const " << cxx_name_ << "& v) const\n"
+        "  {\n"
+        "    size_t seed = 0;\n";
+      for (size_t i = 0; i < members_.size(); ++i) {
+        be_global->header_ <<
+          "    OpenDDS::DCPS::hash_key_member(seed, v." << members_[i] << ");\n";
+      }
+      be_global->header_ <<
+        "    return seed;\n";
+    }
+    be_global->header_ <<
       "  }\n};\n";
 
     for (size_t i = 0; i < n_; ++i) {
       be_global->header_ << "}\n";
     }
 
+    // Key members of other types have no hash_key_member overload, so using
+    // them fails to compile instead of hashing their bytes.
+    be_global->header_ <<
+      "\nnamespace OpenDDS {\n"
+      "namespace DCPS {\n"
+      "/// Hash of a struct that is a key member of another struct.\n"
+      "inline void hash_key_member(size_t& seed, const" << cxx_name_ << "& value)\n"
+      "{\n"
+      "  hash_combine(seed," << cxx_name_ << "_OpenDDS_KeyHash()(value));\n"
+      "}\n"
+      "}\n"
+      "}\n";
+
     be_global->header_ << be_global->versioning_end() << "\n";
   }
 };
@@ -2372,6 +2372,11 @@ namespace {
         "    && ";
     }
 
+    bool customized() const
+    {
+      return !cst_.empty() || !intro_.line_vec.empty();
+    }
+
     std::map<string, string> cst_;
     string iQosOffset_;
     Intro intro_;
@@ -2784,6 +2789,83 @@ namespace {
     return true;
   }
 
+  size_t plain_primitive_size(AST_Type* type)
+  {
+    AST_PredefinedType* const p = dynamic_cast<AST_PredefinedType*>(type);
+    if (!p) {
+      return 0;
+    }
+    switch (p->pt()) {
+    case AST_PredefinedType::PT_char:
+    case AST_PredefinedType::PT_octet:
+#if OPENDDS_HAS_EXPLICIT_INTS
+    case AST_PredefinedType::PT_uint8:
+    case AST_PredefinedType::PT_int8:
+#endif
+      return 1;
+    case AST_PredefinedType::PT_short:
+    case AST_PredefinedType::PT_ushort:
+      return 2;
+    case AST_PredefinedType::PT_long:
+    case AST_PredefinedType::PT_ulong:
+    case AST_PredefinedType::PT_float:
+      return 4;
+    case AST_PredefinedType::PT_longlong:
+    case AST_PredefinedType::PT_ulonglong:
+    case AST_PredefinedType::PT_double:
+      return 8;
+    default:
+      // boolean needs validation when read, wchar and long double don't have
+      // the same size in memory as in the stream.
+      return 0;
+    }
+  }
+
+  /**
+   * A plain struct only has primitive members, or arrays of them, and each
+   * member starts on a multiple of its own size. That means there is no
+   * padding, so the struct's memory is the same as its serialized form in
+   * every encoding, as long as the bytes don't need swapping and the stream
+   * is aligned for the first member. Only the first member can have the
+   * largest alignment, so aligning for it is what field-by-field
+   * serialization would do anyway.
+   *
+   * Returns the serialized size of the struct, or 0 if it isn't plain.
+   */
+  size_t plain_struct_size(AST_Structure* node, size_t& first_align)
+  {
+    const Fields fields(node);
+    const Fields::Iterator fields_end = fields.end();
+    size_t size = 0;
+    first_align = 0;
+    for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+      AST_Field* const field = *i;
+      if (be_global->is_optional(field) || be_global->is_external(field)) {
+        return 0;
+      }
+      AST_Type* const type = resolveActualType(field->field_type());
+      size_t align = 0;
+      size_t count = 1;
+      if (type->node_type() == AST_Decl::NT_array) {
+        AST_Array* const arr = dynamic_cast<AST_Array*>(type);
+        align = plain_primitive_size(resolveActualType(arr->base_type()));
+        count = array_element_count(arr);
+      } else {
+        align = plain_primitive_size(type);
+      }
+      if (!align || size % align) {
+        return 0;
+      }
+      if (!first_align) {
+        first_align = align;
+      } else if (align > first_align) {
+        return 0;
+      }
+      size += align * count;
+    }
+    return size;
+  }
+
   bool generate_struct_deserialization(AST_Structure* node,
                                        FieldFilter field_filter)
   {
@@ -2844,6 +2926,24 @@ namespace {
           "\n";
       }
 
+      size_t plain_align = 0;
+      const size_t plain_size = field_filter == FieldFilter_All && !is_mutable && !rtpsCustom.customized() ?
+        plain_struct_size(node, plain_align) : 0;
+      if (plain_size) {
+        be_global->impl_ <<
+          "  if (!strm.swap_bytes()";
+        if (is_appendable) {
+          be_global->impl_ <<
+            " && (encoding.xcdr_version() != Encoding::XCDR_VERSION_2 || total_size == " << plain_size << ")";
+        }
+        be_global->impl_ << ") {\n"
+          "    // Plain struct, see the note in operator<<.\n"
+          "    return strm.align_r(" << plain_align << ")\n"
+          "      && strm.read_octet_array(reinterpret_cast<ACE_CDR::Octet*>(&stru), " << plain_size << ");\n"
+          "  }\n"
+          "\n";
+      }
+
       if (is_mutable) {
         be_global->impl_ <<
           "  if (encoding.xcdr_version() != Encoding::XCDR_VERSION_NONE) {\n"
@@ -3182,6 +3282,20 @@ namespace {
         "      return false;\n"
         "    }\n", not_final);
 
+      size_t plain_align = 0;
+      const size_t plain_size = field_filter == FieldFilter_All && !is_mutable && !rtpsCustom.customized() ?
+        plain_struct_size(node, plain_align) : 0;
+      if (plain_size) {
+        be_global->impl_ <<
+          "  if (!strm.swap_bytes()) {\n"
+          "    // All members are primitives laid out without padding, so the\n"
+          "    // struct can be copied as is.\n"
+          "    return strm.align_w(" << plain_align << ")\n"
+          "      && strm.write_octet_array(reinterpret_cast<const ACE_CDR::Octet*>(&stru), " << plain_size << ");\n"
+          "  }\n"
+          "\n";
+      }
+
       // Mutable Code
       std::ostringstream mutable_fields;
       Intro intro = rtpsCustom.intro_;
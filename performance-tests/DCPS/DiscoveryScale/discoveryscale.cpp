@@ -0,0 +1,164 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "MessengerTypeSupportImpl.h"
+
+#include <dds/DCPS/Marked_Default_Qos.h>
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/TimeTypes.h>
+
+#include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+
+#include <dds/DCPS/StaticIncludes.h>
+
+#include <ace/Get_Opt.h>
+#include <ace/OS_NS_stdlib.h>
+#include <ace/OS_NS_stdio.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+using OpenDDS::DCPS::MonotonicTimePoint;
+using OpenDDS::DCPS::TimeDuration;
+
+namespace {
+
+int pairs = 500;
+int step = 50;
+
+bool parse_args(int argc, ACE_TCHAR* argv[])
+{
+  ACE_Get_Opt get_opts(argc, argv, ACE_TEXT("n:s:"));
+  int c;
+  while ((c = get_opts()) != -1) {
+    switch (c) {
+    case 'n':
+      pairs = ACE_OS::atoi(get_opts.opt_arg());
+      break;
+    case 's':
+      step = ACE_OS::atoi(get_opts.opt_arg());
+      break;
+    default:
+      ACE_ERROR((LM_ERROR, "usage: %s [-n <pairs>] [-s <step>]\n", argv[0]));
+      return false;
+    }
+  }
+  if (pairs < 1 || step < 1) {
+    ACE_ERROR((LM_ERROR, "ERROR: -n and -s must be positive\n"));
+    return false;
+  }
+  return true;
+}
+
+DDS::PartitionQosPolicy partition(int i)
+{
+  char name[32];
+  ACE_OS::snprintf(name, sizeof name, "p%d", i);
+  DDS::PartitionQosPolicy policy;
+  policy.name.length(1);
+  policy.name[0] = name;
+  return policy;
+}
+
+bool wait_for_match(DDS::DataWriter_ptr writer, const MonotonicTimePoint& deadline)
+{
+  DDS::InstanceHandleSeq handles;
+  while (true) {
+    if (writer->get_matched_subscriptions(handles) != DDS::RETCODE_OK) {
+      return false;
+    }
+    if (handles.length() > 1) {
+      return false;
+    }
+    if (handles.length() == 1) {
+      return true;
+    }
+    if (MonotonicTimePoint::now() > deadline) {
+      return false;
+    }
+    ACE_OS::sleep(TimeDuration::from_msec(10).value());
+  }
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 0;
+  DDS::DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  if (!parse_args(argc, argv)) {
+    return 1;
+  }
+
+  DDS::DomainParticipant_var participant =
+    dpf->create_participant(42, PARTICIPANT_QOS_DEFAULT, 0, OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  if (!participant) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: create_participant failed\n"), 1);
+  }
+
+  Messenger::MessageTypeSupport_var ts = new Messenger::MessageTypeSupportImpl;
+  if (ts->register_type(participant, "") != DDS::RETCODE_OK) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: register_type failed\n"), 1);
+  }
+  CORBA::String_var type_name = ts->get_type_name();
+  DDS::Topic_var topic = participant->create_topic("DiscoveryScale", type_name,
+    TOPIC_QOS_DEFAULT, 0, OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  if (!topic) {
+    ACE_ERROR_RETURN((LM_ERROR, "ERROR: create_topic failed\n"), 1);
+  }
+
+  DDS::PublisherQos pub_qos;
+  participant->get_default_publisher_qos(pub_qos);
+  DDS::SubscriberQos sub_qos;
+  participant->get_default_subscriber_qos(sub_qos);
+
+  // Each writer/reader pair has its own partition, so every writer should
+  // match exactly one reader however many endpoints there are.
+  std::vector<DDS::DataWriter_var> writers;
+  ACE_DEBUG((LM_INFO, "endpoints,usec_per_endpoint\n"));
+  for (int i = 0; i < pairs;) {
+    const MonotonicTimePoint start = MonotonicTimePoint::now();
+    const int first = i;
+    const int end = std::min(i + step, pairs);
+    for (; i < end; ++i) {
+      pub_qos.partition = partition(i);
+      DDS::Publisher_var pub =
+        participant->create_publisher(pub_qos, 0, OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      sub_qos.partition = partition(i);
+      DDS::Subscriber_var sub =
+        participant->create_subscriber(sub_qos, 0, OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      if (!pub || !sub) {
+        ACE_ERROR_RETURN((LM_ERROR, "ERROR: create_publisher/subscriber failed\n"), 1);
+      }
+      DDS::DataWriter_var writer = pub->create_datawriter(topic, DATAWRITER_QOS_DEFAULT, 0,
+                                                          OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      DDS::DataReader_var reader = sub->create_datareader(topic, DATAREADER_QOS_DEFAULT, 0,
+                                                          OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      if (!writer || !reader) {
+        ACE_ERROR_RETURN((LM_ERROR, "ERROR: create_datawriter/datareader failed\n"), 1);
+      }
+      writers.push_back(writer);
+    }
+    const TimeDuration elapsed = MonotonicTimePoint::now() - start;
+    ACE_DEBUG((LM_INFO, "%d,%.1f\n", 2 * i,
+               elapsed.to_double() * 1e6 / (2 * (i - first))));
+  }
+
+  const MonotonicTimePoint deadline = MonotonicTimePoint::now() + TimeDuration(60);
+  for (size_t i = 0; i < writers.size(); ++i) {
+    if (!wait_for_match(writers[i], deadline)) {
+      ACE_ERROR((LM_ERROR, "ERROR: writer %B did not match exactly one reader\n", i));
+      status = 1;
+      break;
+    }
+  }
+
+  participant->delete_contained_entities();
+  dpf->delete_participant(participant);
+  TheServiceParticipant->shutdown();
+  return status;
+}
@@ -0,0 +1,28 @@
+eval '(exit $?0)' && eval 'exec perl -S $0 ${1+"$@"}'
+     & eval 'exec perl -S $0 $argv:q'
+     if 0;
+
+# -*- perl -*-
+
+use Env (DDS_ROOT);
+use lib "$DDS_ROOT/bin";
+use Env (ACE_ROOT);
+use lib "$ACE_ROOT/bin";
+use PerlDDS::Run_Test;
+use Getopt::Long;
+
+use strict;
+
+PerlDDS::add_lib_path('../../../tests/DCPS/ConsolidatedMessengerIdl');
+
+my $pairs = 500;
+my $step = 50;
+GetOptions('n=i' => \$pairs, 's=i' => \$step) or die("Invalid options\n");
+
+my $test = new PerlDDS::TestFramework();
+$test->{add_transport_config} = 0;
+
+$test->process('discoveryscale', 'discoveryscale', "-DCPSConfigFile rtps.ini -n $pairs -s $step");
+$test->start_process('discoveryscale');
+
+exit $test->finish(300);
@@ -0,0 +1,298 @@
+#include "TakeAction.h"
+
+#include "MemFunEvent.h"
+#include "Utils.h"
+#include "util.h"
+
+#include <dds/DCPS/WaitSet.h>
+
+namespace Bench {
+
+TakeAction::TakeAction(OpenDDS::DCPS::EventDispatcher_rch event_dispatcher)
+: event_dispatcher_(event_dispatcher)
+, started_(false)
+, stopped_(false)
+, stop_condition_(new DDS::GuardCondition())
+, data_dr_impl_(0)
+, dr_listener_(0)
+, take_period_(1, 0)
+, take_mode_(TAKE_COPY)
+, max_samples_(64)
+, timer_id_(-1)
+, in_do_take_(false)
+{
+}
+
+bool TakeAction::init(const ActionConfig& config, ActionReport& report, Builder::ReaderMap& readers,
+  Builder::WriterMap& writers, const Builder::ContentFilteredTopicMap& cft_map)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  Action::init(config, report, readers, writers, cft_map);
+
+  if (readers_by_index_.empty()) {
+    std::stringstream ss;
+    ss << "TakeAction '" << config.name << "' is missing a reader";
+    throw std::runtime_error(ss.str());
+  }
+
+  data_dr_ = DataDataReader::_narrow(readers_by_index_[0]->get_dds_datareader());
+  if (!data_dr_) {
+    std::stringstream ss;
+    ss << "TakeAction '" << config.name << "' is missing a valid Bench::Data datareader";
+    throw std::runtime_error(ss.str());
+  }
+  data_dr_impl_ = dynamic_cast<DataReaderImplType*>(data_dr_.in());
+
+  dr_listener_ = dynamic_cast<WorkerDataReaderListener*>(readers_by_index_[0]->get_dds_datareaderlistener().in());
+
+  auto take_period_prop = get_property(config.params, "take_period", Builder::PVK_DOUBLE);
+  if (take_period_prop) {
+    double period = take_period_prop->value.double_prop();
+    int64_t sec = static_cast<int64_t>(period);
+    uint64_t usec = static_cast<uint64_t>((period - static_cast<double>(sec)) * 1000000u);
+    take_period_ = OpenDDS::DCPS::TimeDuration(sec, static_cast<suseconds_t>(usec));
+  }
+
+  const auto take_mode_prop = get_property(config.params, "take_mode", Builder::PVK_STRING);
+  if (take_mode_prop) {
+    const std::string mode = take_mode_prop->value.string_prop();
+    if (mode == "copy") {
+      take_mode_ = TAKE_COPY;
+    } else if (mode == "zero_copy") {
+      take_mode_ = TAKE_ZERO_COPY;
+    } else if (mode == "loaned") {
+      take_mode_ = TAKE_LOANED;
+    } else {
+      std::stringstream ss;
+      ss << "TakeAction '" << config.name << "' has an unknown take_mode '" << mode
+        << "', expected 'copy', 'zero_copy', or 'loaned'";
+      throw std::runtime_error(ss.str());
+    }
+  }
+
+  if (take_mode_ == TAKE_LOANED && !data_dr_impl_) {
+    std::stringstream ss;
+    ss << "TakeAction '" << config.name << "' needs a local Bench::Data datareader for take_mode 'loaned'";
+    throw std::runtime_error(ss.str());
+  }
+
+  const auto max_samples_prop = get_property(config.params, "max_samples", Builder::PVK_ULL);
+  if (max_samples_prop && max_samples_prop->value.ull_prop()) {
+    max_samples_ = static_cast<CORBA::Long>(max_samples_prop->value.ull_prop());
+  }
+
+  // Create the report properties now, since the reader's listener keeps
+  // indexes into the same sequence while the test runs.
+  Builder::PropertySeq& properties = readers_by_index_[0]->get_report().properties;
+  const Builder::PropertySeq& global_properties = get_global_properties();
+  Builder::ConstPropertyIndex buffer_size_prop =
+    get_property(global_properties, "default_stat_median_buffer_size", Builder::PVK_ULL);
+  size_t buffer_size = buffer_size_prop ? static_cast<size_t>(buffer_size_prop->value.ull_prop()) : DEFAULT_STAT_BLOCK_BUFFER_SIZE;
+
+  get_or_create_property(properties, "take_mode", Builder::PVK_STRING)->value.string_prop(
+    take_mode_ == TAKE_COPY ? "copy" : take_mode_ == TAKE_ZERO_COPY ? "zero_copy" : "loaned");
+  take_duration_stat_block_ = std::make_shared<PropertyStatBlock>(properties, "take_duration", buffer_size);
+  take_sample_bytes_stat_block_ = std::make_shared<PropertyStatBlock>(properties, "take_sample_bytes", buffer_size);
+
+  event_ = OpenDDS::DCPS::make_rch<MemFunEvent<TakeAction> >(shared_from_this(), &TakeAction::do_take);
+
+  return true;
+}
+
+void TakeAction::test_start()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!started_) {
+    started_ = true;
+    read_condition_ = data_dr_->create_readcondition(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    ws_ = new DDS::WaitSet();
+    ws_->attach_condition(stop_condition_);
+    ws_->attach_condition(read_condition_);
+    timer_id_ = event_dispatcher_->schedule(event_);
+    if (timer_id_ < 0) {
+      std::cerr << "Failed to schedule event in TakeAction::test_start" << std::endl;
+    }
+  }
+}
+
+void TakeAction::test_stop()
+{
+}
+
+void TakeAction::action_stop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (started_ && !stopped_) {
+    stopped_ = true;
+    event_dispatcher_->cancel(timer_id_);
+    stop_condition_->set_trigger_value(true);
+    while (in_do_take_) {
+      cv_.wait(lock);
+    }
+    ws_->detach_condition(stop_condition_);
+    ws_->detach_condition(read_condition_);
+    data_dr_->delete_readcondition(read_condition_);
+    take_duration_stat_block_->finalize();
+    take_sample_bytes_stat_block_->finalize();
+  }
+}
+
+namespace {
+
+struct bool_guard {
+  bool_guard(bool& val, std::condition_variable& cv) : val_(val), cv_(cv) { val_ = true; }
+  ~bool_guard() { val_ = false; cv_.notify_all(); }
+  bool& val_;
+  std::condition_variable& cv_;
+};
+
+struct reverse_guard {
+  explicit reverse_guard(std::unique_lock<std::mutex>& val) : val_(val) { val_.unlock(); }
+  ~reverse_guard() { val_.lock(); }
+  std::unique_lock<std::mutex>& val_;
+};
+
+}
+
+void TakeAction::do_take()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool_guard bg(in_do_take_, cv_);
+  if (started_ && !stopped_) {
+    DDS::ConditionSeq active;
+    const DDS::Duration_t duration = take_period_.to_dds_duration();
+    DDS::WaitSet_var ws_copy = ws_;
+    DDS::ReturnCode_t ret;
+
+    {
+      reverse_guard rg(lock);
+      ret = ws_copy->wait(active, duration);
+    }
+
+    if (stopped_) {
+      return;
+    }
+
+    if (ret == DDS::RETCODE_OK) {
+      for (CORBA::ULong i = 0; !stopped_ && i < active.length(); ++i) {
+        if (active[i] == read_condition_) {
+          switch (take_mode_) {
+          case TAKE_COPY:
+            take_copy(lock);
+            break;
+          case TAKE_ZERO_COPY:
+            take_zero_copy(lock);
+            break;
+          case TAKE_LOANED:
+            take_loaned(lock);
+            break;
+          }
+        }
+      }
+    }
+
+    if (!stopped_) {
+      timer_id_ = event_dispatcher_->schedule(event_);
+      if (timer_id_ < 0) {
+        std::cerr << "Failed to schedule event in TakeAction::do_take" << std::endl;
+      }
+    }
+  }
+}
+
+void TakeAction::take_copy(std::unique_lock<std::mutex>& lock)
+{
+  DataSeq data(static_cast<CORBA::ULong>(max_samples_));
+  DDS::SampleInfoSeq infos(static_cast<CORBA::ULong>(max_samples_));
+  while (!stopped_) {
+    const Builder::TimeStamp start = Builder::get_hr_time();
+    const DDS::ReturnCode_t ret = data_dr_->take(data, infos, max_samples_,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (ret != DDS::RETCODE_OK) {
+      break;
+    }
+    record(Builder::to_seconds_double(Builder::get_hr_time() - start), data, infos);
+
+    if (dr_listener_) {
+      reverse_guard rg(lock);
+      for (CORBA::ULong i = 0; i < data.length(); ++i) {
+        if (infos[i].valid_data) {
+          dr_listener_->on_valid_data(data[i], infos[i]);
+        }
+      }
+    }
+  }
+}
+
+void TakeAction::take_zero_copy(std::unique_lock<std::mutex>& lock)
+{
+  while (!stopped_) {
+    DataSeq data;
+    DDS::SampleInfoSeq infos;
+    const Builder::TimeStamp start = Builder::get_hr_time();
+    const DDS::ReturnCode_t ret = data_dr_->take(data, infos, max_samples_,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (ret != DDS::RETCODE_OK) {
+      break;
+    }
+    record(Builder::to_seconds_double(Builder::get_hr_time() - start), data, infos);
+
+    if (dr_listener_) {
+      reverse_guard rg(lock);
+      for (CORBA::ULong i = 0; i < data.length(); ++i) {
+        if (infos[i].valid_data) {
+          dr_listener_->on_valid_data(data[i], infos[i]);
+        }
+      }
+    }
+    data_dr_->return_loan(data, infos);
+  }
+}
+
+void TakeAction::take_loaned(std::unique_lock<std::mutex>& lock)
+{
+  while (!stopped_) {
+    const Data* sample = 0;
+    DDS::SampleInfo info;
+    const Builder::TimeStamp start = Builder::get_hr_time();
+    const DDS::ReturnCode_t ret = data_dr_impl_->take_next_loaned_sample(sample, info);
+    if (ret != DDS::RETCODE_OK) {
+      break;
+    }
+    const double duration = Builder::to_seconds_double(Builder::get_hr_time() - start);
+    if (!sample) {
+      continue;
+    }
+    take_duration_stat_block_->update(duration);
+    take_sample_bytes_stat_block_->update(static_cast<double>(sample->buffer.length()));
+
+    if (dr_listener_) {
+      reverse_guard rg(lock);
+      dr_listener_->on_valid_data(*sample, info);
+    }
+    data_dr_impl_->return_loaned_sample(sample);
+  }
+}
+
+void TakeAction::record(double duration, const DataSeq& data, const DDS::SampleInfoSeq& infos)
+{
+  CORBA::ULong valid = 0;
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    if (infos[i].valid_data) {
+      ++valid;
+    }
+  }
+  if (!valid) {
+    return;
+  }
+  // The samples in one take share its cost.
+  const double per_sample = duration / valid;
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    if (infos[i].valid_data) {
+      take_duration_stat_block_->update(per_sample);
+      take_sample_bytes_stat_block_->update(static_cast<double>(data[i].buffer.length()));
+    }
+  }
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Action.h"
+#include "WorkerDataReaderListener.h"
+#include "PropertyStatBlock.h"
+
+#include "BenchTypeSupportImpl.h"
+
+#include <dds/DCPS/DataReaderImpl_T.h>
+#include <dds/DCPS/EventDispatcher.h>
+#include <dds/DCPS/GuardCondition.h>
+
+namespace Bench {
+
+// Takes samples like ReadAction, but with a configurable way of taking them,
+// and records how long the take itself costs per sample.
+class TakeAction : public virtual Action, public std::enable_shared_from_this<TakeAction> {
+public:
+  enum TakeMode {
+    TAKE_COPY,
+    TAKE_ZERO_COPY,
+    TAKE_LOANED
+  };
+
+  explicit TakeAction(OpenDDS::DCPS::EventDispatcher_rch event_dispatcher);
+
+  bool init(const ActionConfig& config, ActionReport& report, Builder::ReaderMap& readers,
+    Builder::WriterMap& writers, const Builder::ContentFilteredTopicMap& cft_map) override;
+
+  void test_start() override;
+  void test_stop() override;
+  void action_stop() override;
+
+  void do_take();
+
+protected:
+  typedef OpenDDS::DCPS::DataReaderImpl_T<Data> DataReaderImplType;
+
+  void take_copy(std::unique_lock<std::mutex>& lock);
+  void take_zero_copy(std::unique_lock<std::mutex>& lock);
+  void take_loaned(std::unique_lock<std::mutex>& lock);
+  void record(double duration, const DataSeq& data, const DDS::SampleInfoSeq& infos);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  OpenDDS::DCPS::EventDispatcher_rch event_dispatcher_;
+  bool started_, stopped_;
+  DDS::GuardCondition_var stop_condition_;
+  DDS::ReadCondition_var read_condition_;
+  DataDataReader_var data_dr_;
+  DataReaderImplType* data_dr_impl_;
+  DDS::WaitSet_var ws_;
+  WorkerDataReaderListener* dr_listener_;
+  OpenDDS::DCPS::TimeDuration take_period_;
+  TakeMode take_mode_;
+  CORBA::Long max_samples_;
+  std::shared_ptr<PropertyStatBlock> take_duration_stat_block_;
+  std::shared_ptr<PropertyStatBlock> take_sample_bytes_stat_block_;
+  OpenDDS::DCPS::EventBase_rch event_;
+  long timer_id_;
+  bool in_do_take_;
+};
+
+}
@@ -32,6 +32,7 @@
 #include "ForwardAction.h"
 #include "ReadAction.h"
 #include "SetCftParametersAction.h"
+#include "TakeAction.h"
 #include "WorkerDataReaderListener.h"
 #include "WorkerDataWriterListener.h"
 #include "WorkerTopicListener.h"
@@ -313,6 +314,10 @@ int ACE_TMAIN(int argc, ACE_TCHAR* argv[]) {
     read_action_registration("read", [&](){
       return std::shared_ptr<Bench::Action>(new Bench::ReadAction(event_dispatcher));
     });
+  Bench::ActionManager::Registration
+    take_action_registration("take", [&](){
+      return std::shared_ptr<Bench::Action>(new Bench::TakeAction(event_dispatcher));
+    });
   Bench::ActionManager::Registration
     forward_action_registration("forward", [&](){
       return std::shared_ptr<Bench::Action>(new Bench::ForwardAction(event_dispatcher));
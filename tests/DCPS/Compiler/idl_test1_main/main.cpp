@@ -328,6 +328,11 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
       failed = true;
     }
 
+    if (Xyz::Foo_OpenDDS_KeyHash()(my_foo) != Xyz::Foo_OpenDDS_KeyHash()(foo2)) {
+      ACE_ERROR((LM_ERROR, "Foo_OpenDDS_KeyHash differs for equal keys\n"));
+      failed = true;
+    }
+
     my_foo.key = 77;
     my_foo.xcolor = Xyz::redx;
     foomap[my_foo] = &my_foo;
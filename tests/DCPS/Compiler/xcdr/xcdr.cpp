@@ -473,6 +473,29 @@ TEST(BasicTests, MutableXcdr1Struct)
   baseline_checks<MutableStruct>(xcdr1, mutable_xcdr1_struct_expected);
 }
 
+const unsigned char final_plain_xcdr1_struct_expected[] = {
+  // long_long_field
+  0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // +8 = 8
+  // long_field
+  0x7f, 0xff, 0xff, 0xff, // +4 = 12
+  // short_field
+  0x7f, 0xff, // +2 = 14
+  // octet_field
+  0x01, // +1 = 15
+};
+const size_t final_plain_xcdr1_struct_max_size = 15;
+
+TEST(BasicTests, FinalPlainXcdr1Struct)
+{
+  baseline_checks<FinalPlainStruct>(xcdr1, final_plain_xcdr1_struct_expected,
+    final_plain_xcdr1_struct_max_size);
+}
+
+TEST(BasicTests, AppendablePlainXcdr1Struct)
+{
+  baseline_checks<AppendablePlainStruct>(xcdr1, final_plain_xcdr1_struct_expected);
+}
+
 // XCDR2 =====================================================================
 
 struct FinalXcdr2StructExpectedBE {
@@ -504,6 +527,63 @@ TEST(BasicTests, FinalXcdr2StructLE)
   test_little_endian<FinalStruct, FinalXcdr2StructExpectedBE>();
 }
 
+struct FinalPlainXcdr2StructExpectedBE {
+  STREAM_DATA
+};
+
+const unsigned char FinalPlainXcdr2StructExpectedBE::expected[] = {
+  // long_long_field
+  0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // +8 = 8
+  // long_field
+  0x7f, 0xff, 0xff, 0xff, // +4 = 12
+  // short_field
+  0x7f, 0xff, // +2 = 14
+  // octet_field
+  0x01 // +1 = 15
+};
+const unsigned FinalPlainXcdr2StructExpectedBE::layout[] = {8,4,2,1};
+const size_t final_plain_xcdr2_struct_max_size = 15;
+
+// The native little endian variants exercise the plain struct copy, the big
+// endian ones go field by field.
+TEST(BasicTests, FinalPlainXcdr2Struct)
+{
+  baseline_checks<FinalPlainStruct>(xcdr2, FinalPlainXcdr2StructExpectedBE::expected,
+    final_plain_xcdr2_struct_max_size);
+}
+
+TEST(BasicTests, FinalPlainXcdr2StructLE)
+{
+  test_little_endian<FinalPlainStruct, FinalPlainXcdr2StructExpectedBE>();
+}
+
+struct AppendablePlainXcdr2StructExpectedBE {
+  STREAM_DATA
+};
+
+const unsigned char AppendablePlainXcdr2StructExpectedBE::expected[] = {
+  0x00, 0x00, 0x00, 0x0f, // +4 = 4 Delimiter
+  // long_long_field
+  0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // +8 = 12
+  // long_field
+  0x7f, 0xff, 0xff, 0xff, // +4 = 16
+  // short_field
+  0x7f, 0xff, // +2 = 18
+  // octet_field
+  0x01 // +1 = 19
+};
+const unsigned AppendablePlainXcdr2StructExpectedBE::layout[] = {4,8,4,2,1};
+
+TEST(BasicTests, AppendablePlainXcdr2Struct)
+{
+  baseline_checks<AppendablePlainStruct>(xcdr2, AppendablePlainXcdr2StructExpectedBE::expected);
+}
+
+TEST(BasicTests, AppendablePlainXcdr2StructLE)
+{
+  test_little_endian<AppendablePlainStruct, AppendablePlainXcdr2StructExpectedBE>();
+}
+
 struct AppendableXcdr2StructExpectedBE {
   STREAM_DATA
 };
@@ -7,9 +7,17 @@
  * Each test case will create a reader and a writer,
  * check match or flag incompatible QoS, and then destroy the pair.
  * See Test::test_case() and Test::run() for details.
+ *
+ * Test::test_Registered_KeyedType() writes samples with writers of each
+ * representation: Test::test_write_serialized() checks that a sample serialized
+ * ahead of the write is only written by writers using the same representation
+ * and Test::test_serialized_sizes() checks that samples of changing sizes arrive
+ * intact however the writer sized their buffers.
  */
 #include "DataRepresentationTypeSupportImpl.h"
 
+#include <tests/Utils/StatusMatching.h>
+
 #include <dds/DCPS/Service_Participant.h>
 #include <dds/DCPS/Marked_Default_Qos.h>
 #include <dds/DCPS/SafetyProfileStreams.h>
@@ -30,6 +38,16 @@
 using OpenDDS::DCPS::retcode_to_string;
 using OpenDDS::DCPS::DEFAULT_STATUS_MASK;
 
+class DDS_TEST {
+public:
+  /// The size the writer expects its next unbounded sample to have.
+  static size_t serialized_size_hint(DDS::DataWriter* writer)
+  {
+    OpenDDS::DCPS::DataWriterImpl* const impl = dynamic_cast<OpenDDS::DCPS::DataWriterImpl*>(writer);
+    return impl ? impl->serialized_size_hint_.load() : 0;
+  }
+};
+
 template<typename Type>
 class RegisteredType {
 public:
@@ -76,6 +94,9 @@ private:
   void test_Registered_Xcdr1Type();
   void test_Registered_Xcdr2Type();
   void test_Registered_XmlType();
+  void test_Registered_KeyedType();
+  void test_write_serialized();
+  void test_serialized_sizes(const Dri& writer_dr);
 
   static void dr_to_qos(const Dri& dri, DDS::DataRepresentationQosPolicy& qos);
   static std::string to_string(const Dri& dri);
@@ -129,6 +150,7 @@ int Test::run()
   test_Registered_Xcdr1Type();
   test_Registered_Xcdr2Type();
   test_Registered_XmlType();
+  test_Registered_KeyedType();
 
   const unsigned n_failed = cases_total_ - cases_passed_;
   if (n_failed == 0) {
@@ -314,6 +336,259 @@ void Test::test_Registered_XmlType()
   test_case(default_dr_, xml_, false, true, false);
 }
 
+void Test::test_Registered_KeyedType()
+{
+  RegisteredType<KeyedType> keyed_type(participant_.in());
+  create_topic(keyed_type.name(), default_dr_);
+  if (!topic_) { add_result(false); return; }
+  test_write_serialized();
+  test_serialized_sizes(xcdr1_);
+  test_serialized_sizes(xcdr2_);
+}
+
+void Test::test_write_serialized()
+{
+  typedef OpenDDS::DCPS::DataWriterImpl_T<KeyedType> KeyedTypeWriterImpl;
+
+  DDS::DataReaderQos dr_qos;
+  subscriber_->get_default_datareader_qos(dr_qos);
+  dr_to_qos(xcdr2xcdr1_, dr_qos.representation);
+  dr_qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+  DDS::DataReader_var reader = subscriber_->create_datareader(topic_, dr_qos, 0, DEFAULT_STATUS_MASK);
+  DDS::DataWriter_var dw_a = create_writer(xcdr1_);
+  DDS::DataWriter_var dw_b = create_writer(xcdr1_);
+  DDS::DataWriter_var dw_c = create_writer(xcdr2_);
+  KeyedTypeWriterImpl* const writer_a = dynamic_cast<KeyedTypeWriterImpl*>(dw_a.in());
+  KeyedTypeWriterImpl* const writer_b = dynamic_cast<KeyedTypeWriterImpl*>(dw_b.in());
+  KeyedTypeWriterImpl* const writer_c = dynamic_cast<KeyedTypeWriterImpl*>(dw_c.in());
+  KeyedTypeDataReader_var keyed_reader = KeyedTypeDataReader::_narrow(reader);
+  if (!keyed_reader || !writer_a || !writer_b || !writer_c) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("failed to create the reader or writers\n")));
+    add_result(false);
+    return;
+  }
+  if (Utils::wait_match(dw_a, 1) || Utils::wait_match(dw_b, 1)) {
+    add_result(false);
+    return;
+  }
+
+  // Changing the sample after serializing it doesn't change what's written,
+  // the SerializedSample has its own copy.
+  KeyedType sample;
+  sample.id = 1;
+  sample.value = 1;
+  KeyedTypeWriterImpl::SerializedSample serialized;
+  DDS::ReturnCode_t rc = writer_a->serialize_for_write(sample, serialized);
+  if (rc != DDS::RETCODE_OK) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("serialize_for_write failed: %C\n"), retcode_to_string(rc)));
+  }
+  add_result(rc == DDS::RETCODE_OK);
+  sample.id = 2;
+  sample.value = 2;
+  rc = writer_a->write_serialized(serialized, DDS::HANDLE_NIL);
+  if (rc != DDS::RETCODE_OK) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("write_serialized on the writer that serialized it failed: %C\n"), retcode_to_string(rc)));
+  }
+  add_result(rc == DDS::RETCODE_OK);
+  rc = writer_b->write_serialized(serialized, DDS::HANDLE_NIL);
+  if (rc != DDS::RETCODE_OK) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("write_serialized on another writer failed: %C\n"), retcode_to_string(rc)));
+  }
+  add_result(rc == DDS::RETCODE_OK);
+
+  KeyedType key;
+  key.id = 1;
+  bool passed = writer_a->lookup_instance(key) != DDS::HANDLE_NIL &&
+    writer_b->lookup_instance(key) != DDS::HANDLE_NIL;
+  key.id = 2;
+  passed &= writer_a->lookup_instance(key) == DDS::HANDLE_NIL;
+  if (!passed) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("write_serialized didn't register the serialized instance\n")));
+  }
+  add_result(passed);
+
+  // The representation has to match.
+  rc = writer_c->write_serialized(serialized, DDS::HANDLE_NIL);
+  if (rc != DDS::RETCODE_PRECONDITION_NOT_MET) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("write_serialized with another representation returned %C\n"), retcode_to_string(rc)));
+  }
+  add_result(rc == DDS::RETCODE_PRECONDITION_NOT_MET);
+  const KeyedTypeWriterImpl::SerializedSample empty;
+  rc = writer_a->write_serialized(empty, DDS::HANDLE_NIL);
+  if (rc != DDS::RETCODE_PRECONDITION_NOT_MET) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+      ACE_TEXT("write_serialized without a sample returned %C\n"), retcode_to_string(rc)));
+  }
+  add_result(rc == DDS::RETCODE_PRECONDITION_NOT_MET);
+
+  // Both writes arrive with the data that was serialized.
+  DDS::ReadCondition_var read_condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE,
+    DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+  DDS::WaitSet_var ws = new DDS::WaitSet;
+  ws->attach_condition(read_condition);
+  CORBA::ULong received = 0;
+  passed = true;
+  const DDS::Duration_t max_wait_time = {10, 0};
+  while (received < 2) {
+    DDS::ConditionSeq conditions;
+    if (ws->wait(conditions, max_wait_time) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+        ACE_TEXT("received %u of 2 samples\n"), received));
+      passed = false;
+      break;
+    }
+    KeyedTypeSeq data;
+    DDS::SampleInfoSeq info;
+    if (keyed_reader->take_w_condition(data, info, DDS::LENGTH_UNLIMITED, read_condition) != DDS::RETCODE_OK) {
+      continue;
+    }
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      if (!info[i].valid_data) {
+        continue;
+      }
+      ++received;
+      if (data[i].id != 1 || data[i].value != 1) {
+        ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_write_serialized() ERROR: ")
+          ACE_TEXT("received %d %d instead of 1 1\n"), data[i].id, data[i].value));
+        passed = false;
+      }
+    }
+  }
+  ws->detach_condition(read_condition);
+  reader->delete_readcondition(read_condition);
+  add_result(passed);
+
+  publisher_->delete_contained_entities();
+  subscriber_->delete_contained_entities();
+}
+
+void Test::test_serialized_sizes(const Dri& writer_dr)
+{
+  DDS::DataReaderQos dr_qos;
+  subscriber_->get_default_datareader_qos(dr_qos);
+  dr_to_qos(xcdr2xcdr1_, dr_qos.representation);
+  dr_qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  DDS::DataReader_var reader = subscriber_->create_datareader(topic_, dr_qos, 0, DEFAULT_STATUS_MASK);
+  DDS::DataWriterQos dw_qos;
+  publisher_->get_default_datawriter_qos(dw_qos);
+  dr_to_qos(writer_dr, dw_qos.representation);
+  dw_qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  DDS::DataWriter_var writer = publisher_->create_datawriter(topic_, dw_qos, 0, DEFAULT_STATUS_MASK);
+  KeyedTypeDataReader_var keyed_reader = KeyedTypeDataReader::_narrow(reader);
+  KeyedTypeDataWriter_var keyed_writer = KeyedTypeDataWriter::_narrow(writer);
+  if (!keyed_reader || !keyed_writer) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+      ACE_TEXT("failed to create the reader or writer\n")));
+    add_result(false);
+    return;
+  }
+  if (Utils::wait_match(writer, 1)) {
+    add_result(false);
+    return;
+  }
+
+  // The first sample is sized exactly, the next one fits the headroom left
+  // by the first, the third outgrows it, and the rest fit the room left
+  // after that. The key only samples are sized exactly and leave the hint
+  // alone.
+  static const size_t lengths[] = { 100, 110, 1000, 1100, 10 };
+  static const CORBA::ULong count = sizeof lengths / sizeof lengths[0];
+  KeyedType sample;
+  sample.id = 1;
+  sample.value = 0;
+  const DDS::InstanceHandle_t handle = keyed_writer->register_instance(sample);
+  bool passed = handle != DDS::HANDLE_NIL && DDS_TEST::serialized_size_hint(writer) == 0;
+  size_t previous_hint = 0;
+  for (CORBA::ULong i = 0; i < count; ++i) {
+    sample.value = i;
+    sample.text = std::string(lengths[i], static_cast<char>('a' + i)).c_str();
+    if (keyed_writer->write(sample, handle) != DDS::RETCODE_OK) {
+      passed = false;
+    }
+    const size_t hint = DDS_TEST::serialized_size_hint(writer);
+    bool expected = hint > lengths[i];
+    if (i == 1) {
+      expected &= hint > previous_hint && hint <= previous_hint + previous_hint / 4;
+    } else if (i == 2) {
+      expected &= hint >= 2 * lengths[i];
+    } else if (i > 2) {
+      expected &= hint < previous_hint;
+    }
+    if (!expected) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+        ACE_TEXT("hint %B after writing %B characters, it was %B\n"),
+        hint, lengths[i], previous_hint));
+      passed = false;
+    }
+    previous_hint = hint;
+  }
+  if (keyed_writer->dispose(sample, handle) != DDS::RETCODE_OK ||
+      keyed_writer->unregister_instance(sample, handle) != DDS::RETCODE_OK ||
+      DDS_TEST::serialized_size_hint(writer) != previous_hint) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+      ACE_TEXT("dispose or unregister_instance failed or changed the hint\n")));
+    passed = false;
+  }
+
+  // Every sample arrives with its text, followed by the dispose.
+  DDS::ReadCondition_var read_condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE,
+    DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+  DDS::WaitSet_var ws = new DDS::WaitSet;
+  ws->attach_condition(read_condition);
+  CORBA::ULong received = 0;
+  bool disposed = false;
+  const DDS::Duration_t max_wait_time = {10, 0};
+  while (!disposed) {
+    DDS::ConditionSeq conditions;
+    if (ws->wait(conditions, max_wait_time) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+        ACE_TEXT("received %u of %u samples and no dispose\n"), received, count));
+      passed = false;
+      break;
+    }
+    KeyedTypeSeq data;
+    DDS::SampleInfoSeq info;
+    if (keyed_reader->take_w_condition(data, info, DDS::LENGTH_UNLIMITED, read_condition) != DDS::RETCODE_OK) {
+      continue;
+    }
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      if (!info[i].valid_data) {
+        disposed |= info[i].instance_state == DDS::NOT_ALIVE_DISPOSED_INSTANCE_STATE;
+        continue;
+      }
+      if (received >= count || data[i].id != 1 || data[i].value != static_cast<CORBA::Long>(received) ||
+          std::string(data[i].text.in()) != std::string(lengths[received], static_cast<char>('a' + received))) {
+        ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+          ACE_TEXT("sample %u of %u has value %d and %B characters\n"),
+          received, count, data[i].value, std::string(data[i].text.in()).size()));
+        passed = false;
+      }
+      ++received;
+    }
+  }
+  ws->detach_condition(read_condition);
+  reader->delete_readcondition(read_condition);
+  if (received != count) {
+    passed = false;
+  }
+  if (!passed) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("%N:%l test_serialized_sizes() ERROR: ")
+      ACE_TEXT("Test case failed for Writer Data Representation QoS: %C\n"),
+      to_string(writer_dr).c_str()));
+  }
+  add_result(passed);
+
+  publisher_->delete_contained_entities();
+  subscriber_->delete_contained_entities();
+}
+
 void Test::dr_to_qos(const Dri& dri, DDS::DataRepresentationQosPolicy& qos)
 {
   const Dri::size_type count = dri.size();
@@ -6,11 +6,162 @@
 #include "dds/DCPS/SubscriberImpl.h"
 #include "dds/DCPS/StaticIncludes.h"
 #include "dds/DCPS/DCPS_Utils.h"
+#include "dds/DCPS/Atomic.h"
+#include "dds/DCPS/TimeTypes.h"
+
+#include <ace/OS_NS_unistd.h>
 
 #include "GeneratedCode/MessengerTypeSupportImpl.h"
+#include "tests/Utils/StatusMatching.h"
 #include <iostream>
+#include <set>
 using namespace std;
 
+typedef set<DDS::InstanceHandle_t> Handles;
+
+class DDS_TEST {
+public:
+  /// Count the samples in the history of reader and the ones of them that
+  /// are still serialized.
+  template <typename MessageType>
+  static void count_samples(DDS::DataReader_ptr dr, size_t& total, size_t& deferred)
+  {
+    typedef OpenDDS::DCPS::DataReaderImpl_T<MessageType> ReaderImpl;
+    typedef typename ReaderImpl::MessageTypeWithAllocator Sample;
+    total = deferred = 0;
+    ReaderImpl* const typed = dynamic_cast<ReaderImpl*>(dr);
+    if (!typed) {
+      return;
+    }
+    OpenDDS::DCPS::DataReaderImpl& reader = *typed;
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, reader.sample_lock_);
+    for (OpenDDS::DCPS::DataReaderImpl::SubscriptionInstanceMapType::const_iterator it =
+           reader.instances_.begin(); it != reader.instances_.end(); ++it) {
+      OpenDDS::DCPS::ReceivedDataElementList& samples = it->second->rcvd_samples_;
+      for (OpenDDS::DCPS::ReceivedDataElement* item = samples.get_next_match(DDS::ANY_SAMPLE_STATE, 0);
+           item; item = samples.get_next_match(DDS::ANY_SAMPLE_STATE, item)) {
+        ++total;
+        if (item->registered_data_ && static_cast<Sample*>(item->registered_data_)->deferred()) {
+          ++deferred;
+        }
+      }
+    }
+  }
+
+  /// The instances matching_instances() returns for the masks.
+  static Handles matching(DDS::DataReader_ptr dr, CORBA::ULong sample_states,
+                          CORBA::ULong view_states, CORBA::ULong instance_states)
+  {
+    OpenDDS::DCPS::DataReaderImpl* const reader = dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(dr);
+    if (!reader) {
+      return Handles();
+    }
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, reader->sample_lock_, Handles());
+    OpenDDS::DCPS::DataReaderImpl::HandleVec handles;
+    reader->matching_instances(sample_states, view_states, instance_states, handles);
+    return Handles(handles.begin(), handles.end());
+  }
+
+  /// Compare the time matching_instances() and a walk over all of the
+  /// reader's instances take to find the instances matching the masks.
+  static bool lookup_is_faster(DDS::DataReader_ptr dr, CORBA::ULong sample_states,
+                               CORBA::ULong view_states, CORBA::ULong instance_states,
+                               int repeats)
+  {
+    using OpenDDS::DCPS::MonotonicTimePoint;
+    OpenDDS::DCPS::DataReaderImpl* const reader = dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(dr);
+    if (!reader) {
+      return false;
+    }
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, reader->sample_lock_, false);
+    OpenDDS::DCPS::DataReaderImpl::HandleVec lookup;
+    const MonotonicTimePoint lookup_start = MonotonicTimePoint::now();
+    for (int i = 0; i < repeats; ++i) {
+      reader->matching_instances(sample_states, view_states, instance_states, lookup);
+    }
+    const MonotonicTimePoint walk_start = MonotonicTimePoint::now();
+    OpenDDS::DCPS::DataReaderImpl::HandleVec walk;
+    for (int i = 0; i < repeats; ++i) {
+      walk.clear();
+      for (OpenDDS::DCPS::DataReaderImpl::SubscriptionInstanceMapType::const_iterator it =
+             reader->instances_.begin(); it != reader->instances_.end(); ++it) {
+        const OpenDDS::DCPS::SubscriptionInstance& inst = *it->second;
+        if ((inst.rcvd_samples_.sample_states() & sample_states) &&
+            (inst.instance_state_->view_state() & view_states) &&
+            (inst.instance_state_->instance_state() & instance_states)) {
+          walk.push_back(it->first);
+        }
+      }
+    }
+    const MonotonicTimePoint walk_end = MonotonicTimePoint::now();
+    const double lookup_time = (walk_start - lookup_start).to_double();
+    const double walk_time = (walk_end - walk_start).to_double();
+    cout << "lookup of " << lookup.size() << " of " << reader->instances_.size()
+         << " instances took " << lookup_time << " s, walking them took " << walk_time
+         << " s" << endl;
+    if (lookup != walk) {
+      cout << "ERROR: the lookup found " << lookup.size() << " instances, walking them found "
+           << walk.size() << endl;
+      return false;
+    }
+    return lookup_time < walk_time;
+  }
+
+  /// Compare matching_instances(), next_matching_instance(), and
+  /// has_matching_instance() for every combination of masks with the states
+  /// of the reader's instances.
+  static bool check_lookup(DDS::DataReader_ptr dr, const char* what)
+  {
+    OpenDDS::DCPS::DataReaderImpl* const reader = dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(dr);
+    if (!reader) {
+      return false;
+    }
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, reader->sample_lock_, false);
+    bool passed = true;
+    for (CORBA::ULong ss = 1; ss <= DDS::ANY_SAMPLE_STATE; ++ss) {
+      for (CORBA::ULong vs = 1; vs <= DDS::ANY_VIEW_STATE; ++vs) {
+        for (CORBA::ULong is = 1; is <= DDS::ANY_INSTANCE_STATE; ++is) {
+          Handles expected;
+          for (OpenDDS::DCPS::DataReaderImpl::SubscriptionInstanceMapType::const_iterator it =
+                 reader->instances_.begin(); it != reader->instances_.end(); ++it) {
+            const OpenDDS::DCPS::SubscriptionInstance& inst = *it->second;
+            if ((inst.rcvd_samples_.sample_states() & ss) &&
+                (inst.instance_state_->view_state() & vs) &&
+                (inst.instance_state_->instance_state() & is)) {
+              expected.insert(it->first);
+            }
+          }
+          OpenDDS::DCPS::DataReaderImpl::HandleVec all;
+          reader->matching_instances(ss, vs, is, all);
+          const Handles actual(all.begin(), all.end());
+          OpenDDS::DCPS::DataReaderImpl::HandleVec next;
+          for (DDS::InstanceHandle_t handle = reader->next_matching_instance(ss, vs, is, DDS::HANDLE_NIL);
+               handle != DDS::HANDLE_NIL; handle = reader->next_matching_instance(ss, vs, is, handle)) {
+            next.push_back(handle);
+          }
+          // Both return the handles in order.
+          if (actual != expected || all != next || actual.size() != all.size() ||
+              reader->has_matching_instance(ss, vs, is) != !expected.empty()) {
+            cout << "ERROR: " << what << ": lookup for states " << ss << " " << vs << " " << is
+                 << " found " << actual.size() << " instances, expected " << expected.size() << endl;
+            passed = false;
+          }
+        }
+      }
+    }
+
+    // Sets are removed once their last instance leaves them.
+    for (OpenDDS::DCPS::DataReaderImpl::LookupMap::const_iterator it = reader->combined_state_lookup_.begin();
+         it != reader->combined_state_lookup_.end(); ++it) {
+      if (it->second.empty()) {
+        cout << "ERROR: " << what << ": empty lookup set for states " << it->first << endl;
+        passed = false;
+      }
+    }
+    return passed;
+  }
+};
+
 void received_data(const Messenger::MessageSeq& data,
                    Messenger::MessageDataWriter_ptr mdw,
                    Messenger::Message& msg)
@@ -236,6 +387,705 @@ int run_test_next_instance(DDS::DomainParticipant_ptr dp)
   return passed ? 0 : 1;
 }
 
+template <typename MessageType>
+bool check_samples(DDS::DataReader_ptr dr, size_t total, size_t deferred, const char* what)
+{
+  size_t actual_total = 0;
+  size_t actual_deferred = 0;
+  for (int i = 0; i < 500; ++i) {
+    DDS_TEST::count_samples<MessageType>(dr, actual_total, actual_deferred);
+    if (actual_total >= total) {
+      break;
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 20000));
+  }
+  if (actual_total != total || actual_deferred != deferred) {
+    cout << "ERROR: " << what << ": the reader has " << actual_total << " samples, "
+         << actual_deferred << " of them serialized, expected " << total << " and "
+         << deferred << endl;
+    return false;
+  }
+  return true;
+}
+
+bool write_message(Messenger::MessageDataWriter_ptr mdw, CORBA::Long subject_id)
+{
+  Messenger::Message msg = {subject_id};
+  if (mdw->write(msg, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+    cout << "ERROR: write of " << subject_id << " failed" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool check_data(const Messenger::MessageSeq& data, const DDS::SampleInfoSeq& info,
+                const CORBA::Long* expected, CORBA::ULong expected_count, const char* what)
+{
+  if (data.length() != expected_count) {
+    cout << "ERROR: " << what << " returned " << data.length() << " samples, expected "
+         << expected_count << endl;
+    return false;
+  }
+  bool passed = true;
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    if (!info[i].valid_data || data[i].subject_id != expected[i]) {
+      cout << "ERROR: " << what << " returned " << data[i].subject_id << " valid "
+           << info[i].valid_data << ", expected " << expected[i] << endl;
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+// With DCPSLazyDeserialization, samples of keyless topics are kept
+// serialized until a read, take, or condition needs them.
+int run_test_lazy_deserialization(DDS::DomainParticipant_ptr dp)
+{
+  using namespace DDS;
+  using namespace OpenDDS::DCPS;
+  using namespace Messenger;
+  // Both settings are read when the entities are created.
+  TheServiceParticipant->lazy_deserialization(true);
+  // Make the reader of the content filtered topic filter samples itself.
+  TheServiceParticipant->publisher_content_filter(false);
+
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic("LazyTopic", type_name,
+    TOPIC_QOS_DEFAULT, 0, ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  KeyedMessageTypeSupport_var keyed_ts = new KeyedMessageTypeSupportImpl;
+  keyed_ts->register_type(dp, "");
+  CORBA::String_var keyed_type_name = keyed_ts->get_type_name();
+  Topic_var keyed_topic = dp->create_topic("LazyKeyedTopic", keyed_type_name,
+    TOPIC_QOS_DEFAULT, 0, ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  DataReader_var keyed_dr = sub->create_datareader(keyed_topic, dr_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  ContentFilteredTopic_var filtered_topic = dp->create_contentfilteredtopic(
+    "LazyFilteredTopic", topic, "subject_id > 10", StringSeq());
+  DataReader_var filtered_dr = sub->create_datareader(filtered_topic, dr_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  const unsigned int readers = 2;
+#else
+  const unsigned int readers = 1;
+#endif
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  DataWriter_var keyed_dw = pub->create_datawriter(keyed_topic, dw_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  TheServiceParticipant->lazy_deserialization(false);
+  TheServiceParticipant->publisher_content_filter(true);
+
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  KeyedMessageDataReader_var keyed_mdr = KeyedMessageDataReader::_narrow(keyed_dr);
+  KeyedMessageDataWriter_var keyed_mdw = KeyedMessageDataWriter::_narrow(keyed_dw);
+  if (!mdr || !mdw || !keyed_mdr || !keyed_mdw) {
+    cout << "ERROR: failed to create the lazy DataReaders or DataWriters" << endl;
+    return 1;
+  }
+  if (Utils::wait_match(dw, readers) || Utils::wait_match(keyed_dw, 1)) {
+    return 1;
+  }
+
+  bool passed = true;
+
+  // Samples of the keyless topic stay serialized until they are accessed.
+  passed &= write_message(mdw, 1);
+  passed &= write_message(mdw, 2);
+  passed &= write_message(mdw, 12);
+  passed &= check_samples<Message>(dr, 3, 3, "after the first writes");
+
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  // The writer doesn't filter for the reader of the content filtered topic,
+  // so it deserializes on arrival to filter.
+  passed &= check_samples<Message>(filtered_dr, 1, 0, "content filtered reader");
+  {
+    MessageDataReader_var filtered_mdr = MessageDataReader::_narrow(filtered_dr);
+    MessageSeq data;
+    SampleInfoSeq info;
+    passed &= filtered_mdr->take(data, info, LENGTH_UNLIMITED, ANY_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE) == RETCODE_OK;
+    const CORBA::Long expected[] = { 12 };
+    passed &= check_data(data, info, expected, 1, "take from the content filtered reader");
+  }
+#endif
+
+  // Reading with a read condition deserializes the samples it returns.
+  {
+    ReadCondition_var rc = dr->create_readcondition(NOT_READ_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+    MessageSeq data;
+    SampleInfoSeq info;
+    passed &= mdr->read_w_condition(data, info, LENGTH_UNLIMITED, rc) == RETCODE_OK;
+    const CORBA::Long expected[] = { 1, 2, 12 };
+    passed &= check_data(data, info, expected, 3, "read_w_condition");
+    mdr->return_loan(data, info);
+    dr->delete_readcondition(rc);
+    passed &= check_samples<Message>(dr, 3, 0, "after read_w_condition");
+  }
+
+  // Take returns the samples already deserialized and the new one.
+  passed &= write_message(mdw, 3);
+  passed &= check_samples<Message>(dr, 4, 1, "after another write");
+  {
+    MessageSeq data;
+    SampleInfoSeq info;
+    passed &= mdr->take(data, info, LENGTH_UNLIMITED, ANY_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE) == RETCODE_OK;
+    const CORBA::Long expected[] = { 1, 2, 12, 3 };
+    passed &= check_data(data, info, expected, 4, "take");
+  }
+
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  // A query condition has to deserialize the samples it evaluates.
+  passed &= write_message(mdw, 4);
+  passed &= write_message(mdw, 5);
+  passed &= check_samples<Message>(dr, 2, 2, "before the query condition");
+  {
+    QueryCondition_var qc = dr->create_querycondition(ANY_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE, "subject_id = 5", StringSeq());
+    MessageSeq data;
+    SampleInfoSeq info;
+    passed &= mdr->take_w_condition(data, info, LENGTH_UNLIMITED, qc) == RETCODE_OK;
+    const CORBA::Long expected[] = { 5 };
+    passed &= check_data(data, info, expected, 1, "take_w_condition");
+    dr->delete_readcondition(qc);
+    passed &= check_samples<Message>(dr, 1, 0, "after the query condition");
+  }
+#endif
+
+  // Samples of keyed topics are deserialized on arrival to find their
+  // instance.
+  {
+    KeyedMessage msg = {1, 7};
+    passed &= keyed_mdw->write(msg, HANDLE_NIL) == RETCODE_OK;
+    passed &= check_samples<KeyedMessage>(keyed_dr, 1, 0, "keyed reader");
+    KeyedMessageSeq data;
+    SampleInfoSeq info;
+    passed &= keyed_mdr->take(data, info, LENGTH_UNLIMITED, ANY_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE) == RETCODE_OK;
+    if (data.length() != 1 || !info[0].valid_data || data[0].subject_id != 1 || data[0].count != 7) {
+      cout << "ERROR: take from the keyed reader returned the wrong sample" << endl;
+      passed = false;
+    }
+  }
+
+  dp->delete_contained_entities();
+  return passed ? 0 : 1;
+}
+
+// Writes a batch of samples of one instance, more than the writer keeps
+// for an instance, and checks the reader gets all of them. The batch has
+// to be flushed before the writer's history replaces or waits for samples
+// it hasn't sent yet.
+bool run_batch_write(DDS::DomainParticipant_ptr dp, const char* topic_name,
+                     const DDS::HistoryQosPolicy& history, CORBA::Long max_samples_per_instance)
+{
+  using namespace DDS;
+  using namespace Messenger;
+  typedef OpenDDS::DCPS::DataWriterImpl_T<KeyedMessage> KeyedMessageWriterImpl;
+  static const CORBA::ULong batch_size = 5;
+
+  KeyedMessageTypeSupport_var ts = new KeyedMessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic(topic_name, type_name,
+    TOPIC_QOS_DEFAULT, 0, ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.reliability.max_blocking_time.sec = 5;
+  dw_qos.reliability.max_blocking_time.nanosec = 0;
+  dw_qos.history = history;
+  dw_qos.resource_limits.max_samples_per_instance = max_samples_per_instance;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  KeyedMessageWriterImpl* const writer = dynamic_cast<KeyedMessageWriterImpl*>(dw.in());
+  KeyedMessageDataReader_var mdr = KeyedMessageDataReader::_narrow(dr);
+  if (!mdr || !writer) {
+    cout << "ERROR: failed to create the DataReader or DataWriter on " << topic_name << endl;
+    return false;
+  }
+  if (Utils::wait_match(dw, 1)) {
+    return false;
+  }
+
+  KeyedMessageSeq samples;
+  samples.length(batch_size);
+  for (CORBA::ULong i = 0; i < batch_size; ++i) {
+    samples[i].subject_id = 1;
+    samples[i].count = i;
+  }
+  bool passed = true;
+
+  InstanceHandleSeq handles;
+  handles.length(batch_size - 1);
+  ReturnCode_t ret = writer->write_batch(samples, handles);
+  if (ret != RETCODE_BAD_PARAMETER) {
+    cout << "ERROR: write_batch with fewer handles than samples returned "
+         << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+
+  handles.length(0);
+  ret = writer->write_batch(samples, handles);
+  if (ret != RETCODE_OK) {
+    cout << "ERROR: write_batch returned " << retcode_to_string(ret) << endl;
+    passed = false;
+  }
+
+  ReadCondition_var rc = dr->create_readcondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  WaitSet_var ws = new WaitSet;
+  ws->attach_condition(rc);
+  CORBA::Long received = 0;
+  const Duration_t timeout = { 10, 0 };
+  while (received < static_cast<CORBA::Long>(batch_size)) {
+    ConditionSeq active;
+    if (ws->wait(active, timeout) != RETCODE_OK) {
+      cout << "ERROR: received " << received << " of " << batch_size
+           << " samples on " << topic_name << endl;
+      passed = false;
+      break;
+    }
+    KeyedMessageSeq data;
+    SampleInfoSeq info;
+    if (mdr->take_w_condition(data, info, LENGTH_UNLIMITED, rc) != RETCODE_OK) {
+      continue;
+    }
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      if (!info[i].valid_data) {
+        continue;
+      }
+      if (data[i].count != received) {
+        cout << "ERROR: received " << data[i].count << " instead of " << received
+             << " on " << topic_name << endl;
+        passed = false;
+      }
+      ++received;
+    }
+  }
+  ws->detach_condition(rc);
+  dr->delete_readcondition(rc);
+
+  dp->delete_contained_entities();
+  return passed;
+}
+
+int run_test_batch_write(DDS::DomainParticipant_ptr dp)
+{
+  // The history would replace the unsent samples.
+  DDS::HistoryQosPolicy keep_last;
+  keep_last.kind = DDS::KEEP_LAST_HISTORY_QOS;
+  keep_last.depth = 2;
+  bool passed = run_batch_write(dp, "BatchKeepLastTopic", keep_last, DDS::LENGTH_UNLIMITED);
+
+  // The resource limits would make write_batch wait for the unsent samples.
+  DDS::HistoryQosPolicy keep_all;
+  keep_all.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  keep_all.depth = 1;
+  passed &= run_batch_write(dp, "BatchKeepAllTopic", keep_all, 2);
+  return passed ? 0 : 1;
+}
+
+/// Wait until the instances matching the masks are the expected ones.
+bool expect_matching(DDS::DataReader_ptr dr, CORBA::ULong sample_states, CORBA::ULong view_states,
+                     CORBA::ULong instance_states, const Handles& expected, const char* what)
+{
+  Handles actual;
+  for (int i = 0; i < 500; ++i) {
+    actual = DDS_TEST::matching(dr, sample_states, view_states, instance_states);
+    if (actual == expected) {
+      return DDS_TEST::check_lookup(dr, what);
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 20000));
+  }
+  cout << "ERROR: " << what << ": " << actual.size() << " instances match, expected "
+       << expected.size() << endl;
+  return false;
+}
+
+Handles handle_set(DDS::InstanceHandle_t a = DDS::HANDLE_NIL, DDS::InstanceHandle_t b = DDS::HANDLE_NIL)
+{
+  Handles result;
+  if (a != DDS::HANDLE_NIL) {
+    result.insert(a);
+  }
+  if (b != DDS::HANDLE_NIL) {
+    result.insert(b);
+  }
+  return result;
+}
+
+// The reader indexes its instances by their combined states, check that
+// the index follows the states as samples are read, taken, and disposed.
+int run_test_state_lookup(DDS::DomainParticipant_ptr dp)
+{
+  using namespace DDS;
+  using namespace OpenDDS::DCPS;
+  using namespace Messenger;
+  KeyedMessageTypeSupport_var ts = new KeyedMessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic("LookupTopic", type_name,
+    TOPIC_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  KeyedMessageDataWriter_var mdw = KeyedMessageDataWriter::_narrow(dw);
+  KeyedMessageDataReader_var mdr = KeyedMessageDataReader::_narrow(dr);
+  if (!mdr || !mdw) {
+    cout << "ERROR: failed to create the lookup DataReader or DataWriter" << endl;
+    return 1;
+  }
+  if (Utils::wait_match(dw, 1)) {
+    return 1;
+  }
+
+  bool passed = DDS_TEST::check_lookup(dr, "before writing");
+
+  KeyedMessage one = {1, 1};
+  KeyedMessage two = {2, 1};
+  mdw->write(one, HANDLE_NIL);
+  mdw->write(two, HANDLE_NIL);
+  InstanceHandle_t h1 = HANDLE_NIL;
+  InstanceHandle_t h2 = HANDLE_NIL;
+  for (int i = 0; i < 500 && (h1 == HANDLE_NIL || h2 == HANDLE_NIL); ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 20000));
+    h1 = mdr->lookup_instance(one);
+    h2 = mdr->lookup_instance(two);
+  }
+  if (h1 == HANDLE_NIL || h2 == HANDLE_NIL) {
+    cout << "ERROR: the reader didn't receive both instances" << endl;
+    return 1;
+  }
+  passed &= expect_matching(dr, NOT_READ_SAMPLE_STATE, NEW_VIEW_STATE, ALIVE_INSTANCE_STATE,
+                            handle_set(h1, h2), "new instances");
+  passed &= expect_matching(dr, READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(), "no read samples");
+
+  // Reading an instance makes its samples READ and the instance NOT_NEW.
+  KeyedMessageSeq data;
+  SampleInfoSeq info;
+  mdr->read_instance(data, info, LENGTH_UNLIMITED, h1, ANY_SAMPLE_STATE,
+                     ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  mdr->return_loan(data, info);
+  passed &= expect_matching(dr, NOT_READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(h2), "after read_instance, not read");
+  passed &= expect_matching(dr, READ_SAMPLE_STATE, NOT_NEW_VIEW_STATE, ALIVE_INSTANCE_STATE,
+                            handle_set(h1), "after read_instance, read");
+
+  // A new sample leaves the instance with both READ and NOT_READ samples.
+  one.count = 2;
+  mdw->write(one, HANDLE_NIL);
+  passed &= expect_matching(dr, NOT_READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(h1, h2), "after writing again, not read");
+  passed &= expect_matching(dr, READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(h1), "after writing again, read");
+
+  mdw->dispose(two, HANDLE_NIL);
+  passed &= expect_matching(dr, ANY_SAMPLE_STATE, ANY_VIEW_STATE, NOT_ALIVE_DISPOSED_INSTANCE_STATE,
+                            handle_set(h2), "after dispose, disposed");
+  passed &= expect_matching(dr, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ALIVE_INSTANCE_STATE,
+                            handle_set(h1), "after dispose, alive");
+
+  // Instances without samples aren't indexed.
+  mdr->take_instance(data, info, LENGTH_UNLIMITED, h1, ANY_SAMPLE_STATE,
+                     ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  mdr->return_loan(data, info);
+  passed &= expect_matching(dr, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(h2), "after take_instance");
+
+  // Taking the rest leaves no instance indexed.
+  mdr->take(data, info, LENGTH_UNLIMITED, ANY_SAMPLE_STATE,
+            ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  mdr->return_loan(data, info);
+  passed &= expect_matching(dr, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                            handle_set(), "after take");
+
+  dp->delete_contained_entities();
+  return passed ? 0 : 1;
+}
+
+// With every instance but one READ, reading the NOT_READ samples has to
+// find that instance without visiting the others.
+int run_test_state_lookup_scale(DDS::DomainParticipant_ptr dp)
+{
+  using namespace DDS;
+  using namespace OpenDDS::DCPS;
+  using namespace Messenger;
+  static const CORBA::Long instance_count = 10000;
+  KeyedMessageTypeSupport_var ts = new KeyedMessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic("LookupScaleTopic", type_name,
+    TOPIC_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  KeyedMessageDataWriter_var mdw = KeyedMessageDataWriter::_narrow(dw);
+  KeyedMessageDataReader_var mdr = KeyedMessageDataReader::_narrow(dr);
+  if (!mdr || !mdw) {
+    cout << "ERROR: failed to create the lookup scale DataReader or DataWriter" << endl;
+    return 1;
+  }
+  if (Utils::wait_match(dw, 1)) {
+    return 1;
+  }
+
+  KeyedMessage msg = {0, 0};
+  for (msg.subject_id = 0; msg.subject_id < instance_count; ++msg.subject_id) {
+    mdw->write(msg, HANDLE_NIL);
+  }
+  Handles all;
+  for (int i = 0; i < 500 && all.size() < static_cast<size_t>(instance_count); ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 20000));
+    all = DDS_TEST::matching(dr, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  }
+  if (all.size() != static_cast<size_t>(instance_count)) {
+    cout << "ERROR: the reader has " << all.size() << " of " << instance_count
+         << " instances" << endl;
+    return 1;
+  }
+
+  KeyedMessageSeq data;
+  SampleInfoSeq info;
+  mdr->read(data, info, LENGTH_UNLIMITED, ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  mdr->return_loan(data, info);
+
+  msg.subject_id = instance_count / 2;
+  msg.count = 1;
+  mdw->write(msg, HANDLE_NIL);
+  const Handles unread = handle_set(mdr->lookup_instance(msg));
+  bool passed = expect_matching(dr, NOT_READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE,
+                                unread, "one of many instances not read");
+  if (!DDS_TEST::lookup_is_faster(dr, NOT_READ_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE, 100)) {
+    cout << "ERROR: looking up the instance that isn't read wasn't faster than "
+         << "walking all of them" << endl;
+    passed = false;
+  }
+
+  dp->delete_contained_entities();
+  return passed ? 0 : 1;
+}
+
+const DDS::Duration_t expiring_lifespan = { 10, 0 };
+
+// Counts the expired samples that were deserialized anyway.
+class ExpiringMessageReader : public OpenDDS::DCPS::DataReaderImpl_T<Messenger::Message> {
+public:
+  ExpiringMessageReader()
+    : decoded_(0)
+    , decoded_expired_(0)
+  {}
+
+  int decoded() const { return decoded_; }
+  int decoded_expired() const { return decoded_expired_; }
+
+protected:
+  DecodedSample* decode_sample(const OpenDDS::DCPS::ReceivedDataSample& sample,
+                               OpenDDS::DCPS::MarshalingType marshaling_type)
+  {
+    ++decoded_;
+    const DDS::Time_t expiration = {
+      sample.header_.source_timestamp_sec_ + expiring_lifespan.sec,
+      sample.header_.source_timestamp_nanosec_
+    };
+    if (OpenDDS::DCPS::SystemTimePoint(expiration) <= OpenDDS::DCPS::SystemTimePoint::now()) {
+      ++decoded_expired_;
+    }
+    return OpenDDS::DCPS::DataReaderImpl_T<Messenger::Message>::decode_sample(
+      sample, marshaling_type);
+  }
+
+private:
+  OpenDDS::DCPS::Atomic<int> decoded_;
+  OpenDDS::DCPS::Atomic<int> decoded_expired_;
+};
+
+class ExpiringMessageTypeSupport : public Messenger::MessageTypeSupportImpl {
+public:
+  DDS::DataReader_ptr create_datareader()
+  {
+    DDS::DataReader_ptr reader_impl = DDS::DataReader::_nil();
+    ACE_NEW_NORETURN(reader_impl, ExpiringMessageReader());
+    return reader_impl;
+  }
+};
+
+// Samples that expire before they arrive are discarded without being
+// deserialized.
+int run_test_reject_expired(DDS::DomainParticipant_ptr dp)
+{
+  using namespace DDS;
+  using namespace OpenDDS::DCPS;
+  using namespace Messenger;
+  MessageTypeSupport_var ts = new ExpiringMessageTypeSupport;
+  ts->register_type(dp, "ExpiringMessage");
+  Topic_var topic = dp->create_topic("ExpiringTopic", "ExpiringMessage",
+    TOPIC_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  dw_qos.lifespan.duration = expiring_lifespan;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    DEFAULT_STATUS_MASK);
+
+  ExpiringMessageReader* const reader = dynamic_cast<ExpiringMessageReader*>(dr.in());
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  if (!reader || !mdw || !mdr) {
+    cout << "ERROR: failed to create the expiring DataReader or DataWriter" << endl;
+    return 1;
+  }
+  if (Utils::wait_match(dw, 1)) {
+    return 1;
+  }
+
+  // The first samples expire before they arrive. The last one is written
+  // with the current time.
+  static const CORBA::Long expired_count = 5;
+  const SystemTimePoint now = SystemTimePoint::now();
+  const Time_t expired_timestamp = {
+    static_cast<CORBA::Long>(now.value().sec()) - 2 * expiring_lifespan.sec, 0
+  };
+  bool passed = true;
+  for (CORBA::Long i = 0; i < expired_count; ++i) {
+    Message msg = {i};
+    if (mdw->write_w_timestamp(msg, HANDLE_NIL, expired_timestamp) != RETCODE_OK) {
+      cout << "ERROR: write_w_timestamp of " << i << " failed" << endl;
+      passed = false;
+    }
+  }
+  passed &= write_message(mdw, expired_count);
+
+  ReadCondition_var rc = dr->create_readcondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  WaitSet_var ws = new WaitSet;
+  ws->attach_condition(rc);
+  bool received = false;
+  const Duration_t timeout = { 10, 0 };
+  while (!received) {
+    ConditionSeq active;
+    if (ws->wait(active, timeout) != RETCODE_OK) {
+      cout << "ERROR: the current sample wasn't received" << endl;
+      passed = false;
+      break;
+    }
+    MessageSeq data;
+    SampleInfoSeq info;
+    if (mdr->take_w_condition(data, info, LENGTH_UNLIMITED, rc) != RETCODE_OK) {
+      continue;
+    }
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      if (!info[i].valid_data) {
+        continue;
+      }
+      if (data[i].subject_id != expired_count) {
+        cout << "ERROR: received expired sample " << data[i].subject_id << endl;
+        passed = false;
+      } else {
+        received = true;
+      }
+    }
+  }
+  ws->detach_condition(rc);
+  dr->delete_readcondition(rc);
+
+  if (reader->decoded() == 0) {
+    cout << "ERROR: the reader didn't deserialize the current sample" << endl;
+    passed = false;
+  }
+  if (reader->decoded_expired() != 0) {
+    cout << "ERROR: the reader deserialized " << reader->decoded_expired()
+         << " expired samples" << endl;
+    passed = false;
+  }
+
+  dp->delete_contained_entities();
+  return passed ? 0 : 1;
+}
+
 int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
 {
   int ret = 1;
@@ -248,6 +1098,11 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
 
     ret = run_test_next_instance(dp);
     ret += run_test_instance(dp);
+    ret += run_test_lazy_deserialization(dp);
+    ret += run_test_batch_write(dp);
+    ret += run_test_reject_expired(dp);
+    ret += run_test_state_lookup(dp);
+    ret += run_test_state_lookup_scale(dp);
 
     dpf->delete_participant(dp);
     TheServiceParticipant->shutdown();
@@ -876,6 +876,77 @@ int run_test(int argc, ACE_TCHAR *argv[])
         delete test_data_container;
       } //End Test Case 4 scope
 
+      { //Test Case 5 scope
+        //=====================================================
+        ACE_DEBUG((LM_INFO,
+          ACE_TEXT("\n\n==== TEST case 5 : Reliable, Keep All, max samples per instance = 2, max samples = 3.\n")
+          ACE_TEXT("A batch has to be flushed before obtain_buffer waits for one of its unsent samples\n")
+          ACE_TEXT("===============================================\n")));
+
+        test->get_default_datawriter_qos(dw_qos);
+        dw_qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+        dw_qos.resource_limits.max_samples = MAX_SAMPLES;
+        dw_qos.resource_limits.max_samples_per_instance = MAX_SAMPLES_PER_INSTANCE;
+
+        OpenDDS::DCPS::unique_ptr<Test::SimpleDataWriterImpl> fast_dw(new Test::SimpleDataWriterImpl());
+        GuidBuilder builder;
+        fast_dw->set_publication_id(builder.create());
+        fast_dw->set_qos(dw_qos);
+        test->setup_serialization(fast_dw.get());
+        test->substitute_dw_particpant(fast_dw.get(), tpi);
+        WriteDataContainer* test_data_container =
+          test->get_test_data_container(dw_qos, fast_dw.get(), deadline_status_lock,
+                                        deadline_status, deadline_last_total_count);
+
+        test->log_dw_qos_limits(dw_qos);
+        test->log_perceived_qos_limits(test_data_container);
+
+        TEST_ASSERT(!test_data_container->batch_needs_flush(0, 0));
+        TEST_ASSERT(!test_data_container->batch_needs_flush(1, 1));
+        TEST_ASSERT(!test_data_container->batch_needs_flush(1, 2));
+        // The instance is at max_samples_per_instance.
+        TEST_ASSERT(test_data_container->batch_needs_flush(2, 2));
+        // The writer is at max_samples.
+        TEST_ASSERT(test_data_container->batch_needs_flush(1, 3));
+
+        delete test_data_container;
+      } //End Test Case 5 scope
+
+      { //Test Case 6 scope
+        //=====================================================
+        ACE_DEBUG((LM_INFO,
+          ACE_TEXT("\n\n==== TEST case 6 : Reliable, Keep Last, depth = 2, max samples unlimited.\n")
+          ACE_TEXT("A batch has to be flushed before obtain_buffer replaces one of its unsent samples\n")
+          ACE_TEXT("===============================================\n")));
+
+        test->get_default_datawriter_qos(dw_qos);
+        dw_qos.history.kind = DDS::KEEP_LAST_HISTORY_QOS;
+        dw_qos.history.depth = HISTORY_DEPTH;
+
+        OpenDDS::DCPS::unique_ptr<Test::SimpleDataWriterImpl> fast_dw(new Test::SimpleDataWriterImpl());
+        GuidBuilder builder;
+        fast_dw->set_publication_id(builder.create());
+        fast_dw->set_qos(dw_qos);
+        test->setup_serialization(fast_dw.get());
+        test->substitute_dw_particpant(fast_dw.get(), tpi);
+        WriteDataContainer* test_data_container =
+          test->get_test_data_container(dw_qos, fast_dw.get(), deadline_status_lock,
+                                        deadline_status, deadline_last_total_count);
+
+        test->log_dw_qos_limits(dw_qos);
+        test->log_perceived_qos_limits(test_data_container);
+
+        TEST_ASSERT(!test_data_container->batch_needs_flush(1, 1));
+        // Samples for other instances don't count against the depth.
+        TEST_ASSERT(!test_data_container->batch_needs_flush(1, 5));
+        // The instance is at history.depth, so its oldest sample could be
+        // replaced even though max_samples_per_instance is unlimited.
+        TEST_ASSERT(test_data_container->batch_needs_flush(2, 2));
+        TEST_ASSERT(test_data_container->batch_needs_flush(HISTORY_DEPTH + 1, HISTORY_DEPTH + 1));
+
+        delete test_data_container;
+      } //End Test Case 6 scope
+
     } catch (const TestException&) {
       ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) TestException caught in main.cpp.")));
       return 1;
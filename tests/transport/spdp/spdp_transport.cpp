@@ -15,6 +15,7 @@
 #include <dds/DCPS/RTPS/Spdp.h>
 
 #include <dds/DCPS/LogAddr.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
 #include <dds/DCPS/NetworkResource.h>
 #include <dds/DCPS/Service_Participant.h>
 
@@ -31,6 +32,7 @@
 #include <ace/OS_NS_arpa_inet.h>
 #include <ace/OS_NS_unistd.h>
 
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <string>
@@ -69,6 +71,83 @@ public:
     }
   }
 
+  struct ParticipantState {
+    MonotonicTimePoint lease_expiration;
+    OpenDDS::DCPS::SequenceNumber max_seq;
+    DDS::OctetSeq user_data;
+  };
+
+  bool get_participant_state(ParticipantState& state)
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, spdp_->lock_, false);
+    const Spdp::DiscoveredParticipantIter iter = spdp_->participants_.find(guid_);
+    if (iter == spdp_->participants_.end()) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: Expected to find the participant, but didn't\n")));
+      return false;
+    }
+    state.lease_expiration = iter->second.lease_expiration_;
+    state.max_seq = iter->second.max_seq_;
+    state.user_data = user_data(iter->second.pdata_).value;
+    return true;
+  }
+
+  /// Change the user data Spdp has for the participant without it being
+  /// announced, so it shows if the next announcement is decoded.
+  void set_participant_user_data(const DDS::OctetSeq& value)
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, spdp_->lock_);
+    const Spdp::DiscoveredParticipantIter iter = spdp_->participants_.find(guid_);
+    if (iter != spdp_->participants_.end()) {
+      user_data(iter->second.pdata_).value = value;
+    }
+  }
+
+  static DDS::UserDataQosPolicy& user_data(ParticipantData_t& pdata)
+  {
+#if OPENDDS_CONFIG_SECURITY
+    return pdata.ddsParticipantDataSecure.base.base.user_data;
+#else
+    return pdata.ddsParticipantData.user_data;
+#endif
+  }
+
+  /// Make sure the local announcement is up to date and return a reference
+  /// to it. Holding on to it keeps its data block from being reused by the
+  /// next announcement, so the data blocks show if it was rebuilt.
+  ACE_Message_Block* announcement()
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, g, spdp_->lock_, 0);
+    if (!spdp_->tport_ || !spdp_->tport_->update_announcement(*spdp_)) {
+      ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: Failed to update the announcement\n")));
+      return 0;
+    }
+    return spdp_->tport_->announcement_->duplicate();
+  }
+
+  /// Make the locators the announcement was built with differ from the
+  /// current ones.
+  void change_announced_locators(bool unicast)
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, spdp_->lock_);
+    LocatorSeq& locators = unicast ?
+      spdp_->tport_->announced_unicast_locators_ : spdp_->tport_->announced_multicast_locators_;
+    const CORBA::ULong i = locators.length();
+    locators.length(i + 1);
+    locators[i].kind = LOCATOR_KIND_UDPv4;
+    locators[i].port = 1;
+    std::memset(locators[i].address, 0, sizeof locators[i].address);
+  }
+
+#if OPENDDS_CONFIG_SECURITY
+  /// Make the ICE agent info the announcement was built with differ from
+  /// the current info.
+  void change_announced_agent_info()
+  {
+    ACE_GUARD(ACE_Thread_Mutex, g, spdp_->lock_);
+    spdp_->tport_->announced_agent_info_["changed"] = OpenDDS::ICE::AgentInfo();
+  }
+#endif
+
   bool get_multicast_address(ACE_INET_Addr& addr) {
     if (!spdp_->tport_) {
       ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: Null SPDP Transport\n")));
@@ -314,6 +393,95 @@ void to_locator(const ACE_INET_Addr& addr, Locator_t& locator)
   }
 }
 
+CORBA::ULongLong get_stat(const RcHandle<Spdp>& spdp, const char* name)
+{
+  StatisticSeq stats;
+  spdp->fill_stats(stats);
+  for (CORBA::ULong i = 0; i < stats.length(); ++i) {
+    if (std::strcmp(stats[i].name.in(), name) == 0) {
+      return stats[i].value;
+    }
+  }
+  ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: No %C statistic\n"), name));
+  return 0;
+}
+
+DDS::OctetSeq octets(const char* value)
+{
+  DDS::OctetSeq seq;
+  seq.length(static_cast<CORBA::ULong>(std::strlen(value)));
+  std::memcpy(seq.get_buffer(), value, seq.length());
+  return seq;
+}
+
+bool same_octets(const DDS::OctetSeq& x, const DDS::OctetSeq& y)
+{
+  return x.length() == y.length() && std::memcmp(x.get_buffer(), y.get_buffer(), x.length()) == 0;
+}
+
+bool same_bytes(const ACE_Message_Block& x, const ACE_Message_Block& y)
+{
+  return x.length() == y.length() && std::memcmp(x.rd_ptr(), y.rd_ptr(), x.length()) == 0;
+}
+
+// The encoded announcement is reused until something that's in it changes.
+bool check_announcement_cache(const RcHandle<Spdp>& spdp, DDS_TEST& spdp_friend,
+                              const DDS::DomainParticipantQos& qos)
+{
+  const Message_Block_Ptr first(spdp_friend.announcement());
+  const Message_Block_Ptr unchanged(spdp_friend.announcement());
+  if (!first || !unchanged) {
+    return false;
+  }
+  if (unchanged->data_block() != first->data_block()) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement was rebuilt when nothing changed\n")));
+    return false;
+  }
+
+  spdp_friend.change_announced_locators(true);
+  const Message_Block_Ptr unicast(spdp_friend.announcement());
+  if (!unicast || unicast->data_block() == first->data_block() || !same_bytes(*unicast, *first)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement wasn't rebuilt when the unicast locators changed\n")));
+    return false;
+  }
+
+  spdp_friend.change_announced_locators(false);
+  const Message_Block_Ptr multicast(spdp_friend.announcement());
+  if (!multicast || multicast->data_block() == unicast->data_block() || !same_bytes(*multicast, *first)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement wasn't rebuilt when the multicast locators changed\n")));
+    return false;
+  }
+
+  const Message_Block_Ptr* latest = &multicast;
+#if OPENDDS_CONFIG_SECURITY
+  spdp_friend.change_announced_agent_info();
+  const Message_Block_Ptr agent_info(spdp_friend.announcement());
+  if (!agent_info || agent_info->data_block() == multicast->data_block() || !same_bytes(*agent_info, *first)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement wasn't rebuilt when the ICE agent info changed\n")));
+    return false;
+  }
+  latest = &agent_info;
+#endif
+
+  DDS::DomainParticipantQos changed_qos = qos;
+  changed_qos.user_data.value.length(4);
+  std::memset(changed_qos.user_data.value.get_buffer(), 'u', 4);
+  spdp->update_domain_participant_qos(changed_qos);
+  const Message_Block_Ptr changed(spdp_friend.announcement());
+  if (!changed || changed->data_block() == (*latest)->data_block() || same_bytes(*changed, *first)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement wasn't rebuilt when the QoS changed\n")));
+    return false;
+  }
+  const Message_Block_Ptr changed_again(spdp_friend.announcement());
+  if (!changed_again || changed_again->data_block() != changed->data_block()) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The announcement was rebuilt after the QoS change\n")));
+    return false;
+  }
+
+  spdp->update_domain_participant_qos(qos);
+  return true;
+}
+
 bool run_test()
 {
   // Create and initialize RtpsDiscovery
@@ -600,6 +768,96 @@ bool run_test()
     }
   }
 
+  // An announcement with the same bytes as the last one that was applied
+  // only renews the lease, a changed one is decoded.
+  ACE_DEBUG((LM_DEBUG, ACE_TEXT("Unchanged Announcement Test\n")));
+  spdp_friend.remove_participant();
+  const CORBA::ULongLong hits = get_stat(spdp, "AnnouncementCacheHits");
+  const CORBA::ULongLong misses = get_stat(spdp, "AnnouncementCacheMisses");
+  // The first announcement discovers the participant and the second one is
+  // kept to compare with the next ones.
+  for (seq = first_seq; seq.low < 3; ++seq.low) {
+    if (!part1.send_data(test_part_guid.entityId, seq, plist, send_addr)) {
+      return false;
+    }
+    reactor_wait();
+    if (spdp_friend.check_for_participant(true)) {
+      return false;
+    }
+  }
+  // Spdp also gets its own announcements, which don't match any participant.
+  if (get_stat(spdp, "AnnouncementCacheHits") != hits ||
+      get_stat(spdp, "AnnouncementCacheMisses") < misses + 2) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: Announcements that discovered the participant weren't counted as misses\n")));
+    return false;
+  }
+
+  DDS_TEST::ParticipantState before;
+  spdp_friend.set_participant_user_data(octets("not announced"));
+  if (!spdp_friend.get_participant_state(before) ||
+      !part1.send_data(test_part_guid.entityId, seq, plist, send_addr)) {
+    return false;
+  }
+  reactor_wait();
+  DDS_TEST::ParticipantState after;
+  if (!spdp_friend.get_participant_state(after)) {
+    return false;
+  }
+  if (get_stat(spdp, "AnnouncementCacheHits") != hits + 1) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The unchanged announcement wasn't counted as a hit\n")));
+    return false;
+  }
+  if (!(before.lease_expiration < after.lease_expiration) || after.max_seq != to_opendds_seqnum(seq)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The unchanged announcement didn't renew the lease\n")));
+    return false;
+  }
+  if (!same_octets(after.user_data, octets("not announced"))) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The unchanged announcement was decoded\n")));
+    return false;
+  }
+
+  OpenDDS::RTPS::SPDPdiscoveredParticipantData changed_pdata = pdata;
+  changed_pdata.ddsParticipantData.user_data.value = octets("changed");
+  OpenDDS::RTPS::ParameterList changed_plist;
+  if (!OpenDDS::RTPS::ParameterListConverter::to_param_list(changed_pdata, changed_plist)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: Failed to convert the changed participant data\n")));
+    return false;
+  }
+  const CORBA::ULongLong misses_before_change = get_stat(spdp, "AnnouncementCacheMisses");
+  ++seq.low;
+  if (!part1.send_data(test_part_guid.entityId, seq, changed_plist, send_addr)) {
+    return false;
+  }
+  reactor_wait();
+  if (!spdp_friend.get_participant_state(after)) {
+    return false;
+  }
+  if (get_stat(spdp, "AnnouncementCacheHits") != hits + 1 ||
+      get_stat(spdp, "AnnouncementCacheMisses") < misses_before_change + 1) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The changed announcement wasn't counted as a miss\n")));
+    return false;
+  }
+  if (!same_octets(after.user_data, octets("changed")) || after.max_seq != to_opendds_seqnum(seq)) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The changed announcement wasn't decoded\n")));
+    return false;
+  }
+
+  // The changed announcement is the one compared with from now on.
+  ++seq.low;
+  if (!part1.send_data(test_part_guid.entityId, seq, changed_plist, send_addr)) {
+    return false;
+  }
+  reactor_wait();
+  if (get_stat(spdp, "AnnouncementCacheHits") != hits + 2) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("ERROR: The repeated changed announcement wasn't counted as a hit\n")));
+    return false;
+  }
+
+  ACE_DEBUG((LM_DEBUG, ACE_TEXT("Announcement Cache Test\n")));
+  if (!check_announcement_cache(spdp, spdp_friend, qos)) {
+    return false;
+  }
+
   spdp->shutdown();
 
   return true;
@@ -0,0 +1,138 @@
+#include <KeyHashTypeSupportImpl.h>
+
+#include <dds/DCPS/KeyHash.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <new>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  template <typename T>
+  bool same_key(const T& lhs, const T& rhs)
+  {
+    return KeyEqual<typename DDSTraits<T>::LessThanType>()(lhs, rhs);
+  }
+
+  template <typename T>
+  size_t key_hash(const T& value)
+  {
+    return typename DDSTraits<T>::KeyHashType()(value);
+  }
+
+  // Construct in memory filled with a pattern, so padding differs between
+  // values constructed with different patterns.
+  template <typename T>
+  struct Dirty {
+    explicit Dirty(unsigned char fill)
+    {
+      std::memset(storage_, fill, sizeof storage_);
+      value_ = new(storage_) T;
+    }
+
+    ~Dirty()
+    {
+      value_->~T();
+    }
+
+    union {
+      unsigned char storage_[sizeof(T)];
+      double align_;
+    };
+    T* value_;
+  };
+}
+
+TEST(dds_DCPS_KeyHash, padded_keys)
+{
+  Dirty<KeyHashTest::Padded> a(0x00);
+  Dirty<KeyHashTest::Padded> b(0xff);
+  a.value_->small = b.value_->small = 1;
+  a.value_->big = b.value_->big = 2;
+  a.value_->medium = b.value_->medium = 3;
+  a.value_->real = b.value_->real = 4.5;
+  a.value_->non_key = "a";
+  b.value_->non_key = "b";
+
+  ASSERT_TRUE(same_key(*a.value_, *b.value_));
+  EXPECT_EQ(key_hash(*a.value_), key_hash(*b.value_));
+
+  b.value_->medium = 4;
+  ASSERT_FALSE(same_key(*a.value_, *b.value_));
+  EXPECT_NE(key_hash(*a.value_), key_hash(*b.value_));
+}
+
+TEST(dds_DCPS_KeyHash, string_keys)
+{
+  KeyHashTest::StringKey a;
+  a.name = "instance";
+  a.real = 1.0f;
+  a.non_key = 1;
+  KeyHashTest::StringKey b;
+  // A different buffer with the same characters.
+  b.name = CORBA::string_dup("instance");
+  b.real = 1.0f;
+  b.non_key = 2;
+
+  ASSERT_TRUE(same_key(a, b));
+  EXPECT_EQ(key_hash(a), key_hash(b));
+
+  b.name = "instances";
+  ASSERT_FALSE(same_key(a, b));
+  EXPECT_NE(key_hash(a), key_hash(b));
+
+  b.name = "";
+  a.name = "";
+  EXPECT_EQ(key_hash(a), key_hash(b));
+}
+
+TEST(dds_DCPS_KeyHash, signed_zero)
+{
+  KeyHashTest::StringKey a;
+  a.name = "zero";
+  a.real = 0.0f;
+  KeyHashTest::StringKey b;
+  b.name = "zero";
+  b.real = -0.0f;
+  ASSERT_TRUE(same_key(a, b));
+  EXPECT_EQ(key_hash(a), key_hash(b));
+
+  KeyHashTest::Padded c;
+  c.small = 0;
+  c.big = 0;
+  c.medium = 0;
+  c.real = 0.0;
+  KeyHashTest::Padded d(c);
+  d.real = -0.0;
+  ASSERT_TRUE(same_key(c, d));
+  EXPECT_EQ(key_hash(c), key_hash(d));
+}
+
+TEST(dds_DCPS_KeyHash, nested_keys)
+{
+  KeyHashTest::Nested a;
+  a.inner.id = 1;
+  a.inner.name = "inner";
+  a.inner.non_key = 1;
+  a.id = 2;
+  KeyHashTest::Nested b(a);
+  b.inner.non_key = 2;
+
+  ASSERT_TRUE(same_key(a, b));
+  EXPECT_EQ(key_hash(a), key_hash(b));
+
+  b.inner.name = "other";
+  ASSERT_FALSE(same_key(a, b));
+  EXPECT_NE(key_hash(a), key_hash(b));
+
+  // The overload opendds_idl generates for structs used as key members.
+  size_t inner_a = 0;
+  hash_key_member(inner_a, a.inner);
+  size_t inner_b = 0;
+  b.inner.name = "inner";
+  hash_key_member(inner_b, b.inner);
+  EXPECT_EQ(inner_a, inner_b);
+  EXPECT_NE(inner_a, 0u);
+}
@@ -0,0 +1,137 @@
+#include <dds/DCPS/RTPS/ReorderBuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace OpenDDS::RTPS;
+
+namespace {
+  typedef ReorderBuffer<std::string, int> Buffer;
+
+  struct Handler {
+    void operator()(const std::string& item)
+    {
+      if (!item.empty()) {
+        handled.push_back(item);
+      }
+    }
+
+    std::vector<std::string> handled;
+  };
+
+  // Completes another item while handling one, like a decode thread
+  // finishing while the committing thread has the lock released.
+  struct CompletingHandler {
+    CompletingHandler(Buffer& buffer, ACE_UINT64 index)
+      : buffer_(buffer)
+      , index_(index)
+    {}
+
+    void operator()(const std::string& item)
+    {
+      handled.push_back(item);
+      if (item == "a") {
+        buffer_.complete(index_, "b", *this);
+      }
+    }
+
+    Buffer& buffer_;
+    const ACE_UINT64 index_;
+    std::vector<std::string> handled;
+  };
+}
+
+TEST(dds_DCPS_RTPS_ReorderBuffer, out_of_order_completion)
+{
+  Buffer buffer;
+  Handler handler;
+  const ACE_UINT64 a = buffer.start(1);
+  const ACE_UINT64 b = buffer.start(2);
+  const ACE_UINT64 c = buffer.start(1);
+
+  buffer.complete(c, "c", handler);
+  buffer.complete(b, "b", handler);
+  EXPECT_TRUE(handler.handled.empty());
+  EXPECT_EQ(buffer.pending(), 3u);
+
+  buffer.complete(a, "a", handler);
+  ASSERT_EQ(handler.handled.size(), 3u);
+  EXPECT_EQ(handler.handled[0], "a");
+  EXPECT_EQ(handler.handled[1], "b");
+  EXPECT_EQ(handler.handled[2], "c");
+  EXPECT_EQ(buffer.pending(), 0u);
+}
+
+TEST(dds_DCPS_RTPS_ReorderBuffer, completed_while_handling)
+{
+  Buffer buffer;
+  const ACE_UINT64 a = buffer.start(1);
+  const ACE_UINT64 b = buffer.start(1);
+  CompletingHandler handler(buffer, b);
+
+  buffer.complete(a, "a", handler);
+  ASSERT_EQ(handler.handled.size(), 2u);
+  EXPECT_EQ(handler.handled[0], "a");
+  EXPECT_EQ(handler.handled[1], "b");
+  EXPECT_EQ(buffer.pending(), 0u);
+}
+
+TEST(dds_DCPS_RTPS_ReorderBuffer, failed_item)
+{
+  Buffer buffer;
+  Handler handler;
+  const ACE_UINT64 a = buffer.start(1);
+  const ACE_UINT64 b = buffer.start(1);
+
+  buffer.complete(b, "b", handler);
+  // Like a sample that couldn't be dispatched or decoded.
+  buffer.complete(a, std::string(), handler);
+  ASSERT_EQ(handler.handled.size(), 1u);
+  EXPECT_EQ(handler.handled[0], "b");
+  EXPECT_EQ(buffer.pending(), 0u);
+}
+
+TEST(dds_DCPS_RTPS_ReorderBuffer, drop_group)
+{
+  Buffer buffer;
+  Handler handler;
+  const ACE_UINT64 a = buffer.start(1);
+  const ACE_UINT64 b = buffer.start(2);
+  const ACE_UINT64 c = buffer.start(1);
+  buffer.complete(c, "c", handler);
+
+  // Group 1 is removed and comes back before its items are handled.
+  buffer.drop(1);
+  const ACE_UINT64 d = buffer.start(1);
+
+  buffer.complete(b, "b", handler);
+  buffer.complete(d, "d", handler);
+  buffer.complete(a, "a", handler);
+  ASSERT_EQ(handler.handled.size(), 2u);
+  EXPECT_EQ(handler.handled[0], "b");
+  EXPECT_EQ(handler.handled[1], "d");
+  EXPECT_EQ(buffer.pending(), 0u);
+}
+
+TEST(dds_DCPS_RTPS_ReorderBuffer, shutdown_with_pending_items)
+{
+  Buffer buffer;
+  Handler handler;
+  const ACE_UINT64 a = buffer.start(1);
+  const ACE_UINT64 b = buffer.start(1);
+  buffer.complete(b, "b", handler);
+
+  buffer.shutdown();
+  EXPECT_EQ(buffer.pending(), 2u);
+
+  // The decode threads still finish what they were given.
+  buffer.complete(a, "a", handler);
+  EXPECT_TRUE(handler.handled.empty());
+  EXPECT_EQ(buffer.pending(), 0u);
+
+  const ACE_UINT64 c = buffer.start(1);
+  buffer.complete(c, "c", handler);
+  EXPECT_TRUE(handler.handled.empty());
+}
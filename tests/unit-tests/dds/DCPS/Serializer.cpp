@@ -1,9 +1,13 @@
+#include <dds/DCPS/ByteSwap.h>
 #include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/TimeTypes.h>
 #include <dds/DCPS/debug.h>
 
 #include <gtest/gtest.h>
 
 #include <cstring>
+#include <iostream>
+#include <vector>
 
 using namespace OpenDDS::DCPS;
 
@@ -795,3 +799,123 @@ TEST(dds_DCPS_Serializer, read_parameter_id_xcdr2_truncated_nextint)
     test_read_parameter_id_xcdr2_malformed(xcdr, sizeof(xcdr));
   }
 }
+
+namespace {
+  void check_swap_array(size_t size)
+  {
+    for (size_t n = 0; n < 70; ++n) {
+      // Use an odd offset so the vector loads and stores are unaligned.
+      std::vector<char> from(n * size + 1), to(n * size + 1, 0);
+      for (size_t i = 0; i < from.size(); ++i) {
+        from[i] = static_cast<char>(i * 7 + 1);
+      }
+      ASSERT_TRUE(swap_array(&to[1], &from[1], size, n));
+      for (size_t e = 0; e < n; ++e) {
+        for (size_t b = 0; b < size; ++b) {
+          ASSERT_EQ(from[1 + e * size + b], to[1 + e * size + size - 1 - b]);
+        }
+      }
+    }
+  }
+}
+
+TEST(dds_DCPS_Serializer, swap_array_2)
+{
+  check_swap_array(2);
+}
+
+TEST(dds_DCPS_Serializer, swap_array_4)
+{
+  check_swap_array(4);
+}
+
+TEST(dds_DCPS_Serializer, swap_array_8)
+{
+  check_swap_array(8);
+}
+
+TEST(dds_DCPS_Serializer, swap_array_other_size)
+{
+  char from[16] = {0};
+  char to[16] = {0};
+  EXPECT_FALSE(swap_array(to, from, 16, 1));
+}
+
+TEST(dds_DCPS_Serializer, swapped_array_across_blocks)
+{
+  // Block sizes that split elements of every size at different points
+  const size_t sizes[] = {5, 7, 3, 16, 1, 11, 64, 9, 128};
+  OpenDDS::DCPS::Message_Block_Ptr amb(new ACE_Message_Block(sizes[0]));
+  ACE_Message_Block* last = amb.get();
+  for (size_t i = 1; i < sizeof sizes / sizeof sizes[0]; ++i) {
+    last->cont(new ACE_Message_Block(sizes[i]));
+    last = last->cont();
+  }
+
+  const Encoding enc(Encoding::KIND_UNALIGNED_CDR, ENDIAN_NONNATIVE);
+  ACE_CDR::UShort shorts[13];
+  ACE_CDR::ULong longs[11];
+  ACE_CDR::ULongLong longlongs[7];
+  for (ACE_CDR::UShort i = 0; i < 13; ++i) {
+    shorts[i] = static_cast<ACE_CDR::UShort>(0x0102 * (i + 1));
+  }
+  for (ACE_CDR::ULong i = 0; i < 11; ++i) {
+    longs[i] = 0x01020304u * (i + 1);
+  }
+  for (ACE_CDR::ULong i = 0; i < 7; ++i) {
+    longlongs[i] = ACE_UINT64_LITERAL(0x0102030405060708) * (i + 1);
+  }
+
+  Serializer ser(amb.get(), enc);
+  ASSERT_TRUE(ser.write_ushort_array(shorts, 13));
+  ASSERT_TRUE(ser.write_ulong_array(longs, 11));
+  ASSERT_TRUE(ser.write_ulonglong_array(longlongs, 7));
+  EXPECT_EQ(13u * 2 + 11u * 4 + 7u * 8, ser.wpos());
+
+  // The first element goes out in non-native order
+  const unsigned char first_byte = static_cast<unsigned char>(*amb->rd_ptr());
+  EXPECT_EQ(ENDIAN_NATIVE == ENDIAN_LITTLE ? 0x01 : 0x02, first_byte);
+
+  ACE_CDR::UShort shorts_out[13];
+  ACE_CDR::ULong longs_out[11];
+  ACE_CDR::ULongLong longlongs_out[7];
+  Serializer rser(amb.get(), enc);
+  ASSERT_TRUE(rser.read_ushort_array(shorts_out, 13));
+  ASSERT_TRUE(rser.read_ulong_array(longs_out, 11));
+  ASSERT_TRUE(rser.read_ulonglong_array(longlongs_out, 7));
+  EXPECT_EQ(0, std::memcmp(shorts, shorts_out, sizeof shorts));
+  EXPECT_EQ(0, std::memcmp(longs, longs_out, sizeof longs));
+  EXPECT_EQ(0, std::memcmp(longlongs, longlongs_out, sizeof longlongs));
+}
+
+TEST(dds_DCPS_Serializer, swapped_array_short_buffer)
+{
+  ACE_Message_Block mb(10);
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_NONNATIVE);
+  const ACE_CDR::Float floats[3] = {1.0f, 2.0f, 3.0f};
+  Serializer ser(&mb, enc);
+  EXPECT_FALSE(ser.write_float_array(floats, 3));
+}
+
+// Not run by default, use --gtest_also_run_disabled_tests to get throughput
+// numbers for swapped float sequences.
+TEST(dds_DCPS_Serializer, DISABLED_swapped_array_benchmark)
+{
+  const ACE_CDR::ULong count = 1024 * 1024;
+  const int iterations = 50;
+  std::vector<ACE_CDR::Float> floats(count, 1.5f);
+  ACE_Message_Block mb(count * sizeof(ACE_CDR::Float));
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_NONNATIVE);
+
+  const MonotonicTimePoint start = MonotonicTimePoint::now();
+  for (int i = 0; i < iterations; ++i) {
+    mb.reset();
+    Serializer ser(&mb, enc);
+    ASSERT_TRUE(ser.write_float_array(&floats[0], count));
+    Serializer rser(&mb, enc);
+    ASSERT_TRUE(rser.read_float_array(&floats[0], count));
+  }
+  const double seconds = (MonotonicTimePoint::now() - start).to_double();
+  std::cout << "swapped " << 2.0 * iterations * count * sizeof(ACE_CDR::Float) / seconds / 1e6
+            << " MB/s" << std::endl;
+}
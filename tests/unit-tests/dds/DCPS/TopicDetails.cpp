@@ -0,0 +1,139 @@
+#include <dds/DCPS/TopicDetails.h>
+
+#include <dds/DCPS/DCPS_Utils.h>
+
+#include <gtest/gtest.h>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  DDS::PartitionQosPolicy partition(const char* a = 0, const char* b = 0)
+  {
+    DDS::PartitionQosPolicy policy;
+    if (a) {
+      policy.name.length(1);
+      policy.name[0] = a;
+    }
+    if (b) {
+      policy.name.length(2);
+      policy.name[1] = b;
+    }
+    return policy;
+  }
+
+  bool has_wildcard(const DDS::PartitionQosPolicy& policy)
+  {
+    for (CORBA::ULong i = 0; i < policy.name.length(); ++i) {
+      if (is_wildcard(policy.name[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  GUID_t endpoint(size_t i)
+  {
+    GUID_t guid = GUID_UNKNOWN;
+    guid.entityId.entityKey[2] = static_cast<CORBA::Octet>(i);
+    return guid;
+  }
+
+  const DDS::PartitionQosPolicy policies[] = {
+    partition(),
+    partition(""),
+    partition("A"),
+    partition("B"),
+    partition("A", "B"),
+    partition("", "C"),
+    partition("AB"),
+    partition("A*"),
+    partition("?B"),
+    partition("*"),
+    partition("C", "[AB]")
+  };
+  const size_t policy_count = sizeof policies / sizeof policies[0];
+
+  // The endpoints find() returns for each policy must include all the ones
+  // matching_partitions() matches. Ones without a wildcard in their own
+  // partitions are only returned if they match.
+  void check_index(bool index_publications)
+  {
+    PartitionIndex index;
+    for (size_t i = 0; i < policy_count; ++i) {
+      index.insert(endpoint(i), policies[i]);
+    }
+
+    for (size_t q = 0; q < policy_count; ++q) {
+      RepoIdSet result;
+      if (has_wildcard(policies[q])) {
+        EXPECT_FALSE(index.find(policies[q], result)) << "query " << q;
+        continue;
+      }
+      ASSERT_TRUE(index.find(policies[q], result)) << "query " << q;
+
+      for (size_t i = 0; i < policy_count; ++i) {
+        const bool match = index_publications ?
+          matching_partitions(policies[i], policies[q]) :
+          matching_partitions(policies[q], policies[i]);
+        const bool found = result.count(endpoint(i));
+        if (match || has_wildcard(policies[i])) {
+          EXPECT_TRUE(found) << "query " << q << " endpoint " << i;
+        } else {
+          EXPECT_FALSE(found) << "query " << q << " endpoint " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(dds_DCPS_TopicDetails, PartitionIndex_publications)
+{
+  check_index(true);
+}
+
+TEST(dds_DCPS_TopicDetails, PartitionIndex_subscriptions)
+{
+  check_index(false);
+}
+
+TEST(dds_DCPS_TopicDetails, PartitionIndex_default_partition)
+{
+  PartitionIndex index;
+  index.insert(endpoint(0), partition());
+  index.insert(endpoint(1), partition(""));
+  index.insert(endpoint(2), partition("A"));
+
+  RepoIdSet result;
+  ASSERT_TRUE(index.find(partition(), result));
+  EXPECT_EQ(result.size(), 2u);
+  EXPECT_TRUE(result.count(endpoint(0)));
+  EXPECT_TRUE(result.count(endpoint(1)));
+
+  result.clear();
+  ASSERT_TRUE(index.find(partition("A", ""), result));
+  EXPECT_EQ(result.size(), 3u);
+}
+
+TEST(dds_DCPS_TopicDetails, PartitionIndex_update_and_remove)
+{
+  PartitionIndex index;
+  index.insert(endpoint(0), partition("A", "B"));
+  index.insert(endpoint(1), partition("A*"));
+
+  // Changing the partitions replaces the old ones.
+  index.insert(endpoint(0), partition("C"));
+  RepoIdSet result;
+  ASSERT_TRUE(index.find(partition("A"), result));
+  EXPECT_EQ(result.size(), 1u);
+  EXPECT_TRUE(result.count(endpoint(1)));
+
+  result.clear();
+  ASSERT_TRUE(index.find(partition("C"), result));
+  EXPECT_EQ(result.size(), 2u);
+
+  index.remove(endpoint(0));
+  index.remove(endpoint(1));
+  result.clear();
+  ASSERT_TRUE(index.find(partition("C"), result));
+  EXPECT_TRUE(result.empty());
+}
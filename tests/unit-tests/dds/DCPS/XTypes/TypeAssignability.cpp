@@ -4144,3 +4144,35 @@ TEST(dds_DCPS_XTypes_TypeAssignability, UnionTypeTest_NotAssignable)
   b10.member_seq.append(mb10_1);
   EXPECT_FALSE(test.assignable(TypeObject(MinimalTypeObject(a10)), TypeObject(MinimalTypeObject(b10))));
 }
+
+TEST(dds_DCPS_XTypes_TypeAssignability, TypeInformation_CachedUntilTypeAdded)
+{
+  const TypeLookupService_rch tls = make_rch<TypeLookupService>();
+  TypeAssignability test(tls);
+
+  EquivalenceHash hash;
+  get_equivalence_hash(hash);
+  const TypeIdentifier alias_id = make(EK_MINIMAL, hash);
+
+  TypeInformation reader;
+  reader.minimal.typeid_with_size.type_id = alias_id;
+  reader.complete.typeid_with_size.type_id = TypeIdentifier(TK_NONE);
+  TypeInformation writer;
+  writer.minimal.typeid_with_size.type_id = TypeIdentifier(TK_INT32);
+  writer.complete.typeid_with_size.type_id = TypeIdentifier(TK_NONE);
+
+  // The alias isn't known yet
+  EXPECT_FALSE(test.assignable(reader, writer));
+  EXPECT_FALSE(test.assignable(reader, writer));
+
+  MinimalAliasType alias;
+  alias.body.common.related_type = TypeIdentifier(TK_INT32);
+  test.insert_entry(alias_id, TypeObject(MinimalTypeObject(alias)));
+  EXPECT_TRUE(test.assignable(reader, writer));
+
+  // A different TypeAssignability with the same settings uses the same result
+  TypeAssignability test2(tls);
+  EXPECT_TRUE(test2.assignable(reader, writer));
+  test2.set_prevent_type_widening(true);
+  EXPECT_TRUE(test2.assignable(reader, writer));
+}
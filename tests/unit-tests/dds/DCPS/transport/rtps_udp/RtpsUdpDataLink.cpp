@@ -0,0 +1,86 @@
+#include <dds/DCPS/transport/rtps_udp/RtpsUdpDataLink.h>
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Dgram.h>
+
+#include <gtest/gtest.h>
+
+using namespace OpenDDS::DCPS;
+
+#if OPENDDS_RTPS_UDP_HAS_REUSEPORT
+namespace {
+  const ACE_INET_Addr loopback(static_cast<unsigned short>(0), "127.0.0.1");
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpDataLink, open_first_reuseport_socket_rejects_port_in_use)
+{
+  ACE_SOCK_Dgram other;
+  ASSERT_EQ(other.open(loopback), 0);
+  ACE_INET_Addr in_use;
+  other.get_local_addr(in_use);
+
+  ACE_SOCK_Dgram sock;
+  EXPECT_FALSE(RtpsUdpDataLink::open_first_reuseport_socket(sock, in_use));
+  other.close();
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpDataLink, open_first_reuseport_socket_rejects_shared_port)
+{
+  // Another process of the same user sharing its port with SO_REUSEPORT.
+  ACE_SOCK_Dgram other;
+  ASSERT_TRUE(RtpsUdpDataLink::open_first_reuseport_socket(other, loopback));
+  ACE_INET_Addr in_use;
+  other.get_local_addr(in_use);
+
+  ACE_SOCK_Dgram sock;
+  EXPECT_FALSE(RtpsUdpDataLink::open_first_reuseport_socket(sock, in_use));
+  other.close();
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpDataLink, receive_shards)
+{
+  static const int shard_count = 4;
+  ACE_SOCK_Dgram shards[shard_count];
+  ASSERT_TRUE(RtpsUdpDataLink::open_first_reuseport_socket(shards[0], loopback));
+  ACE_INET_Addr addr;
+  shards[0].get_local_addr(addr);
+  for (int i = 1; i < shard_count; ++i) {
+    ASSERT_TRUE(RtpsUdpDataLink::open_reuseport_socket(shards[i], addr));
+  }
+
+  // The kernel picks the shard by the source address and port, so send from
+  // many sockets to make it all but certain more than one shard is used.
+  static const int sender_count = 32;
+  for (int i = 0; i < sender_count; ++i) {
+    ACE_SOCK_Dgram sender;
+    ASSERT_EQ(sender.open(loopback), 0);
+    const char datagram = 'D';
+    EXPECT_EQ(sender.send(&datagram, sizeof datagram, addr), 1);
+    sender.close();
+  }
+
+  int received = 0;
+  int shards_used = 0;
+  for (int i = 0; i < shard_count; ++i) {
+    bool used = false;
+    while (true) {
+      char buffer[16];
+      ACE_INET_Addr from;
+      const ACE_Time_Value timeout(0, 100000);
+      if (shards[i].recv(buffer, sizeof buffer, from, 0, &timeout) != 1) {
+        break;
+      }
+      EXPECT_EQ(buffer[0], 'D');
+      ++received;
+      used = true;
+    }
+    if (used) {
+      ++shards_used;
+    }
+    shards[i].close();
+  }
+
+  EXPECT_EQ(received, sender_count);
+  EXPECT_GT(shards_used, 1);
+}
+#endif
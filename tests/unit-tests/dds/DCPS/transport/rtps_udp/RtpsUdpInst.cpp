@@ -301,3 +301,69 @@ TEST(dds_DCPS_RTPS_RtpsUdpInst, ipv6_unicast_address)
   }
 }
 #endif
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, receive_batch_size)
+{
+  RtpsUdpType t;
+  EXPECT_EQ(t.rtps_udp->receive_batch_size(), 1u);
+  t.rtps_udp->receive_batch_size(32);
+  EXPECT_EQ(t.rtps_udp->receive_batch_size(), 32u);
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, send_batch_size)
+{
+  RtpsUdpType t;
+  EXPECT_EQ(t.rtps_udp->send_batch_size(), 1u);
+  t.rtps_udp->send_batch_size(64);
+  EXPECT_EQ(t.rtps_udp->send_batch_size(), 64u);
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, use_udp_gso)
+{
+  RtpsUdpType t;
+  EXPECT_FALSE(t.rtps_udp->use_udp_gso());
+  t.rtps_udp->use_udp_gso(true);
+  EXPECT_TRUE(t.rtps_udp->use_udp_gso());
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, use_udp_gro)
+{
+  RtpsUdpType t;
+  EXPECT_FALSE(t.rtps_udp->use_udp_gro());
+  t.rtps_udp->use_udp_gro(true);
+  EXPECT_TRUE(t.rtps_udp->use_udp_gro());
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, busy_poll_idle)
+{
+  RtpsUdpType t;
+  EXPECT_TRUE(t.rtps_udp->busy_poll_idle().is_zero());
+  t.rtps_udp->busy_poll_idle(TimeDuration(0, 250000));
+  EXPECT_EQ(t.rtps_udp->busy_poll_idle(), TimeDuration(0, 250000));
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, receive_shards)
+{
+  RtpsUdpType t;
+  EXPECT_EQ(t.rtps_udp->receive_shards(), 1u);
+  t.rtps_udp->receive_shards(4);
+  EXPECT_EQ(t.rtps_udp->receive_shards(), 4u);
+}
+
+TEST(dds_DCPS_RTPS_RtpsUdpInst, config_snapshot)
+{
+  RtpsUdpType t;
+  t.rtps_udp->use_multicast(false);
+  t.rtps_udp->heartbeat_period(TimeDuration(3));
+  t.rtps_udp->send_delay(TimeDuration(0, 250000));
+
+  const RtpsUdpConfigSnapshot snapshot(*t.rtps_udp);
+  EXPECT_FALSE(snapshot.use_multicast_);
+  EXPECT_EQ(snapshot.heartbeat_period_, TimeDuration(3));
+  EXPECT_EQ(snapshot.send_delay_, TimeDuration(0, 250000));
+  EXPECT_EQ(snapshot.nak_response_delay_, t.rtps_udp->nak_response_delay());
+  EXPECT_EQ(snapshot.receive_address_duration_, t.rtps_udp->receive_address_duration());
+
+  t.rtps_udp->heartbeat_period(TimeDuration(5));
+  EXPECT_EQ(snapshot.heartbeat_period_, TimeDuration(3));
+}
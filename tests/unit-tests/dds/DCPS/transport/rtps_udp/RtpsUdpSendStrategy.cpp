@@ -0,0 +1,144 @@
+#include <dds/DCPS/transport/rtps_udp/RtpsUdpSendStrategy.h>
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Dgram.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace OpenDDS::DCPS;
+
+#if OPENDDS_RTPS_UDP_HAS_UDP_OFFLOAD
+namespace {
+  typedef RtpsUdpSendStrategy::GsoRun GsoRun;
+
+  // A "datagram" made of a header block and a payload block, like the
+  // packets the framework builds.
+  struct Packet {
+    Packet(char fill, size_t header, size_t payload)
+      : header_(header)
+      , payload_(payload)
+    {
+      std::memset(header_.wr_ptr(), 'H', header);
+      header_.wr_ptr(header);
+      std::memset(payload_.wr_ptr(), fill, payload);
+      payload_.wr_ptr(payload);
+      header_.cont(&payload_);
+      iov_[0].iov_base = header_.rd_ptr();
+      iov_[0].iov_len = header;
+      iov_[1].iov_base = payload_.rd_ptr();
+      iov_[1].iov_len = payload;
+    }
+
+    ~Packet()
+    {
+      header_.cont(0);
+    }
+
+    size_t length() const { return iov_[0].iov_len + iov_[1].iov_len; }
+
+    ACE_Message_Block header_;
+    ACE_Message_Block payload_;
+    iovec iov_[2];
+  };
+
+  NetworkAddressSet addrs(unsigned short port)
+  {
+    NetworkAddressSet result;
+    result.insert(NetworkAddress(port, "127.0.0.1"));
+    return result;
+  }
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpSendStrategy, GsoRun_accepts)
+{
+  GsoRun run;
+  Packet full1('a', 8, 100);
+  Packet full2('b', 8, 100);
+  Packet shorter('c', 8, 50);
+  Packet longer('d', 8, 150);
+
+  EXPECT_TRUE(run.accepts(full1.length(), 2, addrs(1234)));
+  run.append(full1.iov_, 2, full1.length(), full1.header_, addrs(1234));
+  EXPECT_EQ(run.segment_size(), full1.length());
+
+  EXPECT_FALSE(run.accepts(longer.length(), 2, addrs(1234)));
+  EXPECT_FALSE(run.accepts(full2.length(), 2, addrs(1235)));
+  EXPECT_TRUE(run.accepts(full2.length(), 2, addrs(1234)));
+  run.append(full2.iov_, 2, full2.length(), full2.header_, addrs(1234));
+
+  EXPECT_TRUE(run.accepts(shorter.length(), 2, addrs(1234)));
+  run.append(shorter.iov_, 2, shorter.length(), shorter.header_, addrs(1234));
+
+  // Only the last segment may be short.
+  EXPECT_FALSE(run.accepts(shorter.length(), 2, addrs(1234)));
+  EXPECT_EQ(run.segments(), 3u);
+  EXPECT_EQ(run.length(), 2 * full1.length() + shorter.length());
+  EXPECT_EQ(run.iovlen(), 6u);
+
+  run.clear();
+  EXPECT_TRUE(run.empty());
+  EXPECT_TRUE(run.accepts(longer.length(), 2, addrs(1235)));
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpSendStrategy, GsoRun_references_packets)
+{
+  GsoRun run;
+  Packet packet('a', 8, 100);
+  run.append(packet.iov_, 2, packet.length(), packet.header_, addrs(1234));
+
+  // The bytes aren't copied, the iovecs point at the packet's data blocks,
+  // which the run keeps a reference to.
+  EXPECT_EQ(run.iov()[1].iov_base, packet.payload_.rd_ptr());
+  EXPECT_EQ(packet.header_.data_block()->reference_count(), 2);
+  EXPECT_EQ(packet.payload_.data_block()->reference_count(), 2);
+
+  run.clear();
+  EXPECT_EQ(packet.header_.data_block()->reference_count(), 1);
+  EXPECT_EQ(packet.payload_.data_block()->reference_count(), 1);
+}
+
+TEST(dds_DCPS_transport_rtps_udp_RtpsUdpSendStrategy, GsoRun_send_segments_one_at_a_time)
+{
+  // This is what the send strategy does when the kernel can't segment.
+  ACE_SOCK_Dgram receiver;
+  ASSERT_EQ(receiver.open(ACE_INET_Addr(static_cast<unsigned short>(0), "127.0.0.1")), 0);
+  ACE_INET_Addr receiver_addr;
+  receiver.get_local_addr(receiver_addr);
+  ACE_SOCK_Dgram sender;
+  ASSERT_EQ(sender.open(ACE_INET_Addr(static_cast<unsigned short>(0), "127.0.0.1")), 0);
+
+  GsoRun run;
+  Packet full1('a', 8, 100);
+  Packet full2('b', 8, 100);
+  Packet shorter('c', 8, 50);
+  const NetworkAddressSet dest = addrs(receiver_addr.get_port_number());
+  run.append(full1.iov_, 2, full1.length(), full1.header_, dest);
+  run.append(full2.iov_, 2, full2.length(), full2.header_, dest);
+  run.append(shorter.iov_, 2, shorter.length(), shorter.header_, dest);
+
+  for (size_t i = 0; i < run.segments(); ++i) {
+    int n;
+    const iovec* const iov = run.segment_iov(i, n);
+    EXPECT_EQ(n, 2);
+    EXPECT_GT(sender.send(iov, n, receiver_addr), 0);
+  }
+
+  const char fills[] = { 'a', 'b', 'c' };
+  const size_t lengths[] = { full1.length(), full2.length(), shorter.length() };
+  for (size_t i = 0; i < 3; ++i) {
+    char buffer[256];
+    ACE_INET_Addr from;
+    const ACE_Time_Value timeout(5);
+    const ssize_t received = receiver.recv(buffer, sizeof buffer, from, 0, &timeout);
+    ASSERT_EQ(received, static_cast<ssize_t>(lengths[i]));
+    EXPECT_EQ(buffer[0], 'H');
+    EXPECT_EQ(buffer[8], fills[i]);
+    EXPECT_EQ(buffer[received - 1], fills[i]);
+  }
+
+  sender.close();
+  receiver.close();
+}
+#endif
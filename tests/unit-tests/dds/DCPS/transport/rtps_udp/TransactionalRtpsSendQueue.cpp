@@ -11,6 +11,12 @@
 
 #include "util.h"
 
+#ifdef ACE_HAS_CPP11
+#include <atomic>
+#include <thread>
+#include <vector>
+#endif
+
 using namespace OpenDDS::DCPS;
 using namespace test;
 
@@ -140,3 +146,77 @@ TEST(dds_DCPS_transport_rtps_udp_TransactionalRtpsSendQueue, purge_local)
 
   EXPECT_TRUE(meta_submessage_vec_equal(actual, expected));
 }
+
+TEST(dds_DCPS_transport_rtps_udp_TransactionalRtpsSendQueue, size)
+{
+  TransactionalRtpsSendQueue sq;
+  EXPECT_EQ(sq.size(), 0u);
+
+  EXPECT_TRUE(sq.enqueue(create_heartbeat(w1, r1, 1, 2, 300, false)));
+  EXPECT_FALSE(sq.enqueue(create_heartbeat(w1, r2, 1, 2, 300, false)));
+  EXPECT_EQ(sq.size(), 2u);
+
+  MetaSubmessageVec actual;
+  sq.begin_transaction();
+  sq.ready_to_send();
+  sq.end_transaction(actual);
+  EXPECT_EQ(actual.size(), 2u);
+  EXPECT_EQ(sq.size(), 0u);
+
+  EXPECT_TRUE(sq.enqueue(create_heartbeat(w1, r1, 1, 3, 301, false)));
+  EXPECT_EQ(sq.size(), 1u);
+}
+
+#ifdef ACE_HAS_CPP11
+TEST(dds_DCPS_transport_rtps_udp_TransactionalRtpsSendQueue, concurrent_enqueue_and_harvest)
+{
+  TransactionalRtpsSendQueue sq;
+
+  const size_t producers = 8;
+  const size_t per_producer = 10000;
+  std::atomic<size_t> harvests_requested(0);
+  std::atomic<size_t> producers_done(0);
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p != producers; ++p) {
+    threads.push_back(std::thread([&, p]() {
+      for (size_t i = 0; i != per_producer; ++i) {
+        // Every enqueue that finds the queue empty stands for a scheduled harvest.
+        if (sq.enqueue(create_heartbeat(p % 2 ? w1 : w2, r1, 1, i + 1, 300, false))) {
+          ++harvests_requested;
+        }
+      }
+      ++producers_done;
+    }));
+  }
+
+  // Harvest only when asked to, like RtpsUdpDataLink does.  If an enqueue
+  // after a harvest didn't report that the queue was empty the submessages
+  // it left behind would never be harvested.
+  size_t harvested = 0;
+  size_t harvests_done = 0;
+  for (;;) {
+    const bool done = producers_done == producers;
+    if (harvests_done == harvests_requested) {
+      if (done) {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    ++harvests_done;
+    MetaSubmessageVec actual;
+    sq.begin_transaction();
+    sq.ready_to_send();
+    sq.end_transaction(actual);
+    harvested += actual.size();
+  }
+
+  for (size_t p = 0; p != producers; ++p) {
+    threads[p].join();
+  }
+
+  EXPECT_EQ(harvested, producers * per_producer);
+  EXPECT_EQ(sq.size(), 0u);
+}
+#endif
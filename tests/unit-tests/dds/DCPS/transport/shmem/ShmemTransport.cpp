@@ -0,0 +1,189 @@
+#ifndef OPENDDS_SAFETY_PROFILE
+
+#include <dds/DCPS/transport/shmem/ShmemTransport.h>
+#include <dds/DCPS/transport/shmem/ShmemInst.h>
+
+#ifndef OPENDDS_SHMEM_UNSUPPORTED
+
+#include <dds/DCPS/GuidUtils.h>
+#include <dds/DCPS/transport/framework/TransportQueueElement.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  class TestTransport : public ShmemTransport {
+  public:
+    TestTransport(const ShmemInst_rch& inst)
+      : ShmemTransport(inst, 0)
+    {}
+
+    ~TestTransport()
+    {
+      shutdown();
+    }
+  };
+
+  class Element : public TransportQueueElement {
+  public:
+    Element()
+      : TransportQueueElement(1)
+      , guid_(GUID_UNKNOWN)
+    {
+      guid_.entityId.entityKey[2] = 1;
+    }
+
+    GUID_t publication_id() const { return guid_; }
+    SequenceNumber sequence() const { return SequenceNumber(1); }
+    ACE_Message_Block* duplicate_msg() const { return 0; }
+    const ACE_Message_Block* msg() const { return 0; }
+    const ACE_Message_Block* msg_payload() const { return 0; }
+    bool owned_by_transport() { return false; }
+
+  private:
+    void release_element(bool) {}
+
+    GUID_t guid_;
+  };
+
+  // A control ring with a few slots, like the one ShmemSendStrategy keeps in
+  // the pool for each DataLink.
+  struct Ring {
+    Ring()
+      : memory_((sizeof(ShmemControl) + 4 * sizeof(ShmemData)) / sizeof(ACE_UINT64) + 1)
+      , head_(0)
+      , reclaimed_(0)
+    {
+      control_ = new(&memory_[0]) ShmemControl;
+      control_->capacity_ = 4;
+      for (ACE_UINT32 i = 0; i < control_->capacity_; ++i) {
+        new(&control_->slot(i)) ShmemData;
+      }
+    }
+
+    void push(char* payload)
+    {
+      control_->slot(head_++).payload_ = payload;
+    }
+
+    std::vector<ACE_UINT64> memory_;
+    ShmemControl* control_;
+    ACE_UINT32 head_;
+    ACE_UINT32 reclaimed_;
+  };
+
+  ACE_UINT32 refcount(char* payload)
+  {
+    return (reinterpret_cast<ShmemPayloadHeader*>(payload) - 1)->refcount_;
+  }
+
+  struct ShmemTransportTest : public testing::Test {
+    ShmemTransportTest()
+      : inst_(make_rch<ShmemInst>("ShmemTransportUnitTest"))
+      , transport_(make_rch<TestTransport>(inst_))
+    {
+      std::memset(header_, 'T', sizeof header_);
+      std::memset(sample_header_, 'H', sizeof sample_header_);
+      std::memset(data_, 'D', sizeof data_);
+      iov_[0].iov_base = header_;
+      iov_[0].iov_len = sizeof header_;
+      iov_[1].iov_base = sample_header_;
+      iov_[1].iov_len = sizeof sample_header_;
+      iov_[2].iov_base = data_;
+      iov_[2].iov_len = sizeof data_;
+    }
+
+    char* acquire()
+    {
+      return transport_->acquire_payload(&element_, iov_, 3, sizeof sample_header_ + sizeof data_);
+    }
+
+    ShmemInst_rch inst_;
+    RcHandle<TestTransport> transport_;
+    Element element_;
+    char header_[8];
+    char sample_header_[16];
+    char data_[64];
+    iovec iov_[3];
+  };
+}
+
+TEST_F(ShmemTransportTest, SharesPayloadBetweenLinks)
+{
+  char* const first = acquire();
+  ASSERT_TRUE(first);
+  EXPECT_EQ(refcount(first), 1u);
+  EXPECT_EQ(std::memcmp(first, sample_header_, sizeof sample_header_), 0);
+  EXPECT_EQ(std::memcmp(first + sizeof sample_header_, data_, sizeof data_), 0);
+
+  char* const second = acquire();
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(refcount(first), 2u);
+
+  transport_->release_payload(second);
+  EXPECT_EQ(refcount(first), 1u);
+  transport_->release_payload(first);
+
+  // Freed, so the next packet gets a new allocation with a single reference.
+  char* const third = acquire();
+  ASSERT_TRUE(third);
+  EXPECT_EQ(refcount(third), 1u);
+  transport_->release_payload(third);
+}
+
+TEST_F(ShmemTransportTest, ChangedHeaderIsNotShared)
+{
+  char* const first = acquire();
+  ASSERT_TRUE(first);
+
+  // Like WriteDataContainer setting HISTORIC_SAMPLE_FLAG in place.
+  sample_header_[1] = 'X';
+  char* const second = acquire();
+  ASSERT_TRUE(second);
+  EXPECT_NE(second, first);
+  EXPECT_EQ(refcount(first), 1u);
+  EXPECT_EQ(refcount(second), 1u);
+  EXPECT_EQ(second[1], 'X');
+  EXPECT_EQ(first[1], 'H');
+
+  // The changed copy is the one shared from now on.
+  char* const third = acquire();
+  EXPECT_EQ(third, second);
+  EXPECT_EQ(refcount(second), 2u);
+
+  transport_->release_payload(first);
+  transport_->release_payload(second);
+  transport_->release_payload(third);
+}
+
+TEST_F(ShmemTransportTest, StoppedLinksReleasePayloads)
+{
+  // One sample sent on two links, neither peer reads it before they stop.
+  Ring ring1, ring2;
+  ring1.push(acquire());
+  ring2.push(acquire());
+  char* const payload = ring1.control_->slot(0).payload_;
+  ASSERT_TRUE(payload);
+  EXPECT_EQ(static_cast<char*>(ring2.control_->slot(0).payload_), payload);
+  EXPECT_EQ(refcount(payload), 2u);
+
+  transport_->release_payloads(*ring1.control_, ring1.reclaimed_, ring1.head_);
+  EXPECT_EQ(ring1.reclaimed_, ring1.head_);
+  EXPECT_EQ(refcount(payload), 1u);
+
+  transport_->release_payloads(*ring2.control_, ring2.reclaimed_, ring2.head_);
+  EXPECT_EQ(ring2.reclaimed_, ring2.head_);
+
+  // Both references are gone, the same packet isn't shared anymore.
+  char* const next = acquire();
+  ASSERT_TRUE(next);
+  EXPECT_EQ(refcount(next), 1u);
+  transport_->release_payload(next);
+}
+
+#endif
+#endif